@@ -36,6 +36,7 @@
             this.toolStripButtonGridLines = new System.Windows.Forms.ToolStripButton();
             this.toolStripButtonLoadIntersectionsLogFile = new System.Windows.Forms.ToolStripButton();
             this.toolStripButtonClearMap = new System.Windows.Forms.ToolStripButton();
+            this.toolStripButtonIntersectLog = new System.Windows.Forms.ToolStripButton();
             this.statusStrip = new System.Windows.Forms.StatusStrip();
             this.toolStripStatusLabel = new System.Windows.Forms.ToolStripStatusLabel();
             this.toolStripStatusLabelLonLat = new System.Windows.Forms.ToolStripStatusLabel();
@@ -51,7 +52,8 @@
             this.toolStrip.Items.AddRange(new System.Windows.Forms.ToolStripItem[] {
             this.toolStripButtonGridLines,
             this.toolStripButtonLoadIntersectionsLogFile,
-            this.toolStripButtonClearMap});
+            this.toolStripButtonClearMap,
+            this.toolStripButtonIntersectLog});
             this.toolStrip.Location = new System.Drawing.Point(0, 0);
             this.toolStrip.Name = "toolStrip";
             this.toolStrip.Size = new System.Drawing.Size(984, 25);
@@ -92,6 +94,15 @@
             this.toolStripButtonClearMap.ToolTipText = "Clear map";
             this.toolStripButtonClearMap.Click += new System.EventHandler(this.toolStripButtonClearMap_Click);
             // 
+            // toolStripButtonIntersectLog
+            // 
+            this.toolStripButtonIntersectLog.DisplayStyle = System.Windows.Forms.ToolStripItemDisplayStyle.Text;
+            this.toolStripButtonIntersectLog.Name = "toolStripButtonIntersectLog";
+            this.toolStripButtonIntersectLog.Size = new System.Drawing.Size(58, 22);
+            this.toolStripButtonIntersectLog.Text = "Intersect";
+            this.toolStripButtonIntersectLog.ToolTipText = "Run every log entry through the hazard intersector";
+            this.toolStripButtonIntersectLog.Click += new System.EventHandler(this.toolStripButtonIntersectLog_Click);
+            // 
             // statusStrip
             // 
             this.statusStrip.Items.AddRange(new System.Windows.Forms.ToolStripItem[] {
@@ -188,6 +199,7 @@
         private System.Windows.Forms.OpenFileDialog openFileDialog;
         private System.Windows.Forms.ToolStripButton toolStripButtonLoadIntersectionsLogFile;
         private System.Windows.Forms.ToolStripButton toolStripButtonClearMap;
+        private System.Windows.Forms.ToolStripButton toolStripButtonIntersectLog;
         private System.Windows.Forms.ToolStripStatusLabel toolStripStatusLabel;
     }
 }
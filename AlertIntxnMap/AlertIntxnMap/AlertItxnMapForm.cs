@@ -4,8 +4,6 @@ using System.Drawing;
 using System.Text;
 using System.Windows.Forms;
 using WSIMap;
-using Newtonsoft.Json;
-using System.IO;
 
 namespace AlertIntxnMap
 {
@@ -17,10 +15,14 @@ namespace AlertIntxnMap
         private WSIMap.Layer basemapLayerL;
         private WSIMap.FeatureCollection basemapFC = null;
         private WSIMap.Layer drawingLayer = null;
+        private IntersectionLog intersectionLog = null;
+        private const int LOG_PAGE_SIZE = 500;     // log entries added to the list at a time
+        private bool addingIntersectionLogPage = false;
         WSIMap.Font arial12Font = null;
         private GridPoints gridPoints = null;
         private short centralLongitude = Projection.DefaultCentralLongitude;
         private const double POINT_HAZARD_DEFAULT_RADIUS_MILES = 75 * 1.15078; // 75 nautical miles
+        private const int MAX_CONFLICTS_LISTED = 30;    // hazards listed after a log is intersected
 
         public AlertItxnMapForm()
         {
@@ -42,8 +44,14 @@ namespace AlertIntxnMap
             mapGL.InitializeContexts();
 
             #region Base Map Layers
+            // The basemaps load in the background, in the order their layers are first
+            // drawn (bottom up), and appear as each one is ready.  Those in the prebuilt
+            // bundle, if there is one, come out of it instead of being read.
+            VectorFile.OpenBundle(@"..\Data\basemap.wbnd");
+
             // Countries, filled and stenciled.  Stenciling constrains the terrain layer to the filled area.
             basemapl = new VectorFile(@"..\Data\50m_admin_0_countries.shp", "Countries", "Natural Earth 1:50m countries");
+            basemapl.LoadAsync = true;
             basemapl.Stencil = true;
             basemapl.Fill = true;
             basemapl.Border = false;
@@ -60,6 +68,7 @@ namespace AlertIntxnMap
             // Countries, unfilled.  Adding this layer twice allow us to put boundaries on top
             // of the terrain and to toggle the map between color and wire frame very quickly.
             VectorFile basemapc = new VectorFile(@"..\Data\50m_admin_0_countries.shp", "Countries", "Natural Earth 1:50m countries");
+            basemapc.LoadAsync = true;
             basemapc.Stencil = false;
             basemapc.Fill = false;
             basemapc.Border = true;
@@ -72,6 +81,7 @@ namespace AlertIntxnMap
 
             // States and provinces.
             VectorFile states = new VectorFile(@"..\Data\50m-admin-1-states-provinces-lines-shp.shp", "States & Provinces", "Natural Earth 1:50m states and provinces");
+            states.LoadAsync = true;
             states.Stencil = false;
             states.Fill = false;
             states.Border = true;
@@ -84,6 +94,7 @@ namespace AlertIntxnMap
 
             // Lakes, filled.
             basemapw = new VectorFile(@"..\Data\50m-lakes.shp", "Lakes", "Natural Earth 1:50m lakes");
+            basemapw.LoadAsync = true;
             basemapw.Stencil = false;
             basemapw.Fill = true;
             basemapw.Border = false;
@@ -100,6 +111,7 @@ namespace AlertIntxnMap
             // Lakes, unfilled.  Adding this layer twice allows us to toggle the map between
             // color and wire frame very quickly.
             VectorFile basemaps = new VectorFile(@"..\Data\50m-lakes.shp", "Lakes", "Natural Earth 1:50m lakes");
+            basemaps.LoadAsync = true;
             basemaps.Stencil = false;
             basemaps.Fill = false;
             basemaps.Border = true;
@@ -210,18 +222,41 @@ namespace AlertIntxnMap
             if (openFileDialog.ShowDialog() == System.Windows.Forms.DialogResult.OK)
             {
                 Cursor.Current = Cursors.WaitCursor;
-                string[] lines = File.ReadAllLines(openFileDialog.FileName);
-                comboBoxIntersectionLogEntries.Text = string.Empty;
-                comboBoxIntersectionLogEntries.Items.Clear();
-                foreach (string line in lines)
+                IntersectionLog log;
+                try
                 {
-                    if (line.Contains("REDUNDANT"))
-                        continue;
-                    comboBoxIntersectionLogEntries.Items.Add(line);
+                    log = new IntersectionLog(openFileDialog.FileName);
                 }
+                catch (Exception ex)
+                {
+                    MessageBox.Show(ex.Message);
+                    return;
+                }
+
+                comboBoxIntersectionLogEntries.Text = string.Empty;
+                comboBoxIntersectionLogEntries.Items.Clear();
+                if (intersectionLog != null)
+                    intersectionLog.Dispose();
+                intersectionLog = log;
+                AddIntersectionLogPage();
             }
         }
 
+        // The list reads the line of every entry added to it, so it is filled a
+        // page at a time; the last item adds the next page when it is chosen
+        private void AddIntersectionLogPage()
+        {
+            ComboBox.ObjectCollection items = comboBoxIntersectionLogEntries.Items;
+            comboBoxIntersectionLogEntries.BeginUpdate();
+            if (items.Count > 0 && !(items[items.Count - 1] is IntersectionLog.Entry))
+                items.RemoveAt(items.Count - 1);
+            items.AddRange(intersectionLog.GetEntries(items.Count, LOG_PAGE_SIZE));
+            int remaining = intersectionLog.Count - items.Count;
+            if (remaining > 0)
+                items.Add("... next " + Math.Min(remaining, LOG_PAGE_SIZE) + " of " + remaining + " more entries");
+            comboBoxIntersectionLogEntries.EndUpdate();
+        }
+
         private void toolStripButtonClearMap_Click(object sender, EventArgs e)
         {
             comboBoxIntersectionLogEntries.Text = string.Empty;
@@ -232,9 +267,22 @@ namespace AlertIntxnMap
 
         private void comboBoxIntersectionLogEntries_SelectedIndexChanged(object sender, EventArgs e)
         {
-            // Get intersection log entry text from the combobox and clear the map
-            string logEntry = comboBoxIntersectionLogEntries.Text;
-            if (string.IsNullOrWhiteSpace(logEntry))
+            // The last item adds the next page of the log
+            if (comboBoxIntersectionLogEntries.SelectedItem is string)
+            {
+                addingIntersectionLogPage = true;
+                AddIntersectionLogPage();
+                comboBoxIntersectionLogEntries.SelectedIndex = -1;
+                addingIntersectionLogPage = false;
+                comboBoxIntersectionLogEntries.DroppedDown = true;
+                return;
+            }
+            if (addingIntersectionLogPage)
+                return;
+
+            // Get the intersection log entry from the combobox and clear the map
+            IntersectionLog.Entry logEntry = comboBoxIntersectionLogEntries.SelectedItem as IntersectionLog.Entry;
+            if (logEntry == null)
             {
                 MessageBox.Show("The log entry is blank - nothing to draw.");
                 return;
@@ -246,8 +294,7 @@ namespace AlertIntxnMap
             Intersection intxn = null;
             try
             {
-                logEntry = logEntry.Remove(0, logEntry.IndexOf('{')); // remove non-JSON part
-                intxn = JsonConvert.DeserializeObject<Intersection>(logEntry);
+                intxn = logEntry.ReadIntersection(); // decodes only the JSON part
                 if (intxn == null)
                     throw (new Exception("Intersection object is null."));
             }
@@ -262,6 +309,8 @@ namespace AlertIntxnMap
                 + intxn.flightPlan.key.sdt + " " + GetHazardType(intxn).ToString();
             statusStrip.Items[0].Text = statusBarText;
 
+            statusStrip.Items[0].Text += " " + CrossingStatus(intxn);
+
             // Draw the intersection scenario
             DrawHazard(GetHazardType(intxn), intxn);
             DrawFlightPlan(intxn);
@@ -271,6 +320,97 @@ namespace AlertIntxnMap
             mapGL.Refresh();
         }
 
+        // Run every entry of the loaded log through the hazard intersector in one
+        // batch, all routes against all advisories, and report how many logged
+        // intersections it confirms: the entry's own route crossing its own
+        // advisory within the advisory's levels
+        private void toolStripButtonIntersectLog_Click(object sender, EventArgs e)
+        {
+            if (intersectionLog == null)
+            {
+                MessageBox.Show("Load an intersections log file first.");
+                return;
+            }
+
+            Cursor.Current = Cursors.WaitCursor;
+            int skipped;
+            List<Intersection> intersections = intersectionLog.ReadIntersections(out skipped);
+            List<FlightPlan> flightPlans = new List<FlightPlan>(intersections.Count);
+            List<WeatherAdvisory> advisories = new List<WeatherAdvisory>(intersections.Count);
+            Dictionary<FlightPlan, int> entryOfPlan = new Dictionary<FlightPlan, int>();
+            foreach (Intersection intxn in intersections)
+            {
+                entryOfPlan[intxn.flightPlan] = flightPlans.Count;
+                flightPlans.Add(intxn.flightPlan);
+                advisories.Add(intxn.weatherAdvisory);
+            }
+
+            List<HazardCrossing> crossings = HazardIntersector.Intersect(flightPlans, advisories);
+            bool[] confirmed = new bool[intersections.Count];
+            foreach (HazardCrossing crossing in crossings)
+            {
+                int i = entryOfPlan[crossing.flightPlan];
+                if (crossing.weatherAdvisory == advisories[i] && crossing.altitudeOverlap)
+                    confirmed[i] = true;
+            }
+            int nConfirmed = 0;
+            foreach (bool c in confirmed)
+                if (c)
+                    nConfirmed++;
+
+            // The earliest each hazard, moving as its advisory says, meets a
+            // route it was logged against
+            List<HazardConflict> conflicts = HazardIntersector.FindEarliestConflicts(intersections);
+            SortedDictionary<string, DateTime> earliest = new SortedDictionary<string, DateTime>();
+            foreach (HazardConflict conflict in conflicts)
+            {
+                if (!conflict.conflict)
+                    continue;
+                string hazardId = conflict.intersection.weatherAdvisory.hazardId ?? string.Empty;
+                DateTime time;
+                if (!earliest.TryGetValue(hazardId, out time) || conflict.time < time)
+                    earliest[hazardId] = conflict.time;
+            }
+
+            statusStrip.Items[0].Text = nConfirmed + " of " + intersections.Count + " logged intersections confirmed, " + crossings.Count + " crossings of all routes with all advisories, "
+                + earliest.Count + " moving hazards in conflict" + (skipped > 0 ? ", " + skipped + " entries unreadable" : string.Empty);
+            Cursor.Current = Cursors.Default;
+            if (earliest.Count > 0)
+                MessageBox.Show(EarliestConflictText(earliest), "Earliest conflict by hazard");
+        }
+
+        private static string EarliestConflictText(SortedDictionary<string, DateTime> earliest)
+        {
+            StringBuilder text = new StringBuilder();
+            int listed = 0;
+            foreach (KeyValuePair<string, DateTime> hazard in earliest)
+            {
+                if (listed++ == MAX_CONFLICTS_LISTED)
+                {
+                    text.AppendLine("... and " + (earliest.Count - MAX_CONFLICTS_LISTED) + " more");
+                    break;
+                }
+                text.AppendLine((hazard.Key.Length > 0 ? hazard.Key : "(no id)") + "  " + hazard.Value.ToString("yyyy-MM-dd HH:mm") + "Z");
+            }
+            return text.ToString();
+        }
+
+        // The crossings of one entry's route with its advisory, and when the
+        // advisory as it moves first meets the route, for the status bar
+        private string CrossingStatus(Intersection intxn)
+        {
+            if (intxn.flightPlan == null || intxn.weatherAdvisory == null)
+                return string.Empty;
+            List<HazardCrossing> crossings = HazardIntersector.Intersect(new FlightPlan[] { intxn.flightPlan }, new WeatherAdvisory[] { intxn.weatherAdvisory });
+            int inLevels = 0;
+            foreach (HazardCrossing crossing in crossings)
+                if (crossing.altitudeOverlap)
+                    inLevels++;
+            HazardConflict conflict = HazardIntersector.FindEarliestConflicts(new Intersection[] { intxn })[0];
+            return "(" + crossings.Count + " crossings, " + inLevels + " within levels"
+                + (conflict.conflict ? ", hazard meets route at " + conflict.time.ToString("HH:mm") + "Z" : string.Empty) + ")";
+        }
+
         private HazardType GetHazardType (Intersection intxn)
         {
             HazardType hazardType;
@@ -0,0 +1,336 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Runtime.InteropServices;
+using System.Security;
+using FUL.Logging;
+
+namespace AlertIntxnMap
+{
+    // One stretch of a flight plan's route inside a weather advisory
+    public class HazardCrossing
+    {
+        public FlightPlan flightPlan { get; set; }
+        public WeatherAdvisory weatherAdvisory { get; set; }
+        public string hazardId { get; set; }
+        public double entryPosition { get; set; }      // route segment index plus the fraction along it
+        public double exitPosition { get; set; }
+        public Pt entry { get; set; }
+        public Pt exit { get; set; }
+        public bool altitudeOverlap { get; set; }      // the route is within the hazard's flight levels somewhere inside it
+        public double overlapEntryPosition { get; set; }
+        public double overlapExitPosition { get; set; }
+    }
+
+    // The earliest point at which an intersection's flight plan meets its
+    // advisory as the advisory moves
+    public class HazardConflict
+    {
+        public Intersection intersection { get; set; }
+        public bool conflict { get; set; }
+        public DateTime time { get; set; }              // UTC
+        public double position { get; set; }            // route segment index plus the fraction along it
+        public Pt location { get; set; }
+    }
+
+    // Runs many flight plan routes against many weather advisories at once in
+    // tessellate.dll, which indexes the hazards and spreads the routes over
+    // worker threads
+    public static class HazardIntersector
+    {
+        public const double POINT_HAZARD_DEFAULT_RADIUS_NM = 75;
+        private const double UNBOUNDED_UPPER_FLIGHT_LEVEL = 1000;
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct RouteHazardCrossing
+        {
+            public int route, hazard;
+            public double entryPosition, exitPosition;
+            public double entryLon, entryLat, entryAltitude;
+            public double exitLon, exitLat, exitAltitude;
+            public int altitudeOverlap;
+            public double overlapEntryPosition, overlapExitPosition;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct MovingHazardConflict
+        {
+            public int conflict;
+            public double time, position;
+            public double lon, lat, altitude;
+        }
+
+        private static readonly DateTime Epoch = new DateTime(1970, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+
+        [DllImport("tessellate.dll", EntryPoint = "IntersectRoutesWithHazards", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr IntersectRoutesWithHazards(double[] routeXY, double[] routeAltitudes, int[] routeOffsets, int nRoutes, double[] hazardXY, int[] hazardOffsets, int nHazards, double[] hazardRadius, double[] hazardLower, double[] hazardUpper, int nThreads);
+        [DllImport("tessellate.dll", EntryPoint = "DeleteRouteHazardResult", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern void DeleteRouteHazardResult(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetRouteHazardCrossingCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int GetRouteHazardCrossingCount(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetRouteHazardCrossings", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr GetRouteHazardCrossings(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "FindMovingHazardConflicts", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int FindMovingHazardConflicts(double[] routeXY, double[] routeTimes, double[] routeAltitudes, int[] routeOffsets, double[] hazardXY, int[] hazardOffsets, double[] hazardRadius, double[] hazardLower, double[] hazardUpper,
+            double[] hazardDirection, double[] hazardSpeed, double[] hazardStart, double[] hazardEnd, int nPairs, [Out] MovingHazardConflict[] conflicts, int nThreads);
+
+        // Every crossing of every route with every advisory, ordered by flight
+        // plan, advisory and entry.  Pt.alt is in feet.  Advisories with points
+        // are polygons, as DrawPolygonHazard draws them; the rest are circles
+        // around lat/lon of radius nautical miles, or the default radius when
+        // that is 0.  An advisory with no flight levels at all spans every level,
+        // and one with fewer than three points is logged and skipped.
+        public static List<HazardCrossing> Intersect(IList<FlightPlan> flightPlans, IList<WeatherAdvisory> advisories, int nThreads = 0)
+        {
+            List<HazardCrossing> crossings = new List<HazardCrossing>();
+            if (flightPlans.Count == 0 || advisories.Count == 0)
+                return crossings;
+
+            List<int> hazardAdvisories = new List<int>(advisories.Count);      // the advisory of each hazard
+            for (int a = 0; a < advisories.Count; a++)
+                if (HasHazardArea(advisories[a]))
+                    hazardAdvisories.Add(a);
+            int nHazards = hazardAdvisories.Count;
+            if (nHazards == 0)
+                return crossings;
+
+            List<double> routeXY = new List<double>();
+            List<double> routeAltitudes = new List<double>();
+            int[] routeOffsets = new int[flightPlans.Count + 1];
+            for (int r = 0; r < flightPlans.Count; r++)
+            {
+                routeOffsets[r] = routeAltitudes.Count;
+                AddRoute(flightPlans[r], routeXY, routeAltitudes);
+            }
+            routeOffsets[flightPlans.Count] = routeAltitudes.Count;
+
+            List<double> hazardXY = new List<double>();
+            int[] hazardOffsets = new int[nHazards + 1];
+            double[] hazardRadius = new double[nHazards];
+            double[] hazardLower = new double[nHazards];
+            double[] hazardUpper = new double[nHazards];
+            for (int h = 0; h < nHazards; h++)
+            {
+                hazardOffsets[h] = hazardXY.Count / 2;
+                AddHazard(advisories[hazardAdvisories[h]], hazardXY, out hazardRadius[h], out hazardLower[h], out hazardUpper[h]);
+            }
+            hazardOffsets[nHazards] = hazardXY.Count / 2;
+
+            IntPtr result = IntersectRoutesWithHazards(ToArray(routeXY, 2), ToArray(routeAltitudes, 1), routeOffsets, flightPlans.Count, ToArray(hazardXY, 2), hazardOffsets, nHazards, hazardRadius, hazardLower, hazardUpper, nThreads);
+            try
+            {
+                int count = GetRouteHazardCrossingCount(result);
+                IntPtr p = GetRouteHazardCrossings(result);
+                int size = Marshal.SizeOf(typeof(RouteHazardCrossing));
+                crossings.Capacity = count;
+                for (int i = 0; i < count; i++)
+                {
+                    RouteHazardCrossing c = (RouteHazardCrossing)Marshal.PtrToStructure(new IntPtr(p.ToInt64() + (long)i * size), typeof(RouteHazardCrossing));
+                    WeatherAdvisory advisory = advisories[hazardAdvisories[c.hazard]];
+                    HazardCrossing crossing = new HazardCrossing();
+                    crossing.flightPlan = flightPlans[c.route];
+                    crossing.weatherAdvisory = advisory;
+                    crossing.hazardId = advisory.hazardId;
+                    crossing.entryPosition = c.entryPosition;
+                    crossing.exitPosition = c.exitPosition;
+                    crossing.entry = new Pt { lat = c.entryLat, lon = c.entryLon, alt = (int)Math.Round(c.entryAltitude * 100) };
+                    crossing.exit = new Pt { lat = c.exitLat, lon = c.exitLon, alt = (int)Math.Round(c.exitAltitude * 100) };
+                    crossing.altitudeOverlap = c.altitudeOverlap != 0;
+                    crossing.overlapEntryPosition = c.overlapEntryPosition;
+                    crossing.overlapExitPosition = c.overlapExitPosition;
+                    crossings.Add(crossing);
+                }
+            }
+            finally
+            {
+                DeleteRouteHazardResult(result);
+            }
+            return crossings;
+        }
+
+        // The earliest time each intersection's flight plan is inside its
+        // advisory and within its levels, with the advisory moving from validStart
+        // to validEnd as movingDirection and movingSpeed (knots) say.
+        // movingDirection is the direction the advisory moves toward in degrees
+        // true, as a SIGMET's movement gives it (MOV E is 90), not the direction
+        // it comes from as windDirection is; tessellate.dll takes it that way.
+        // The route is flown from off to on at an even speed, or from off at
+        // AverageSpeed knots when there is no on time; a plan with no usable
+        // times, or an advisory Intersect would skip, never conflicts.
+        public static List<HazardConflict> FindEarliestConflicts(IList<Intersection> intersections, int nThreads = 0)
+        {
+            List<HazardConflict> conflicts = new List<HazardConflict>(intersections.Count);
+            if (intersections.Count == 0)
+                return conflicts;
+
+            int nPairs = intersections.Count;
+            List<double> routeXY = new List<double>();
+            List<double> routeTimes = new List<double>();
+            List<double> routeAltitudes = new List<double>();
+            int[] routeOffsets = new int[nPairs + 1];
+            List<double> hazardXY = new List<double>();
+            int[] hazardOffsets = new int[nPairs + 1];
+            double[] hazardRadius = new double[nPairs];
+            double[] hazardLower = new double[nPairs];
+            double[] hazardUpper = new double[nPairs];
+            double[] hazardDirection = new double[nPairs];
+            double[] hazardSpeed = new double[nPairs];
+            double[] hazardStart = new double[nPairs];
+            double[] hazardEnd = new double[nPairs];
+            for (int i = 0; i < nPairs; i++)
+            {
+                Intersection intxn = intersections[i];
+                routeOffsets[i] = routeAltitudes.Count;
+                hazardOffsets[i] = hazardXY.Count / 2;
+                if (intxn.flightPlan == null || intxn.weatherAdvisory == null || !HasHazardArea(intxn.weatherAdvisory))
+                    continue;
+
+                List<double> times = RouteTimes(intxn.flightPlan);
+                if (times != null)
+                {
+                    AddRoute(intxn.flightPlan, routeXY, routeAltitudes);
+                    routeTimes.AddRange(times);
+                }
+
+                WeatherAdvisory advisory = intxn.weatherAdvisory;
+                AddHazard(advisory, hazardXY, out hazardRadius[i], out hazardLower[i], out hazardUpper[i]);
+                hazardDirection[i] = advisory.movingDirection;     // toward, not from
+                hazardSpeed[i] = advisory.movingSpeed ?? 0;
+                double start, end;
+                if (!TryParseSeconds(advisory.validStart, out start) && !TryParseSeconds(advisory.issueTime, out start))
+                {
+                    // Nowhere to move it from; hold it still
+                    start = double.MinValue;
+                    hazardSpeed[i] = 0;
+                }
+                if (!TryParseSeconds(advisory.validEnd, out end))
+                    end = double.MaxValue;
+                hazardStart[i] = start;
+                hazardEnd[i] = end;
+            }
+            routeOffsets[nPairs] = routeAltitudes.Count;
+            hazardOffsets[nPairs] = hazardXY.Count / 2;
+
+            MovingHazardConflict[] found = new MovingHazardConflict[nPairs];
+            FindMovingHazardConflicts(ToArray(routeXY, 2), ToArray(routeTimes, 1), ToArray(routeAltitudes, 1), routeOffsets, ToArray(hazardXY, 2), hazardOffsets, hazardRadius, hazardLower, hazardUpper,
+                hazardDirection, hazardSpeed, hazardStart, hazardEnd, nPairs, found, nThreads);
+
+            for (int i = 0; i < nPairs; i++)
+            {
+                HazardConflict conflict = new HazardConflict();
+                conflict.intersection = intersections[i];
+                conflict.conflict = found[i].conflict != 0;
+                if (conflict.conflict)
+                {
+                    conflict.time = Epoch.AddSeconds(found[i].time);
+                    conflict.position = found[i].position;
+                    conflict.location = new Pt { lat = found[i].lat, lon = found[i].lon, alt = (int)Math.Round(found[i].altitude * 100) };
+                }
+                conflicts.Add(conflict);
+            }
+            return conflicts;
+        }
+
+        private static void AddRoute(FlightPlan plan, List<double> xy, List<double> altitudes)
+        {
+            if (plan.pts == null)
+                return;
+            foreach (Pt pt in plan.pts)
+            {
+                xy.Add(pt.lon);
+                xy.Add(pt.lat);
+                altitudes.Add(pt.alt / 100.0);
+            }
+        }
+
+        // Polygon advisories need three points to cover anything; without them
+        // the advisory is logged rather than quietly never meeting a route
+        private static bool HasHazardArea(WeatherAdvisory advisory)
+        {
+            if (advisory.points == null || advisory.points.Count >= 3)
+                return true;
+            Logger.WriteMessage("HazardIntersector.HasHazardArea", "Weather advisory " + advisory.hazardId + " has " + advisory.points.Count + " points, fewer than a polygon needs; skipped.",
+                null, FUL.WriteServiceErrors.ErrorLevel.Warning, FUL.WriteServiceErrors.ErrorSource.WebService, -1);
+            return false;
+        }
+
+        private static void AddHazard(WeatherAdvisory advisory, List<double> xy, out double radius, out double lower, out double upper)
+        {
+            radius = 0;
+            if (advisory.points != null)
+            {
+                foreach (Pt pt in advisory.points)
+                {
+                    xy.Add(pt.lon);
+                    xy.Add(pt.lat);
+                }
+            }
+            else
+            {
+                xy.Add(advisory.lon);
+                xy.Add(advisory.lat);
+                radius = (advisory.radius > 0 ? advisory.radius : POINT_HAZARD_DEFAULT_RADIUS_NM) / 60;
+            }
+
+            lower = Math.Min(advisory.lowerFlightLevel, advisory.upperFlightLevel);
+            upper = Math.Max(advisory.lowerFlightLevel, advisory.upperFlightLevel);
+            if (upper == 0)
+            {
+                if (advisory.flightLevel != 0)
+                    lower = upper = advisory.flightLevel;
+                else
+                    upper = UNBOUNDED_UPPER_FLIGHT_LEVEL;
+            }
+        }
+
+        // Seconds from Epoch at which the plan reaches each of its points, or
+        // null if it has no times to go by
+        private static List<double> RouteTimes(FlightPlan plan)
+        {
+            double off, on;
+            if (plan.pts == null || plan.pts.Count == 0 || !TryParseSeconds(plan.off, out off))
+                return null;
+
+            List<double> distances = new List<double>(plan.pts.Count);
+            double distance = 0;
+            for (int i = 0; i < plan.pts.Count; i++)
+            {
+                if (i > 0)
+                    distance += FUL.Utils.Distance(plan.pts[i - 1].lat, plan.pts[i - 1].lon, plan.pts[i].lat, plan.pts[i].lon, FUL.Utils.DistanceUnits.nm);
+                distances.Add(distance);
+            }
+
+            double secondsPerNm;
+            if (TryParseSeconds(plan.on, out on) && on > off && distance > 0)
+                secondsPerNm = (on - off) / distance;
+            else if (plan.AverageSpeed > 0)
+                secondsPerNm = 3600.0 / plan.AverageSpeed;
+            else
+                return null;
+
+            List<double> times = new List<double>(distances.Count);
+            foreach (double d in distances)
+                times.Add(off + d * secondsPerNm);
+            return times;
+        }
+
+        private static bool TryParseSeconds(string s, out double seconds)
+        {
+            DateTime time;
+            seconds = 0;
+            if (string.IsNullOrWhiteSpace(s) || !DateTime.TryParse(s, CultureInfo.InvariantCulture, DateTimeStyles.AdjustToUniversal | DateTimeStyles.AssumeUniversal, out time))
+                return false;
+            seconds = (time - Epoch).TotalSeconds;
+            return true;
+        }
+
+        // The list as an array, never empty, for arguments the native side may
+        // not read but still wants an address for
+        private static double[] ToArray(List<double> values, int minLength)
+        {
+            while (values.Count < minLength)
+                values.Add(0);
+            return values.ToArray();
+        }
+    }
+}
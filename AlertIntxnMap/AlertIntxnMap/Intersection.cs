@@ -106,7 +106,7 @@ namespace AlertIntxnMap
         public double maxVertAcc { get; set; }
         public double minLatAcc { get; set; }
         public double minVertAcc { get; set; }
-        public double movingDirection { get; set; }
+        public double movingDirection { get; set; }     // degrees true the advisory moves toward
         public double? movingSpeed { get; set; }
         public string navfixes { get; set; }
         public long objectId { get; set; }
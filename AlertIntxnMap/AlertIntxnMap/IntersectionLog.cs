@@ -0,0 +1,159 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Security;
+using System.Text;
+using Newtonsoft.Json;
+
+namespace AlertIntxnMap
+{
+    // An intersection log file, mapped and indexed by line in tessellate.dll
+    // rather than read into memory.  Lines marked REDUNDANT are left out, and
+    // a line is only read when it is listed or drawn.
+    public class IntersectionLog : IDisposable
+    {
+        private const int DISPLAY_LENGTH = 512;     // bytes of a line shown in the log entry list
+
+        private IntPtr index;
+        private JsonSerializer serializer = new JsonSerializer();
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct LogIndexEntry
+        {
+            public long offset;
+            public int length;
+            public int jsonOffset;
+        }
+
+        [DllImport("tessellate.dll", EntryPoint = "OpenLogIndex", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr OpenLogIndex(string fileName, int nThreads);
+        [DllImport("tessellate.dll", EntryPoint = "CloseLogIndex", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern void CloseLogIndex(IntPtr index);
+        [DllImport("tessellate.dll", EntryPoint = "GetLogIndexEntryCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int GetLogIndexEntryCount(IntPtr index);
+        [DllImport("tessellate.dll", EntryPoint = "GetLogIndexEntry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int GetLogIndexEntry(IntPtr index, int entry, out LogIndexEntry result);
+        [DllImport("tessellate.dll", EntryPoint = "ReadLogIndexEntry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int ReadLogIndexEntry(IntPtr index, int entry, int start, byte[] buffer, int bufferSize);
+        [DllImport("tessellate.dll", EntryPoint = "ReadLogIndexEntries", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int ReadLogIndexEntries(IntPtr index, int first, int count, int maxLength, byte[] buffer, int[] lengths);
+
+        // One line of the log, for the log entry list.  The text shown for it
+        // is read with the rest of its page, once.
+        public class Entry
+        {
+            private IntersectionLog log;
+            private int entry;
+            private string text;
+
+            public Entry(IntersectionLog log, int entry, string text)
+            {
+                this.log = log;
+                this.entry = entry;
+                this.text = text;
+            }
+
+            public Intersection ReadIntersection()
+            {
+                return log.ReadIntersection(entry);
+            }
+
+            public override string ToString()
+            {
+                return text;
+            }
+        }
+
+        public IntersectionLog(string fileName)
+        {
+            index = OpenLogIndex(fileName, 0);
+            if (index == IntPtr.Zero)
+                throw new IOException("Can't open " + fileName + ".");
+        }
+
+        ~IntersectionLog()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (index != IntPtr.Zero)
+                CloseLogIndex(index);
+            index = IntPtr.Zero;
+        }
+
+        public int Count
+        {
+            get { return GetLogIndexEntryCount(index); }
+        }
+
+        // Up to count entries from first on, with the start of each line, up
+        // to DISPLAY_LENGTH bytes of it, read in one call
+        public Entry[] GetEntries(int first, int count)
+        {
+            Entry[] entries = new Entry[Math.Max(0, Math.Min(count, Count - first))];
+            if (entries.Length == 0)
+                return entries;
+            byte[] buffer = new byte[entries.Length * DISPLAY_LENGTH];
+            int[] lengths = new int[entries.Length];
+            ReadLogIndexEntries(index, first, entries.Length, DISPLAY_LENGTH, buffer, lengths);
+            for (int i = 0; i < entries.Length; i++)
+                entries[i] = new Entry(this, first + i, Encoding.UTF8.GetString(buffer, i * DISPLAY_LENGTH, lengths[i]));
+            return entries;
+        }
+
+        // The JSON part of the line as an Intersection.  Only the selected
+        // entry is decoded, with the same serializer the rest of the map uses.
+        public Intersection ReadIntersection(int entry)
+        {
+            LogIndexEntry e;
+            if (index == IntPtr.Zero || GetLogIndexEntry(index, entry, out e) == 0)
+                throw new ArgumentOutOfRangeException("entry");
+            if (e.jsonOffset < 0)
+                throw new FormatException("The log entry has no JSON object.");
+
+            byte[] buffer = new byte[e.length - e.jsonOffset];
+            int n = ReadLogIndexEntry(index, entry, e.jsonOffset, buffer, buffer.Length);
+            using (StreamReader reader = new StreamReader(new MemoryStream(buffer, 0, n), Encoding.UTF8))
+            using (JsonTextReader json = new JsonTextReader(reader))
+                return serializer.Deserialize<Intersection>(json);
+        }
+
+        // Every entry that reads as an intersection with both a flight plan
+        // and a weather advisory, for running the whole log through the
+        // hazard intersector; skipped counts the rest
+        public List<Intersection> ReadIntersections(out int skipped)
+        {
+            int count = Count;
+            List<Intersection> intersections = new List<Intersection>(count);
+            skipped = 0;
+            for (int i = 0; i < count; i++)
+            {
+                Intersection intxn = null;
+                try
+                {
+                    intxn = ReadIntersection(i);
+                }
+                catch (FormatException)
+                {
+                }
+                catch (JsonException)
+                {
+                }
+                if (intxn != null && intxn.flightPlan != null && intxn.weatherAdvisory != null)
+                    intersections.Add(intxn);
+                else
+                    skipped++;
+            }
+            return intersections;
+        }
+    }
+}
@@ -131,6 +131,7 @@ namespace WSIMap
 			{
 				center = value;
 				GetVertices();
+				GeometryChanged();
 			}
 		}
 
@@ -143,6 +144,7 @@ namespace WSIMap
 				radius = value;
 				GetVertices();
 				Updated = true;
+				GeometryChanged();
 			}
 		}
 			
@@ -190,6 +190,16 @@ namespace WSIMap
 			}
 		}
 
+		internal List<PointD> PointListToDraw
+		{
+			get { return pointListToDraw; }
+		}
+
+		internal bool IsCrossIDL
+		{
+			get { return isCrossIDL; }
+		}
+
 		public PointD this[int index]
 		{
 			get
@@ -837,6 +847,8 @@ namespace WSIMap
 									Gl.glVertex2d(px, py);
 								}
 
+								if (isCrossIDL != crossIDL)
+									GeometryChanged();
 								isCrossIDL = crossIDL;
 							}
 						}
@@ -899,6 +911,8 @@ namespace WSIMap
 								Gl.glVertex2d(px, py);
 							}
 
+							if (isCrossIDL != crossIDL)
+								GeometryChanged();
 							isCrossIDL = crossIDL;
 						}
 					}
@@ -941,6 +955,7 @@ namespace WSIMap
 
 		private void GeneratePointList()
 		{
+			GeometryChanged();
 			pointListToDraw.Clear();
 
 			// Generate a point list that will be used for the actual drawing based on the interpolation method
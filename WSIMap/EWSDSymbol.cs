@@ -156,25 +156,25 @@ namespace WSIMap
 		public double X
 		{
 			get { return x; }
-			set { x = value; }
+			set { x = value; GeometryChanged(); }
 		}
 
 		public double Y
 		{
 			get { return y; }
-			set { y = value; }
+			set { y = value; GeometryChanged(); }
 		}
 
 		public double Longitude
 		{
 			get { return x; }
-			set { x = value; }
+			set { x = value; GeometryChanged(); }
 		}
 
 		public double Latitude
 		{
 			get { return y; }
-			set { y = value; }
+			set { y = value; GeometryChanged(); }
 		}
 
 		public MapProjections MapProjection
@@ -27,6 +27,8 @@ namespace WSIMap
 		protected const double deg2rad = Math.PI / 180;
         protected const double deg2mi = FUL.Utils.EarthRadius_sm * deg2rad;
         protected bool Updated = false;
+		[NonSerialized] internal int geometryVersion;	// bumped when the points hit tests use change
+		[NonSerialized] internal FeatureHitIndex[] hitIndexes;	// the hit indexes holding this feature, replaced rather than changed
 #if TRACK_OPENGL_DISPLAY_LISTS
 		// Don't need concurrent dictionary since all successful interactions should be on main (UI) thread
 		private static int mainThreadId = System.Threading.Thread.CurrentThread.ManagedThreadId;
@@ -98,6 +100,17 @@ namespace WSIMap
 			set { visible = value; }
 		}
 
+		// The points hit tests use have changed; any hit index holding the
+		// feature is told, so it doesn't have to look at every feature
+		protected void GeometryChanged()
+		{
+			geometryVersion++;
+			FeatureHitIndex[] indexes = hitIndexes;
+			if (indexes != null)
+				for (int i = 0; i < indexes.Length; i++)
+					indexes[i].FeatureChanged();
+		}
+
 		internal virtual RectangleD GetBoundingRect(MapGL parentMap)
 		{
 			return null;
@@ -17,6 +17,7 @@ namespace WSIMap
         #region Data Members
         List<Feature> list = null;
         protected bool shared;
+        [NonSerialized] internal int version;  // bumped when features are added or removed
         #endregion
 
         public FeatureCollection()
@@ -57,6 +58,7 @@ namespace WSIMap
 			lock (this.SyncRoot)
 			{
 				list.Add(feature);
+				version++;
 			}
         }
 
@@ -68,6 +70,7 @@ namespace WSIMap
 			lock (this.SyncRoot)
 			{
 				list.Insert(index, feature);
+				version++;
 			}
 		}
 
@@ -76,6 +79,7 @@ namespace WSIMap
             lock (this.SyncRoot)
             {
                 list.Remove(feature);
+                version++;
             }
         }
 
@@ -89,6 +93,7 @@ namespace WSIMap
 						return f == feature;
 					}
 				);
+				version++;
 			}
 		}
 
@@ -100,6 +105,7 @@ namespace WSIMap
 				if (l != null)
 					l.Dispose();
                 list.RemoveAt(index);
+                version++;
             }
         }
 
@@ -128,6 +134,7 @@ namespace WSIMap
 
                 // Clear the collection
                 list.Clear();
+                version++;
             }
         }
 
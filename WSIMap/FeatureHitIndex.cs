@@ -0,0 +1,298 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using System.Security;
+using System.Threading;
+
+namespace WSIMap
+{
+	/**
+	 * \class FeatureHitIndex
+	 * \brief A native spatial index over a layer's features, so finding the
+	 * features under the mouse only tests the ones near it
+	 */
+	internal class FeatureHitIndex
+	{
+		#region Data Members
+		private IntPtr index;
+		private List<Entry> entries;		// by id: the layer's features in order, a multipart feature's parts in place of it
+		private List<int> unindexed;		// ids tested on every query
+		private int[] hits;
+		private Entry scratch;				// the next entry, filled in to compare with the current one
+		private FeatureCollection indexed;	// what the entries were last brought up to date with
+		private int indexedVersion;
+		private int changes;				// bumped by the watched features' GeometryChanged
+		private int indexedChanges;
+		private HashSet<Feature> watched;	// the features that tell the index when their geometry changes
+		internal int updateCount;			// times the features were walked again
+		#endregion
+
+		internal enum HitFeatureTypes { HitPoint, HitPolyline, HitPolygon, HitCircle, HitNone = -1, HitAlways = -2 }
+
+		[DllImport("tessellate.dll", EntryPoint = "CreateHitIndex", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern IntPtr CreateHitIndex();
+		[DllImport("tessellate.dll", EntryPoint = "DeleteHitIndex", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void DeleteHitIndex(IntPtr index);
+		[DllImport("tessellate.dll", EntryPoint = "SetHitIndexFeature", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void SetHitIndexFeature(IntPtr index, int id, HitFeatureTypes type, double[] xy, int nPoints, int crossDateline, double radius);
+		[DllImport("tessellate.dll", EntryPoint = "RemoveHitIndexFeature", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void RemoveHitIndexFeature(IntPtr index, int id);
+		[DllImport("tessellate.dll", EntryPoint = "QueryHitIndex", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int QueryHitIndex(IntPtr index, double x, double y, double radius, double lineDistance, int[] ids, int maxIds);
+
+		internal class Entry
+		{
+			public Feature feature;
+			public int featureIndex;		// position in the layer of the feature or its multipart parent
+			public bool geometryTested;		// found by the same test Layer.IsFeatureClose does
+
+			// What the index was given, to tell when the feature has changed
+			internal HitFeatureTypes type;
+			internal int version;
+			internal object points;
+			internal int count;
+			internal bool crossDateline;
+			internal double x, y, radius;
+		}
+
+		// Features compared as objects; a PointD's Equals and hash go by its
+		// coordinates, which change in place
+		private class SameFeature : IEqualityComparer<Feature>
+		{
+			public static readonly SameFeature Comparer = new SameFeature();
+
+			public bool Equals(Feature a, Feature b)
+			{
+				return ReferenceEquals(a, b);
+			}
+
+			public int GetHashCode(Feature feature)
+			{
+				return System.Runtime.CompilerServices.RuntimeHelpers.GetHashCode(feature);
+			}
+		}
+
+		public FeatureHitIndex()
+		{
+			index = CreateHitIndex();
+			entries = new List<Entry>();
+			unindexed = new List<int>();
+			hits = new int[64];
+			scratch = new Entry();
+			watched = new HashSet<Feature>(SameFeature.Comparer);
+		}
+
+		~FeatureHitIndex()
+		{
+			if (index != IntPtr.Zero)
+				DeleteHitIndex(index);
+			index = IntPtr.Zero;
+		}
+
+		// Bring the index up to date with features and return the entries that
+		// may be within distance of p, in the order the layer lists them.  Call
+		// with the collection locked.  The features are walked again only after
+		// the collection or the geometry of one of its features has changed.
+		public List<Entry> Query(FeatureCollection features, PointD p, double distance, bool kilometers)
+		{
+			int changesNow = changes;
+			if (features != indexed || features.version != indexedVersion || changesNow != indexedChanges)
+			{
+				indexedChanges = changesNow;
+				Update(features);
+				indexed = features;
+				indexedVersion = features.version;
+				updateCount++;
+			}
+
+			double radius = distance / (kilometers ? FUL.Utils.EarthRadius_km : FUL.Utils.EarthRadius_sm) * FUL.Utils.rad2deg;
+			int nHits = QueryHitIndex(index, p.Longitude, p.Latitude, radius, distance, hits, hits.Length);
+			if (nHits > hits.Length)
+			{
+				hits = new int[nHits * 2];
+				nHits = QueryHitIndex(index, p.Longitude, p.Latitude, radius, distance, hits, hits.Length);
+			}
+
+			List<int> ids = new List<int>(nHits + unindexed.Count);
+			for (int i = 0; i < nHits; i++)
+				ids.Add(hits[i]);
+			if (unindexed.Count > 0)
+			{
+				ids.AddRange(unindexed);
+				ids.Sort();
+			}
+
+			List<Entry> found = new List<Entry>(ids.Count);
+			foreach (int id in ids)
+				found.Add(entries[id]);
+			return found;
+		}
+
+		// Called by a watched feature, on whatever thread changed it
+		internal void FeatureChanged()
+		{
+			Interlocked.Increment(ref changes);
+		}
+
+		private void Update(FeatureCollection features)
+		{
+			HashSet<Feature> current = new HashSet<Feature>(SameFeature.Comparer);
+			int id = 0;
+			for (int i = 0; i < features.Count; i++)
+			{
+				Feature feature = features[i];
+				if (feature != null && (feature.GetType() == typeof(MultipartFeature) || feature.GetType().BaseType == typeof(MultipartFeature)))
+				{
+					MultipartFeature mpf = (MultipartFeature)feature;
+					current.Add(mpf);
+					for (int j = 0; j < mpf.Count; j++)
+						Update(id++, mpf[j], i, current);
+				}
+				else
+					Update(id++, feature, i, current);
+			}
+
+			for (int i = entries.Count - 1; i >= id; i--)
+				RemoveHitIndexFeature(index, i);
+			if (entries.Count > id)
+				entries.RemoveRange(id, entries.Count - id);
+
+			unindexed.Clear();
+			for (int i = 0; i < entries.Count; i++)
+				if (entries[i].type == HitFeatureTypes.HitAlways)
+					unindexed.Add(i);
+
+			// Watch the features now indexed, and only those
+			foreach (Feature feature in watched)
+				if (!current.Contains(feature))
+					Unwatch(feature);
+			foreach (Feature feature in current)
+				if (!watched.Contains(feature))
+					Watch(feature);
+			watched = current;
+		}
+
+		private void Watch(Feature feature)
+		{
+			FeatureHitIndex[] indexes = feature.hitIndexes;
+			int n = indexes == null ? 0 : indexes.Length;
+			FeatureHitIndex[] watching = new FeatureHitIndex[n + 1];
+			if (n > 0)
+				Array.Copy(indexes, watching, n);
+			watching[n] = this;
+			feature.hitIndexes = watching;
+		}
+
+		private void Unwatch(Feature feature)
+		{
+			FeatureHitIndex[] indexes = feature.hitIndexes;
+			if (indexes == null)
+				return;
+			List<FeatureHitIndex> watching = new List<FeatureHitIndex>(indexes);
+			watching.Remove(this);
+			feature.hitIndexes = watching.Count > 0 ? watching.ToArray() : null;
+		}
+
+		private void Update(int id, Feature feature, int featureIndex, HashSet<Feature> current)
+		{
+			Entry entry = scratch;
+			entry.feature = feature;
+			entry.featureIndex = featureIndex;
+			entry.geometryTested = false;
+			entry.type = HitFeatureTypes.HitNone;
+			entry.version = 0;
+			entry.crossDateline = false;
+			entry.x = entry.y = entry.radius = 0;
+			List<PointD> points = null;
+
+			// Classified in the order Layer.IsFeatureClose tests the types
+			if (feature is IMapPoint)
+			{
+				IMapPoint point = (IMapPoint)feature;
+				entry.type = HitFeatureTypes.HitPoint;
+				entry.x = point.X;
+				entry.y = point.Y;
+			}
+			else if (feature != null && (feature.GetType() == typeof(Curve) || feature.GetType().BaseType == typeof(Curve)))
+			{
+				Curve curve = (Curve)feature;
+				points = curve.PointListToDraw;
+				entry.type = HitFeatureTypes.HitPolyline;
+				entry.crossDateline = curve.IsCrossIDL;
+				entry.geometryTested = true;
+			}
+			else if (feature != null && feature.GetType() == typeof(Polygon))
+			{
+				Polygon polygon = (Polygon)feature;
+				List<PointD> pointList = polygon.PointList;
+
+				// IsFeatureClose tests these as a line; leave them to it
+				if (((pointList.Count == 3) && (pointList[0].DistanceTo(pointList[2], false) == 0)) || (pointList.Count == 2))
+					entry.type = HitFeatureTypes.HitAlways;
+				else
+				{
+					points = polygon.HitTestPointList;
+					entry.type = HitFeatureTypes.HitPolygon;
+					entry.crossDateline = polygon.IsCrossDateline;
+					entry.geometryTested = true;
+				}
+			}
+			else if (feature != null && feature.GetType() == typeof(Circle))
+			{
+				Circle circle = (Circle)feature;
+				if (!PointD.IsNullOrEmpty(circle.Center))
+				{
+					entry.type = HitFeatureTypes.HitCircle;
+					entry.x = circle.Center.X;
+					entry.y = circle.Center.Y;
+					entry.radius = circle.Radius;
+
+					// The center can be moved in place
+					current.Add(circle.Center);
+				}
+			}
+
+			if (feature != null)
+			{
+				entry.version = feature.geometryVersion;
+				current.Add(feature);
+			}
+			entry.points = points;
+			entry.count = points == null ? 0 : points.Count;
+
+			if (id < entries.Count)
+			{
+				Entry old = entries[id];
+				if (old.feature == entry.feature && old.featureIndex == entry.featureIndex && old.type == entry.type &&
+					old.version == entry.version && old.points == entry.points && old.count == entry.count &&
+					old.crossDateline == entry.crossDateline && old.x == entry.x && old.y == entry.y && old.radius == entry.radius)
+					return;
+				entries[id] = entry;
+			}
+			else
+				entries.Add(entry);
+			scratch = new Entry();
+
+			switch (entry.type)
+			{
+				case HitFeatureTypes.HitPoint:
+				case HitFeatureTypes.HitCircle:
+					SetHitIndexFeature(index, id, entry.type, new double[] { entry.x, entry.y }, 1, 0, entry.radius / FUL.Utils.EarthRadius_sm * FUL.Utils.rad2deg);
+					break;
+				case HitFeatureTypes.HitPolyline:
+				case HitFeatureTypes.HitPolygon:
+					double[] xy = new double[points.Count * 2];
+					for (int i = 0; i < points.Count; i++)
+					{
+						xy[i * 2] = points[i].X;
+						xy[i * 2 + 1] = points[i].Y;
+					}
+					SetHitIndexFeature(index, id, entry.type, xy, points.Count, entry.crossDateline ? 1 : 0, 0);
+					break;
+				default:
+					RemoveHitIndexFeature(index, id);
+					break;
+			}
+		}
+	}
+}
@@ -7,6 +7,7 @@ namespace GPC
     using System.Drawing;
     using System.Drawing.Drawing2D;
     using System.Runtime.InteropServices;
+    using System.Security;
     using WSIMap;
     using System.Linq;
 
@@ -114,21 +115,9 @@ namespace GPC
              Polygon combinedLeftOfPMPoly = new Polygon();
              try
              {
-                 for (int i = 0; i < gpcRightOfPMPolygonList.Count; i++)
-                 {
-                     if (i == 0)
-                         combinedRightOfPMPoly = gpcRightOfPMPolygonList[0];
-                     else
-                         combinedRightOfPMPoly = GpcWrapper.Clip(GpcOperation.Union, combinedRightOfPMPoly, gpcRightOfPMPolygonList[i]);
-                 }
-
-                 for (int i = 0; i < gpcLeftOfPMPolygonList.Count; i++)
-                 {
-                     if (i == 0)
-                         combinedLeftOfPMPoly = gpcLeftOfPMPolygonList[0];
-                     else
-                         combinedLeftOfPMPoly = GpcWrapper.Clip(GpcOperation.Union, combinedLeftOfPMPoly, gpcLeftOfPMPolygonList[i]);
-                 }
+                 //Each side is unioned in a single call to the tessellate library rather than one gpc.dll round trip per polygon
+                 combinedRightOfPMPoly = TessBoolean.Union(gpcRightOfPMPolygonList);
+                 combinedLeftOfPMPoly = TessBoolean.Union(gpcLeftOfPMPolygonList);
 
                  //Fusion does not currently support Polygons with 'holes', so just return the original polygon list. This may be possible to determine earlier.
                  if (combinedLeftOfPMPoly.ContourIsHole.Any(x => x) || combinedRightOfPMPoly.ContourIsHole.Any(x => x))
@@ -156,6 +145,114 @@ namespace GPC
          }
     }
 
+    /// <summary>
+    /// Polygon boolean operations done by the tessellate library.  Contours are read under the even-odd rule, as gpc reads them,
+    /// and a whole list of polygons can be unioned in one call.  Results come back with their hole flags set.
+    /// </summary>
+    public class TessBoolean
+    {
+        public static Polygon Clip(GpcOperation operation, Polygon subject_polygon, Polygon clip_polygon)
+        {
+            double[] subjectXY, clipXY;
+            int[] subjectOffsets, clipOffsets;
+            Pack(new Polygon[] { subject_polygon }, out subjectXY, out subjectOffsets);
+            Pack(new Polygon[] { clip_polygon }, out clipXY, out clipOffsets);
+
+            IntPtr result = ClipPolygons(operation, subjectXY, subjectOffsets, subjectOffsets.Length - 1, clipXY, clipOffsets, clipOffsets.Length - 1);
+            return ToPolygon(result);
+        }
+
+        // Union of every contour of every polygon in the list, each contour taken as the outside of a polygon
+        public static Polygon Union(IList<Polygon> polygons)
+        {
+            double[] xy;
+            int[] offsets;
+            Pack(polygons, out xy, out offsets);
+
+            IntPtr result = UnionPolygons(xy, offsets, offsets.Length - 1);
+            return ToPolygon(result);
+        }
+
+        private static void Pack(IList<Polygon> polygons, out double[] xy, out int[] offsets)
+        {
+            int nContours = 0, nPoints = 0;
+            foreach (Polygon p in polygons)
+                for (int c = 0; c < p.NofContours; c++)
+                {
+                    nContours++;
+                    nPoints += p.Contour[c].NofVertices;
+                }
+
+            xy = new double[Math.Max(nPoints * 2, 1)];
+            offsets = new int[nContours + 1];
+            int contour = 0, point = 0;
+            foreach (Polygon p in polygons)
+                for (int c = 0; c < p.NofContours; c++)
+                {
+                    offsets[contour++] = point;
+                    for (int i = 0; i < p.Contour[c].NofVertices; i++)
+                    {
+                        xy[point * 2] = p.Contour[c].Vertex[i].X;
+                        xy[point * 2 + 1] = p.Contour[c].Vertex[i].Y;
+                        point++;
+                    }
+                }
+            offsets[nContours] = point;
+        }
+
+        private static Polygon ToPolygon(IntPtr result)
+        {
+            Polygon polygon = new Polygon();
+            try
+            {
+                int nContours = GetPolygonResultContourCount(result);
+                int nPoints = GetPolygonResultPointCount(result);
+                polygon.NofContours = nContours;
+                polygon.ContourIsHole = new bool[nContours];
+                polygon.Contour = new VertexList[nContours];
+                if (nContours == 0)
+                    return polygon;
+
+                // TessRing is feature, ring, first point and point count; ring is 1 for holes
+                int[] contours = new int[nContours * 4];
+                double[] xy = new double[nPoints * 2];
+                Marshal.Copy(GetPolygonResultContours(result), contours, 0, contours.Length);
+                Marshal.Copy(GetPolygonResultPoints(result), xy, 0, xy.Length);
+                for (int c = 0; c < nContours; c++)
+                {
+                    int firstPoint = contours[c * 4 + 2];
+                    VertexList vertices = new VertexList();
+                    vertices.NofVertices = contours[c * 4 + 3];
+                    vertices.Vertex = new Vertex[vertices.NofVertices];
+                    for (int i = 0; i < vertices.NofVertices; i++)
+                        vertices.Vertex[i] = new Vertex(xy[(firstPoint + i) * 2], xy[(firstPoint + i) * 2 + 1]);
+                    polygon.Contour[c] = vertices;
+                    polygon.ContourIsHole[c] = contours[c * 4 + 1] != 0;
+                }
+            }
+            finally
+            {
+                DeletePolygonResult(result);
+            }
+            return polygon;
+        }
+
+        [DllImport("tessellate.dll", EntryPoint = "ClipPolygons", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr ClipPolygons(GpcOperation operation, double[] subjectXY, int[] subjectOffsets, int nSubject, double[] clipXY, int[] clipOffsets, int nClip);
+        [DllImport("tessellate.dll", EntryPoint = "UnionPolygons", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr UnionPolygons(double[] xy, int[] offsets, int nPolygons);
+        [DllImport("tessellate.dll", EntryPoint = "DeletePolygonResult", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern void DeletePolygonResult(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetPolygonResultContourCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int GetPolygonResultContourCount(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetPolygonResultContours", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr GetPolygonResultContours(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetPolygonResultPointCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int GetPolygonResultPointCount(IntPtr result);
+        [DllImport("tessellate.dll", EntryPoint = "GetPolygonResultPoints", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern IntPtr GetPolygonResultPoints(IntPtr result);
+    }
+
     public class VertexList
     {
         public int NofVertices;
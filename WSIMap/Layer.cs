@@ -24,6 +24,7 @@ namespace WSIMap
 		protected bool dirty;
 		protected bool showOne;			// Only display one context menu & tooltip (the first feature) when there are multiple ones around the mouse 
 		protected int tooltipOrder;         // Decide the order of tooltip displayed
+		private FeatureHitIndex hitIndex;	// features by location, for tooltips
         #endregion
 
         public bool DeclutterPaused { get; set; }
@@ -402,23 +403,28 @@ namespace WSIMap
 			{
 				lock (features.SyncRoot)
 				{
-					for (int i = 0; i < features.Count; i++)
+					// Only the features the hit index finds near p are tested, in layer order
+					if (hitIndex == null)
+						hitIndex = new FeatureHitIndex();
+					System.Collections.Generic.List<FeatureHitIndex.Entry> nearFeatures = hitIndex.Query(features, p, distance, kilometers);
+
+					for (int k = 0; k < nearFeatures.Count; k++)
 					{
+						FeatureHitIndex.Entry near = nearFeatures[k];
+						int i = near.featureIndex;
 						if (features[i] == null)
 							continue;
 						if (!features[i].visible)
 							continue;
 						// Search the features inside the MultipartFeature
-						if (features[i].GetType() == typeof(MultipartFeature) || features[i].GetType().BaseType == typeof(MultipartFeature))
+						if (near.feature != features[i])
 						{
-							MultipartFeature mpf = (MultipartFeature)features[i];
-							for (int j = 0; j < mpf.Count; j++)
-								if (IsFeatureClose(mpf[j], p, distance, kilometers))
-									if (closestFeatures[mpf[j].FeatureName] == null)
-										closestFeatures.Add(mpf[j]);
+							if (IsFeatureClose(near.feature, p, distance, kilometers, near.geometryTested))
+								if (closestFeatures[near.feature.FeatureName] == null)
+									closestFeatures.Add(near.feature);
 						}
 						// Search the other (non-MultipartFeature) features
-						else if (IsFeatureClose(features[i], p, distance, kilometers))
+						else if (IsFeatureClose(features[i], p, distance, kilometers, near.geometryTested))
 						{
 							//check pireps
 							if (features[i].GetType() == typeof(PIREPSymbol))
@@ -506,6 +512,12 @@ namespace WSIMap
 		}
 
 		private bool IsFeatureClose(Feature feature, PointD p, double distance, bool kilometers)
+		{
+			return IsFeatureClose(feature, p, distance, kilometers, false);
+		}
+
+		// geometryTested: the hit index has already found p on the feature
+		private bool IsFeatureClose(Feature feature, PointD p, double distance, bool kilometers, bool geometryTested)
 		{
 			bool close = false;
 
@@ -518,6 +530,9 @@ namespace WSIMap
 			if (mpType == MapProjectionTypes.Azimuthal && p.Y < Projection.MinAzimuthalLatitude)
 				return false;
 
+			if (geometryTested)
+				return true;
+
 			if (feature.GetType().BaseType == typeof(PointD) || feature.GetType() == typeof(PointD) || feature is IMapPoint)
 			{
 				IMapPoint f = feature as IMapPoint;
@@ -698,6 +713,7 @@ namespace WSIMap
 		{
 			lock (features.SyncRoot)
 			{
+				Polygon.RefreshBatch(features, mapProjection, centralLongitude);
 				for (int i = 0; i < features.Count; i++)
 				{
 					IRefreshable f = features[i] as IRefreshable;
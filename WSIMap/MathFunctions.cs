@@ -1,6 +1,8 @@
 using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Runtime.InteropServices;
+using System.Security;
 using FUL;
 
 namespace WSIMap
@@ -26,6 +28,14 @@ namespace WSIMap
 
 	public class DouglasPeucker
 	{
+		[DllImport("tessellate.dll", EntryPoint = "SimplifyPolyline", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int SimplifyPolyline(double[] xy, int nPoints, double tolerance, int method, int[] keptIndices);
+		[DllImport("tessellate.dll", EntryPoint = "SimplifyPolylines", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int SimplifyPolylines(double[] xy, int[] offsets, int nPolylines, double tolerance, int method, int[] keptIndices, int[] keptOffsets, int nThreads);
+
+		private const int SimplifyDouglasPeucker = 0;	// SimplifyMethods in tessellate.h
+		private const int SimplifyVisvalingam = 1;
+
 		/// <summary>
 		/// Uses the Douglas Peucker algorithim to reduce the number of points.
 		/// </summary>
@@ -34,89 +44,90 @@ namespace WSIMap
 		/// <returns></returns>
 		public static List<PointD> DouglasPeuckerReduction(List<PointD> Points, Double Tolerance)
 		{
+			return Reduce(Points, Tolerance, SimplifyDouglasPeucker);
+		}
 
-			if (Points == null || Points.Count < 3)
-				return Points;
-
-			Int32 firstPoint = 0;
-			Int32 lastPoint = Points.Count - 1;
-			List<Int32> pointIndexsToKeep = new List<Int32>();
+		/// <summary>
+		/// Uses the Visvalingam-Whyatt algorithm to reduce the number of points.
+		/// </summary>
+		/// <param name="Points">The points.</param>
+		/// <param name="MinArea">The smallest triangle area a point may form with its neighbors and be kept.</param>
+		/// <returns></returns>
+		public static List<PointD> VisvalingamReduction(List<PointD> Points, Double MinArea)
+		{
+			return Reduce(Points, MinArea, SimplifyVisvalingam);
+		}
 
-			//Add the first and last index to the keepers
-			pointIndexsToKeep.Add(firstPoint);
-			pointIndexsToKeep.Add(lastPoint);
+		/// <summary>
+		/// Reduces a batch of point lists with the Douglas Peucker algorithm in one native call,
+		/// spreading large batches over several threads.
+		/// </summary>
+		/// <param name="PointLists">The point lists.</param>
+		/// <param name="Tolerance">The tolerance.</param>
+		/// <returns></returns>
+		public static List<List<PointD>> DouglasPeuckerReduction(List<List<PointD>> PointLists, Double Tolerance)
+		{
+			if (PointLists == null || PointLists.Count == 0)
+				return PointLists;
 
+			int[] offsets = new int[PointLists.Count + 1];
+			for (int i = 0; i < PointLists.Count; i++)
+				offsets[i + 1] = offsets[i] + (PointLists[i] == null ? 0 : PointLists[i].Count);
 
-			//The first and the last point can not be the same
-			while (Points[firstPoint].Equals(Points[lastPoint]))
+			double[] xy = new double[offsets[PointLists.Count] * 2];
+			int n = 0;
+			foreach (List<PointD> points in PointLists)
 			{
-				lastPoint--;
+				if (points == null) continue;
+				foreach (PointD p in points)
+				{
+					xy[n++] = p.X;
+					xy[n++] = p.Y;
+				}
 			}
 
-			DouglasPeuckerReduction(Points, firstPoint, lastPoint, Tolerance, ref pointIndexsToKeep);
+			int[] kept = new int[Math.Max(offsets[PointLists.Count], 1)];
+			int[] keptOffsets = new int[PointLists.Count + 1];
+			SimplifyPolylines(xy, offsets, PointLists.Count, Tolerance, SimplifyDouglasPeucker, kept, keptOffsets, 0);
 
-			List<PointD> returnPoints = new List<PointD>();
-			pointIndexsToKeep.Sort();
-			foreach (Int32 index in pointIndexsToKeep)
+			List<List<PointD>> returnLists = new List<List<PointD>>(PointLists.Count);
+			for (int i = 0; i < PointLists.Count; i++)
 			{
-				returnPoints.Add(Points[index]);
+				List<PointD> points = PointLists[i];
+				if (points == null || points.Count < 3)
+				{
+					returnLists.Add(points);
+					continue;
+				}
+				List<PointD> returnPoints = new List<PointD>(keptOffsets[i + 1] - keptOffsets[i]);
+				for (int k = keptOffsets[i]; k < keptOffsets[i + 1]; k++)
+					returnPoints.Add(points[kept[k] - offsets[i]]);
+				returnLists.Add(returnPoints);
 			}
 
-			return returnPoints;
+			return returnLists;
 		}
 
-		/// <summary>
-		/// Douglases the peucker reduction.
-		/// </summary>
-		/// <param name="points">The points.</param>
-		/// <param name="firstPoint">The first point.</param>
-		/// <param name="lastPoint">The last point.</param>
-		/// <param name="tolerance">The tolerance.</param>
-		/// <param name="pointIndexsToKeep">The point indexs to keep.</param>
-		private static void DouglasPeuckerReduction(List<PointD> points, Int32 firstPoint, Int32 lastPoint, Double tolerance, ref List<Int32> pointIndexsToKeep)
+		private static List<PointD> Reduce(List<PointD> Points, Double Tolerance, int method)
 		{
-			Double maxDistance = 0;
-			Int32 indexFarthest = 0;
-
-			for (Int32 index = firstPoint; index < lastPoint; index++)
-			{
-				Double distance = PerpendicularDistance(points[firstPoint], points[lastPoint], points[index]);
-				if (distance > maxDistance)
-				{
-					maxDistance = distance;
-					indexFarthest = index;
-				}
-			}
+			if (Points == null || Points.Count < 3)
+				return Points;
 
-			if (maxDistance > tolerance && indexFarthest != 0)
+			double[] xy = new double[Points.Count * 2];
+			for (int i = 0; i < Points.Count; i++)
 			{
-				//Add the largest point that exceeds the tolerance
-				pointIndexsToKeep.Add(indexFarthest);
-
-				DouglasPeuckerReduction(points, firstPoint, indexFarthest, tolerance, ref pointIndexsToKeep);
-				DouglasPeuckerReduction(points, indexFarthest, lastPoint, tolerance, ref pointIndexsToKeep);
+				xy[i * 2] = Points[i].X;
+				xy[i * 2 + 1] = Points[i].Y;
 			}
-		}
 
-		/// <summary>
-		/// The distance of a point from a line made from point1 and point2.
-		/// </summary>
-		/// <param name="pt1">The PT1.</param>
-		/// <param name="pt2">The PT2.</param>
-		/// <param name="p">The p.</param>
-		/// <returns></returns>
-		private static Double PerpendicularDistance(PointD Point1, PointD Point2, PointD Point)
-		{
-			//Area = |(1/2)(x1y2 + x2y3 + x3y1 - x2y1 - x3y2 - x1y3)|   *Area of triangle
-			//Base = sqrt((x1-x2)^2+(x1-x2)^2)                          *Base of Triangle
-			//Area = .5*Base*H                                          *Solve for height
-			//Height = Area/.5/Base
+			int[] kept = new int[Points.Count];
+			int nKept = SimplifyPolyline(xy, Points.Count, Tolerance, method, kept);
 
-			Double area = Math.Abs(.5 * (Point1.X * Point2.Y + Point2.X * Point.Y + Point.X * Point1.Y - Point2.X * Point1.Y - Point.X * Point2.Y - Point1.X * Point.Y));
-			Double bottom = Math.Sqrt(Math.Pow(Point1.X - Point2.X, 2) + Math.Pow(Point1.Y - Point2.Y, 2));
-			Double height = area / bottom * 2;
+			List<PointD> returnPoints = new List<PointD>(nKept);
+			for (int i = 0; i < nKept; i++)
+				returnPoints.Add(Points[kept[i]]);
 
-			return height;
+			return returnPoints;
 		}
 	}
 
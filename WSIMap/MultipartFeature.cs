@@ -77,21 +77,25 @@ namespace WSIMap
         public void Add(Feature feature)
         {
             features.Add(feature);
+            GeometryChanged();
         }
 
         public void Remove(Feature feature)
         {
             features.Remove(feature);
+            GeometryChanged();
         }
 
         public void RemoveAt(int index)
         {
             features.RemoveAt(index);
+            GeometryChanged();
         }
 
         public void Clear(bool disposeFeatures)
         {
             features.Clear(true, disposeFeatures);
+            GeometryChanged();
         }
 
         public Feature this[string featureName]
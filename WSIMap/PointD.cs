@@ -59,25 +59,25 @@ namespace WSIMap
 		public double X
 		{
 			get	{ return x; }
-            set { x = value; Updated = true; }
+            set { x = value; Updated = true; GeometryChanged(); }
 		}
 
 		public double Y
 		{
 			get	{ return y; }
-            set { y = value; Updated = true; }
+            set { y = value; Updated = true; GeometryChanged(); }
 		}
 
 		public double Latitude
 		{
 			get	{ return y;	}
-            set { y = value; Updated = true; }
+            set { y = value; Updated = true; GeometryChanged(); }
 		}
 
 		public double Longitude
 		{
 			get	{ return x;	}
-            set { x = value; Updated = true; }
+            set { x = value; Updated = true; GeometryChanged(); }
 		}
 
 		public virtual Color Color
@@ -20,6 +20,19 @@ namespace WSIMap
 	 *		HORIZONTALHASH	->	LineHorz
 	 */
 
+	/**
+	 * \struct TessPolygonStyle
+	 * \brief Per-polygon fill style passed to TessellatePolygons (mirrors the native struct)
+	 */
+	[StructLayout(LayoutKind.Sequential)]
+	public struct TessPolygonStyle
+	{
+		public int fillColorR, fillColorG, fillColorB;
+		public int opacity;
+		public int stippleColorR, stippleColorG, stippleColorB;
+		public int useStipple;	// nonzero: fill with stippling off, then draw the stipple color with stippling on
+	}
+
 
 	/**
 	 * \class Polygon
@@ -47,6 +60,16 @@ namespace WSIMap
 		private bool endpointFix;
 		private bool endpointFixApplied;
 		private PolygonStipplePattern fillPattern = PolygonStipplePattern.None;
+		private double[] projectedBounds;	// projected left, right, bottom, top of a large polygon, else null
+		private double[] viewportClip;		// the rectangle the fill was clipped to, or null if it wasn't
+		private double[] lastView = new double[4];	// projected view the polygon was last drawn in
+		private bool hasLastView;
+		[NonSerialized] private int drawPointsVersion = -1;	// geometryVersion pointListToDraw was made from
+		[NonSerialized] private MapProjections drawPointsProjection;
+		[NonSerialized] private bool drawPointsSpline;
+		[NonSerialized] private bool drawPointsEndpointFix;
+		private const int ViewportClipMinPoints = 1000;	// smaller polygons are always tessellated whole
+		private const double ViewportClipMargin = 0.5;	// fraction of the view added on each side when clipping
 
 		#region Polygon stipple patterns
 		private static byte[] linePattern = {
@@ -430,6 +453,18 @@ namespace WSIMap
 
 		[DllImport("tessellate.dll", EntryPoint = "TessellatePolygon", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
 		unsafe public static extern void TessellatePolygon(double[] x, double[] y, int nPoints, int fillColorR, int fillColorG, int fillColorB, int opacity, bool isSimple, MapProjections mapProjection, double centralLongitude);
+		[DllImport("tessellate.dll", EntryPoint = "TessellatePolygons", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		unsafe public static extern void TessellatePolygons(double[] xy, int[] offsets, int nPolygons, TessPolygonStyle[] styles, bool isSimple, MapProjections mapProjection, double centralLongitude);
+		[DllImport("tessellate.dll", EntryPoint = "TessellatePolygonsInRect", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		unsafe public static extern void TessellatePolygonsInRect(double[] xy, int[] offsets, int nPolygons, TessPolygonStyle[] styles, bool isSimple, MapProjections mapProjection, double centralLongitude, double[] clipRect);
+		[DllImport("tessellate.dll", EntryPoint = "CreateTessResult", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern IntPtr CreateTessResult();
+		[DllImport("tessellate.dll", EntryPoint = "DeleteTessResult", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void DeleteTessResult(IntPtr result);
+		[DllImport("tessellate.dll", EntryPoint = "TessellatePolygonsToResult", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int TessellatePolygonsToResult(IntPtr result, double[] xy, int[] offsets, int nPolygons, bool isSimple, MapProjections mapProjection, double centralLongitude);
+		[DllImport("tessellate.dll", EntryPoint = "DrawTessResultPolygon", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void DrawTessResultPolygon(IntPtr result, int polygon, ref TessPolygonStyle style);
 
 		public enum PolygonBorderType { Solid, LongDashed, ShortDashed, Dotted, DashDot, Custom };
 
@@ -500,6 +535,17 @@ namespace WSIMap
 			get { return pointList.Count; }
 		}
 
+		// The points IsPointIn tests against
+		internal List<PointD> HitTestPointList
+		{
+			get { return pointListToDraw.Count > 0 ? pointListToDraw : pointList; }
+		}
+
+		internal bool IsCrossDateline
+		{
+			get { return isCrossDateline; }
+		}
+
 		public PointD this[int index]
 		{
 			get
@@ -518,6 +564,7 @@ namespace WSIMap
             {
                 pointList = new List<PointD>(value);
                 Updated = true;
+				GeometryChanged();
 
 				// Check for segments that cross the international date line
 				int nCrossings = NumDatelineCrossings();
@@ -602,6 +649,7 @@ namespace WSIMap
 		{
 			isSimple = -1;
             Updated = true;
+			GeometryChanged();
 			pointList.Add(pt);
 			int index = pointList.Count - 1;
 			if (!isCrossDateline && index > 0)
@@ -619,6 +667,7 @@ namespace WSIMap
 		{
 			isSimple = -1;
             Updated = true;
+			GeometryChanged();
 			pointList.Remove(pt);
 
 			// Check for segments that cross the international date line
@@ -810,6 +859,59 @@ namespace WSIMap
 				CreateDisplayList();
 		}
 
+		// Refresh the polygons among features, tessellating the fills of those
+		// whose display lists need rebuilding in one native call rather than
+		// one each.  Polygons big enough to be clipped to the view are left to
+		// tessellate their own; Refresh then finds all of them up to date.
+		internal static void RefreshBatch(FeatureCollection features, MapProjections mapProjection, short centralLongitude)
+		{
+			if (Tao.Platform.Windows.Wgl.wglGetCurrentContext() == IntPtr.Zero)
+				return;
+
+			List<Polygon> batch = new List<Polygon>();
+			List<double> xy = new List<double>();
+			List<int> offsets = new List<int>();
+			offsets.Add(0);
+			for (int i = 0; i < features.Count; i++)
+			{
+				Polygon polygon = features[i] as Polygon;
+				if (polygon == null || polygon.GetType() != typeof(Polygon))
+					continue;
+				polygon.SetMapProjection(mapProjection, centralLongitude);
+				if ((polygon.openglDisplayList != -1 && !polygon.Updated) || polygon.NothingToDraw() ||
+					polygon.opacity <= 0 || polygon.fillColor == Color.Transparent)
+					continue;
+
+				polygon.PrepareDrawPoints();
+				if (polygon.pointListToDraw.Count >= ViewportClipMinPoints)
+				{
+					polygon.CompileDisplayList(true, IntPtr.Zero, -1);
+					continue;
+				}
+				foreach (PointD p in polygon.pointListToDraw)
+				{
+					xy.Add(p.X);
+					xy.Add(p.Y);
+				}
+				offsets.Add(xy.Count / 2);
+				batch.Add(polygon);
+			}
+			if (batch.Count == 0)
+				return;
+
+			IntPtr fill = CreateTessResult();
+			try
+			{
+				TessellatePolygonsToResult(fill, xy.ToArray(), offsets.ToArray(), batch.Count, false, mapProjection, centralLongitude);
+				for (int i = 0; i < batch.Count; i++)
+					batch[i].CompileDisplayList(true, fill, i);
+			}
+			finally
+			{
+				DeleteTessResult(fill);
+			}
+		}
+
 		private bool AllPointsOutsideProjection()
 		{
 			if (Projection.GetProjectionType(mapProjection) != MapProjectionTypes.Azimuthal)
@@ -829,6 +931,7 @@ namespace WSIMap
 			{
 				this.mapProjection = mapProjection;
 				this.centralLongitude = centralLongitude;
+				hasLastView = false;	// the last view was in the old projection
 				Updated = true;
 			}
 		}
@@ -836,222 +939,332 @@ namespace WSIMap
 		protected void CreateDisplayList()
 		{
             if ((openglDisplayList == -1) || Updated)
-            {
-				double px, py;
+				CompileDisplayList(false, IntPtr.Zero, -1);
+		}
 
-                // Create an OpenGL display list for this file
-				CreateOpenGLDisplayList(TRACKING_CONTEXT);
-                Gl.glNewList(openglDisplayList, Gl.GL_COMPILE);
+		private bool NothingToDraw()
+		{
+			return Count == 0 || (opacity == 0 && borderWidth == 0) || AllPointsOutsideProjection();
+		}
 
-                // Is there anything to draw?
-                if (Count == 0 || (opacity == 0 && borderWidth == 0) || AllPointsOutsideProjection())
-                {
-                    Gl.glEndList();
-					DeleteOpenGLDisplayList(TRACKING_CONTEXT);
-                    return;	// nothing to draw
-                }
+		// A polygon refreshed in a batch (see RefreshBatch) already has its
+		// points to draw, and its fill is polygon batchIndex of batchFill
+		private void CompileDisplayList(bool pointsReady, IntPtr batchFill, int batchIndex)
+		{
+			double px, py;
+			viewportClip = null;
+			projectedBounds = null;
 
-                // Some OpenGL initialization
-                Gl.glEnable(Gl.GL_BLEND);
-                Gl.glBlendFunc(Gl.GL_SRC_ALPHA, Gl.GL_ONE_MINUS_SRC_ALPHA);
-                Gl.glShadeModel(Gl.GL_FLAT);
+            // Create an OpenGL display list for this file
+			CreateOpenGLDisplayList(TRACKING_CONTEXT);
+            Gl.glNewList(openglDisplayList, Gl.GL_COMPILE);
 
-				// If the polygon crosses the date line, adjust the longitudes
-				if (isCrossDateline)
-				{
-					for (int i = 0; i < pointList.Count; i++)
-					{
-						if (pointList[i].X > 0)
-							pointList[i].X -= 360;
-					}
-				}
+            // Is there anything to draw?
+            if (NothingToDraw())
+            {
+                Gl.glEndList();
+				DeleteOpenGLDisplayList(TRACKING_CONTEXT);
+                return;	// nothing to draw
+            }
+
+            // Some OpenGL initialization
+            Gl.glEnable(Gl.GL_BLEND);
+            Gl.glBlendFunc(Gl.GL_SRC_ALPHA, Gl.GL_ONE_MINUS_SRC_ALPHA);
+            Gl.glShadeModel(Gl.GL_FLAT);
 
-				// Add up the vertices
-                numVertices += pointList.Count;
+			if (!pointsReady)
+				PrepareDrawPoints();
 
-				// Hack for large polygons where the endpoints are far apart in longitude (e.g. ozone)
-				if (endpointFix)
+			// Turn on polygon stippling
+			if (fillPattern != PolygonStipplePattern.None)
+			{
+				Gl.glEnable(Gl.GL_POLYGON_STIPPLE);
+				switch (fillPattern)
 				{
-					endpointFixApplied = false;
-					bool wide = false;
-					bool veryWide = false;
-					PointD firstPoint = pointList[0];
-					PointD lastPoint = pointList[pointList.Count - 1];
-					if (Math.Abs(firstPoint.Longitude - lastPoint.Longitude) >= 40)
-						wide = true;
-					if (Math.Abs(firstPoint.Longitude - lastPoint.Longitude) >= 180)
-						veryWide = true;
-
-					// hokey rules to deal with weird polygons
-					bool applyFix = false;
-					applyFix = (wide && (!veryWide || !(Projection.GetProjectionType(mapProjection) == MapProjectionTypes.Azimuthal)))
-						|| (veryWide && (Math.Abs(Math.Abs(firstPoint.Longitude) - Math.Abs(lastPoint.Longitude)) > 10) && (Projection.GetProjectionType(mapProjection) == MapProjectionTypes.Azimuthal));
-
-					if (applyFix)
-					{
-						// add new first & last points at pole
-						pointList.Insert(0, new PointD(firstPoint.Longitude, Math.Sign(firstPoint.Latitude) * 90));
-						pointList.Add(new PointD(lastPoint.Longitude, Math.Sign(lastPoint.Latitude) * 90));
-						endpointFixApplied = true;
-					}
+					case PolygonStipplePattern.Line:
+						Gl.glPolygonStipple(linePattern);
+						break;
+					case PolygonStipplePattern.LineL2R:
+						Gl.glPolygonStipple(lineL2RPattern);
+						break;
+					case PolygonStipplePattern.LineVert:
+						Gl.glPolygonStipple(lineVertPattern);
+						break;
+					case PolygonStipplePattern.LineHorz:
+						Gl.glPolygonStipple(lineHorzPattern);
+						break;
+					case PolygonStipplePattern.DashedLine:
+						Gl.glPolygonStipple(dashedLinePattern);
+						break;
+                    case PolygonStipplePattern.DensityNA:
+                        Gl.glPolygonStipple(DensityNAPattern);
+						break;
+                    case PolygonStipplePattern.DensityGood:
+                        Gl.glPolygonStipple(DensityGoodPattern);
+                        break;
+                    case PolygonStipplePattern.DensityFair:
+                        Gl.glPolygonStipple(DensityFairPattern);
+                        break;
+                    case PolygonStipplePattern.DensityMedium:
+                        Gl.glPolygonStipple(DensityMediumPattern);
+                        break;
+                    case PolygonStipplePattern.DensityPoor:
+                        Gl.glPolygonStipple(DensityPoorPattern);
+                        break;
+                    case PolygonStipplePattern.DensityNil:
+                        Gl.glPolygonStipple(DensityNilPattern);
+                        break;
 				}
+			}
+			
+            // Render the polygon fill
+            if (opacity > 0 && fillColor != Color.Transparent)
+            {
+                Gl.glDepthRange(0.1, 1.0);
+				double[] xy = new double[pointListToDraw.Count * 2];
+				for (int i = 0; i < pointListToDraw.Count; i++)
+                {
+					xy[i * 2] = pointListToDraw[i].X;
+					xy[i * 2 + 1] = pointListToDraw[i].Y;
+                }
+				int[] offsets = { 0, pointListToDraw.Count };
 
-				// Generate interpolated intermediate points. NOTE: This clears pointListToDraw before generating interpolated points.
-				GenerateInterpolatedPoints();
-
-				// Hack to remove points added above for large polygons
-				if (endpointFix && endpointFixApplied)
+				// if stipple color is defined, then draw background color first
+				// then draw second layer with colored pattern
+ 					// otherwise draw normal single layer polygon
+				// (the polygon is tessellated once for both layers)
+				TessPolygonStyle[] style = new TessPolygonStyle[1];
+				style[0].fillColorR = fillColor.R;
+				style[0].fillColorG = fillColor.G;
+				style[0].fillColorB = fillColor.B;
+				style[0].opacity = (int)opacity;
+				if (stippleColor != Color.Transparent)
 				{
-					pointList.RemoveAt(pointList.Count - 1);
-					pointList.RemoveAt(0);
+					style[0].stippleColorR = stippleColor.R;
+					style[0].stippleColorG = stippleColor.G;
+					style[0].stippleColorB = stippleColor.B;
+					style[0].useStipple = 1;
 				}
 
-				// If the user specified that they need the video card fix where we don't draw polygons (FIR) quite as
-				// accurately, then do that.
-				if (FusionSettings.Map.SimplePolygonsFix)
+				// Polygons a layer refreshes together were tessellated in one
+				// batch.  Large polygons that reach well outside the view are
+				// clipped to the area around it before they are tessellated.
+				if (batchFill != IntPtr.Zero)
+					DrawTessResultPolygon(batchFill, batchIndex, ref style[0]);
+				else
 				{
-					if (pointListToDraw.Count > FusionSettings.Map.SimplePolygonsMaxPoints)
-						pointListToDraw = DouglasPeucker.DouglasPeuckerReduction(pointListToDraw, FusionSettings.Map.SimplePolygonsTolerance);
+					SetViewportClip(xy);
+					if (viewportClip != null)
+						TessellatePolygonsInRect(xy, offsets, 1, style, false, mapProjection, centralLongitude, viewportClip);
+					else
+						TessellatePolygons(xy, offsets, 1, style, false, mapProjection, centralLongitude);
 				}
+                Gl.glDepthRange(0.0, 1.0);
+            }
 
-				// Turn on polygon stippling
-				if (fillPattern != PolygonStipplePattern.None)
-				{
-					Gl.glEnable(Gl.GL_POLYGON_STIPPLE);
-					switch (fillPattern)
-					{
-						case PolygonStipplePattern.Line:
-							Gl.glPolygonStipple(linePattern);
-							break;
-						case PolygonStipplePattern.LineL2R:
-							Gl.glPolygonStipple(lineL2RPattern);
-							break;
-						case PolygonStipplePattern.LineVert:
-							Gl.glPolygonStipple(lineVertPattern);
-							break;
-						case PolygonStipplePattern.LineHorz:
-							Gl.glPolygonStipple(lineHorzPattern);
-							break;
-						case PolygonStipplePattern.DashedLine:
-							Gl.glPolygonStipple(dashedLinePattern);
-							break;
-                        case PolygonStipplePattern.DensityNA:
-                            Gl.glPolygonStipple(DensityNAPattern);
-							break;
-                        case PolygonStipplePattern.DensityGood:
-                            Gl.glPolygonStipple(DensityGoodPattern);
+			// Turn off polygon stippling
+			if (fillPattern != PolygonStipplePattern.None)
+				Gl.glDisable(Gl.GL_POLYGON_STIPPLE);
+
+            // Render the polygon border
+            if (borderWidth > 0)
+            {
+                // Setup
+                Gl.glEnable(Gl.GL_LINE_SMOOTH);
+                Gl.glDepthRange(0.0, 0.9);
+                Gl.glColor3f(glc(borderColor.R), glc(borderColor.G), glc(borderColor.B));
+                Gl.glLineWidth(borderWidth);
+                if (borderType != PolygonBorderType.Solid)
+                {
+                    switch (borderType)
+                    {
+                        case PolygonBorderType.LongDashed:
+                            stipplePattern = 0x00FF;
                             break;
-                        case PolygonStipplePattern.DensityFair:
-                            Gl.glPolygonStipple(DensityFairPattern);
+                        case PolygonBorderType.ShortDashed:
+                            stipplePattern = 0x0F0F;
                             break;
-                        case PolygonStipplePattern.DensityMedium:
-                            Gl.glPolygonStipple(DensityMediumPattern);
+                        case PolygonBorderType.Dotted:
+                            stipplePattern = 0xCCCC;
                             break;
-                        case PolygonStipplePattern.DensityPoor:
-                            Gl.glPolygonStipple(DensityPoorPattern);
+						case PolygonBorderType.DashDot:
+							stipplePattern = 0x18FF;
                             break;
-                        case PolygonStipplePattern.DensityNil:
-                            Gl.glPolygonStipple(DensityNilPattern);
+                        case PolygonBorderType.Custom:
+                            // stipple pattern set by user
+                            break;
+                        default:
                             break;
-					}
-				}
-				
-                // Render the polygon fill
-                if (opacity > 0 && fillColor != Color.Transparent)
-                {
-                    Gl.glDepthRange(0.1, 1.0);
-					double[] x = new double[pointListToDraw.Count];
-					double[] y = new double[pointListToDraw.Count];
-					for (int i = 0; i < pointListToDraw.Count; i++)
-                    {
-						x[i] = pointListToDraw[i].X;
-						y[i] = pointListToDraw[i].Y;
                     }
+                    Gl.glLineStipple(stippleFactor, stipplePattern);
+                    Gl.glEnable(Gl.GL_LINE_STIPPLE);
+                }
 
-					// if stipple color is defined, then draw background color first
-					// then draw second layer with colored pattern
- 					// otherwise draw normal single layer polygon
-					if (stippleColor != Color.Transparent)
-						Gl.glDisable(Gl.GL_POLYGON_STIPPLE);
-					TessellatePolygon(x, y, pointListToDraw.Count, fillColor.R, fillColor.G, fillColor.B, (int)opacity, false, mapProjection, centralLongitude);
-                    Gl.glDepthRange(0.0, 1.0);
+                // Draw the border for the polygon
+				MapProjectionTypes mpType = Projection.GetProjectionType(mapProjection);
+                Gl.glBegin(Gl.GL_LINE_LOOP);
+				for (int i = 0; i < pointListToDraw.Count; i++)
+				{
+					if (mpType == MapProjectionTypes.Azimuthal && pointListToDraw[i].Y < Projection.MinAzimuthalLatitude)
+						Projection.ProjectPoint(mapProjection, pointListToDraw[i].X, Projection.MinAzimuthalLatitude, centralLongitude, out px, out py);
+					else
+						Projection.ProjectPoint(mapProjection, pointListToDraw[i].X, pointListToDraw[i].Y, centralLongitude, out px, out py);
+					Gl.glVertex2d(px, py);
+				}
+                Gl.glEnd();
 
-					if (stippleColor != Color.Transparent)
-					{
-						Gl.glEnable(Gl.GL_POLYGON_STIPPLE);
-						TessellatePolygon(x, y, pointListToDraw.Count, stippleColor.R, stippleColor.G, stippleColor.B, (int)opacity, false, mapProjection, centralLongitude);
-						Gl.glDepthRange(0.0, 1.0);
-					}
-                }
+                // Cleanup
+                Gl.glDepthRange(0.0, 1.0);
+                Gl.glDisable(Gl.GL_LINE_SMOOTH);
+                if (borderType != PolygonBorderType.Solid)
+                    Gl.glDisable(Gl.GL_LINE_STIPPLE);
+            }
 
-				// Turn off polygon stippling
-				if (fillPattern != PolygonStipplePattern.None)
-					Gl.glDisable(Gl.GL_POLYGON_STIPPLE);
+            // End the OpenGL display list
+            Gl.glEndList();
 
-                // Render the polygon border
-                if (borderWidth > 0)
-                {
-                    // Setup
-                    Gl.glEnable(Gl.GL_LINE_SMOOTH);
-                    Gl.glDepthRange(0.0, 0.9);
-                    Gl.glColor3f(glc(borderColor.R), glc(borderColor.G), glc(borderColor.B));
-                    Gl.glLineWidth(borderWidth);
-                    if (borderType != PolygonBorderType.Solid)
-                    {
-                        switch (borderType)
-                        {
-                            case PolygonBorderType.LongDashed:
-                                stipplePattern = 0x00FF;
-                                break;
-                            case PolygonBorderType.ShortDashed:
-                                stipplePattern = 0x0F0F;
-                                break;
-                            case PolygonBorderType.Dotted:
-                                stipplePattern = 0xCCCC;
-                                break;
-							case PolygonBorderType.DashDot:
-								stipplePattern = 0x18FF;
-                                break;
-                            case PolygonBorderType.Custom:
-                                // stipple pattern set by user
-                                break;
-                            default:
-                                break;
-                        }
-                        Gl.glLineStipple(stippleFactor, stipplePattern);
-                        Gl.glEnable(Gl.GL_LINE_STIPPLE);
-                    }
+            if (Updated)
+                Updated = false;
+		}
 
-                    // Draw the border for the polygon
-					MapProjectionTypes mpType = Projection.GetProjectionType(mapProjection);
-                    Gl.glBegin(Gl.GL_LINE_LOOP);
-					for (int i = 0; i < pointListToDraw.Count; i++)
+		// Work out the points the fill and border are drawn from
+		private void PrepareDrawPoints()
+		{
+			// If the polygon crosses the date line, adjust the longitudes
+			if (isCrossDateline)
+			{
+				bool shifted = false;
+				for (int i = 0; i < pointList.Count; i++)
+				{
+					if (pointList[i].X > 0)
 					{
-						if (mpType == MapProjectionTypes.Azimuthal && pointListToDraw[i].Y < Projection.MinAzimuthalLatitude)
-							Projection.ProjectPoint(mapProjection, pointListToDraw[i].X, Projection.MinAzimuthalLatitude, centralLongitude, out px, out py);
-						else
-							Projection.ProjectPoint(mapProjection, pointListToDraw[i].X, pointListToDraw[i].Y, centralLongitude, out px, out py);
-						Gl.glVertex2d(px, py);
+						pointList[i].X -= 360;
+						shifted = true;
 					}
-                    Gl.glEnd();
+				}
+				if (shifted)
+					GeometryChanged();
+			}
 
-                    // Cleanup
-                    Gl.glDepthRange(0.0, 1.0);
-                    Gl.glDisable(Gl.GL_LINE_SMOOTH);
-                    if (borderType != PolygonBorderType.Solid)
-                        Gl.glDisable(Gl.GL_LINE_STIPPLE);
-                }
+			// Add up the vertices
+            numVertices += pointList.Count;
 
-                // End the OpenGL display list
-                Gl.glEndList();
+			// Hack for large polygons where the endpoints are far apart in longitude (e.g. ozone)
+			if (endpointFix)
+			{
+				endpointFixApplied = false;
+				bool wide = false;
+				bool veryWide = false;
+				PointD firstPoint = pointList[0];
+				PointD lastPoint = pointList[pointList.Count - 1];
+				if (Math.Abs(firstPoint.Longitude - lastPoint.Longitude) >= 40)
+					wide = true;
+				if (Math.Abs(firstPoint.Longitude - lastPoint.Longitude) >= 180)
+					veryWide = true;
+
+				// hokey rules to deal with weird polygons
+				bool applyFix = false;
+				applyFix = (wide && (!veryWide || !(Projection.GetProjectionType(mapProjection) == MapProjectionTypes.Azimuthal)))
+					|| (veryWide && (Math.Abs(Math.Abs(firstPoint.Longitude) - Math.Abs(lastPoint.Longitude)) > 10) && (Projection.GetProjectionType(mapProjection) == MapProjectionTypes.Azimuthal));
+
+				if (applyFix)
+				{
+					// add new first & last points at pole
+					pointList.Insert(0, new PointD(firstPoint.Longitude, Math.Sign(firstPoint.Latitude) * 90));
+					pointList.Add(new PointD(lastPoint.Longitude, Math.Sign(lastPoint.Latitude) * 90));
+					endpointFixApplied = true;
+				}
+			}
 
-                if (Updated)
-                    Updated = false;
-            }
+			// Generate interpolated intermediate points. NOTE: This clears pointListToDraw before generating interpolated points.
+			GenerateInterpolatedPoints();
+
+			// Hack to remove points added above for large polygons
+			if (endpointFix && endpointFixApplied)
+			{
+				pointList.RemoveAt(pointList.Count - 1);
+				pointList.RemoveAt(0);
+			}
+
+			// If the user specified that they need the video card fix where we don't draw polygons (FIR) quite as
+			// accurately, then do that.
+			if (FusionSettings.Map.SimplePolygonsFix)
+			{
+				if (pointListToDraw.Count > FusionSettings.Map.SimplePolygonsMaxPoints)
+					pointListToDraw = DouglasPeucker.DouglasPeuckerReduction(pointListToDraw, FusionSettings.Map.SimplePolygonsTolerance);
+			}
+		}
+
+		private void SetViewportClip(double[] xy)
+		{
+			int n = xy.Length / 2;
+			if (n < ViewportClipMinPoints)
+				return;
+
+			double[] x = new double[n];
+			double[] y = new double[n];
+			for (int i = 0; i < n; i++)
+			{
+				x[i] = xy[i * 2];
+				y[i] = xy[i * 2 + 1];
+			}
+			Projection.ProjectPoints(mapProjection, centralLongitude, x, y, x, y);
+			projectedBounds = new double[] { x[0], x[0], y[0], y[0] };
+			for (int i = 1; i < n; i++)
+			{
+				projectedBounds[0] = Math.Min(projectedBounds[0], x[i]);
+				projectedBounds[1] = Math.Max(projectedBounds[1], x[i]);
+				projectedBounds[2] = Math.Min(projectedBounds[2], y[i]);
+				projectedBounds[3] = Math.Max(projectedBounds[3], y[i]);
+			}
+
+			if (ClipToView())
+			{
+				double marginX = (lastView[1] - lastView[0]) * ViewportClipMargin;
+				double marginY = (lastView[3] - lastView[2]) * ViewportClipMargin;
+				viewportClip = new double[] { lastView[0] - marginX, lastView[1] + marginX, lastView[2] - marginY, lastView[3] + marginY };
+			}
+		}
+
+		private bool ClipToView()
+		{
+			// Only worth it when the polygon reaches past the clip rectangle
+			if (!hasLastView || projectedBounds == null)
+				return false;
+			double marginX = (lastView[1] - lastView[0]) * ViewportClipMargin;
+			double marginY = (lastView[3] - lastView[2]) * ViewportClipMargin;
+			return !(projectedBounds[0] >= lastView[0] - marginX && projectedBounds[1] <= lastView[1] + marginX &&
+				projectedBounds[2] >= lastView[2] - marginY && projectedBounds[3] <= lastView[3] + marginY);
+		}
+
+		private bool ViewportClipStale(MapGL parentMap, bool crossIDL)
+		{
+			// Views drawn with a 360 degree shift are never clipped
+			hasLastView = !(parentMap.BoundingBox.Map.left < -180 || parentMap.BoundingBox.Map.right > 180 || crossIDL);
+			lastView[0] = parentMap.BoundingBox.Map.left;
+			lastView[1] = parentMap.BoundingBox.Map.right;
+			lastView[2] = parentMap.BoundingBox.Map.bottom;
+			lastView[3] = parentMap.BoundingBox.Map.top;
+
+			bool clip = ClipToView();
+			if (clip != (viewportClip != null))
+				return true;
+			return clip && (lastView[0] < viewportClip[0] || lastView[1] > viewportClip[1] ||
+				lastView[2] < viewportClip[2] || lastView[3] > viewportClip[3]);
 		}
 
 		private void GenerateInterpolatedPoints()
 		{
+			// The points only move if what they are made from has changed, not
+			// when they are made again for a new view
+			if (drawPointsVersion != geometryVersion || drawPointsProjection != mapProjection || drawPointsSpline != cubicSplineFit || drawPointsEndpointFix != endpointFix)
+			{
+				GeometryChanged();
+				drawPointsVersion = geometryVersion;
+				drawPointsProjection = mapProjection;
+				drawPointsSpline = cubicSplineFit;
+				drawPointsEndpointFix = endpointFix;
+			}
 			if (cubicSplineFit)
 				GenerateCubicSplinePoints();
 			else
@@ -1242,6 +1455,15 @@ namespace WSIMap
                 }
             }
 
+            // Rebuild a viewport clipped fill once the view leaves the clip
+            // rectangle, or when clipping starts or stops paying off
+            if (ViewportClipStale(parentMap, crossIDL))
+            {
+                Updated = true;
+                CreateDisplayList();
+                if (openglDisplayList == -1) return;
+            }
+
             if (parentMap.BoundingBox.Map.left < -180 || parentMap.BoundingBox.Map.right > 180 || crossIDL)
                 MapGL.DrawDisplayListWithShift(openglDisplayList, parentMap.BoundingBox.Map.left, parentMap.BoundingBox.Map.right, crossIDL);
             else
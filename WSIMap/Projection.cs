@@ -1,4 +1,6 @@
 ﻿using System;
+using System.Runtime.InteropServices;
+using System.Security;
 
 namespace WSIMap
 {
@@ -43,6 +45,16 @@ namespace WSIMap
 			}
 		}
 
+		public static void ProjectPoints(MapProjections mapProjection, double centralLon, double[] x, double[] y, double[] px, double[] py)
+		{
+			// Projects the whole batch in one native call
+			int n = Math.Min(x.Length, y.Length);
+			if (px.Length < n || py.Length < n)
+				throw new ArgumentException("The output arrays are too short");
+			if (n > 0)
+				ProjectPointsNative(mapProjection, centralLon, x, y, px, py, n);
+		}
+
 		public static void UnprojectPoint(MapProjections mapProjection, double px, double py, double centralLon, out double x, out double y)
 		{
 			switch (mapProjection)
@@ -110,6 +122,9 @@ namespace WSIMap
 			urect = new RectangleD(b, t, l, r);
 		}
 
+		[DllImport("tessellate.dll", EntryPoint = "ProjectPoints", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void ProjectPointsNative(MapProjections mapProjection, double centralLongitude, double[] lon, double[] lat, [Out] double[] px, [Out] double[] py, int n);
+
 		public static MapProjectionTypes GetProjectionType(MapProjections mapProjection)
 		{
 			MapProjectionTypes type;
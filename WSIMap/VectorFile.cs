@@ -1,5 +1,6 @@
 using System;
 using System.Collections;
+using System.Collections.Generic;
 using System.Drawing;
 using System.Runtime.InteropServices;
 using System.Security;
@@ -25,15 +26,106 @@ namespace WSIMap
 		protected bool drawBorder;		// if true, draw a border on the features
 		protected bool fillFeatures;	// if true, fill in the feature
         protected bool stencil;         // if true, use stencil buffer
+		protected int levelsOfDetail;	// number of levels of detail, including full detail
+		protected int[] lodDisplayLists;	// display lists for the simplified levels of detail
+		protected double[] lodTolerances;	// simplification tolerance (degrees) of each of those lists
+		protected IntPtr geometry;		// native geometry, kept so a projection change only reprojects it
+		private bool geometryHasFill;
+		private bool geometryHasBorder;
+		private int geometryLods;
+		private DateTime geometryFileTime;
+		private MapProjections geometryProjection;
+		private short geometryCentralLongitude;
+		private bool cullToView;		// draw regional views from geometry, only the features in view
+		private bool cullFill;
+		private int[] cullFillRGB;
+		private int[] cullFill2RGB;
+		private int[] cullBorderRGB;
+		private double[] geometryBounds;
+		private double[] viewRect;
+		protected bool loadAsync;		// read and tessellate on the native loader thread
+		private IntPtr loadJob;
 		protected ErrorCodes errorCode;
 		public enum ErrorCodes { NoError, SHPFileDoesNotExist, SHXFileDoesNotExist, ErrorOpeningFile, WrongNumberOfLayers, Exception };
 		protected MapProjections mapProjection;
 		protected short centralLongitude;
 		private const string TRACKING_CONTEXT = "VectorFile";
+		private const int VectorFileOK = 0;				// VectorFileStatus in tessellate.h
+		private const int VectorFileLayerError = 2;
+		private const double LodBaseTolerance = 0.02;	// degrees allowed for the first simplified level
 		#endregion
 
-		[DllImport("tessellate.dll", EntryPoint = "TessellateVectorFile", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
-		unsafe public static extern void TessellateVectorFile(string vectorFileName, int[] fillColorRGB, bool useTwoColors, int[] fillColor2RGB, int opacity, MapProjections mapProjection, double centralLongitude);
+		[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+		private delegate void VectorFileLoadCallback(IntPtr job, IntPtr userData);
+
+		// The loader thread can call back after the VectorFile that began a
+		// job is gone, so the callback is static and finds the map to repaint
+		// by job; a job's entry goes when it is ended or cancelled
+		private static readonly VectorFileLoadCallback loadCallback = new VectorFileLoadCallback(LoadFinished);
+		private static Dictionary<IntPtr, MapGL> loadingMaps = new Dictionary<IntPtr, MapGL>();
+
+		[DllImport("tessellate.dll", EntryPoint = "LoadVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern IntPtr LoadVectorFileGeometry(string vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude);
+		[DllImport("tessellate.dll", EntryPoint = "LoadVectorFileGeometryLods", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern IntPtr LoadVectorFileGeometryLods(string vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance);
+		[DllImport("tessellate.dll", EntryPoint = "BeginLoadVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern IntPtr BeginLoadVectorFileGeometry(string vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance, VectorFileLoadCallback callback, IntPtr userData);
+		[DllImport("tessellate.dll", EntryPoint = "IsVectorFileLoadDone", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int IsVectorFileLoadDone(IntPtr job);
+		[DllImport("tessellate.dll", EntryPoint = "EndLoadVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern IntPtr EndLoadVectorFileGeometry(IntPtr job);
+		[DllImport("tessellate.dll", EntryPoint = "CancelLoadVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern void CancelLoadVectorFileGeometry(IntPtr job);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileLodCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int GetVectorFileLodCount(IntPtr geometry);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileLodTolerance", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern double GetVectorFileLodTolerance(IntPtr geometry, int lod);
+		[DllImport("tessellate.dll", EntryPoint = "SetVectorFileLod", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void SetVectorFileLod(IntPtr geometry, int lod);
+		[DllImport("tessellate.dll", EntryPoint = "ReprojectVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int ReprojectVectorFileGeometry(IntPtr geometry, MapProjections mapProjection, double centralLongitude);
+		[DllImport("tessellate.dll", EntryPoint = "DeleteVectorFileGeometry", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DeleteVectorFileGeometry(IntPtr geometry);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileStatus", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int GetVectorFileStatus(IntPtr geometry);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileFeatureCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int GetVectorFileFeatureCount(IntPtr geometry);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileBorderPointCount", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int GetVectorFileBorderPointCount(IntPtr geometry);
+		[DllImport("tessellate.dll", EntryPoint = "DrawVectorFileFill", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DrawVectorFileFill(IntPtr geometry, int[] fillColorRGB, bool useTwoColors, int[] fillColor2RGB, int opacity);
+		[DllImport("tessellate.dll", EntryPoint = "DrawVectorFileBorder", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DrawVectorFileBorder(IntPtr geometry, int[] borderColorRGB, int borderWidth);
+		[DllImport("tessellate.dll", EntryPoint = "GetVectorFileBounds", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int GetVectorFileBounds(IntPtr geometry, double[] bounds);
+		[DllImport("tessellate.dll", EntryPoint = "QueryVectorFileFillRanges", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int QueryVectorFileFillRanges(IntPtr geometry, double[] rect, int[] ranges, int maxRanges);
+		[DllImport("tessellate.dll", EntryPoint = "QueryVectorFileBorderRanges", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern int QueryVectorFileBorderRanges(IntPtr geometry, double[] rect, int[] rings, int maxRings);
+		[DllImport("tessellate.dll", EntryPoint = "DrawVectorFileFillInRect", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DrawVectorFileFillInRect(IntPtr geometry, double[] rect, int[] fillColorRGB, bool useTwoColors, int[] fillColor2RGB, int opacity);
+		[DllImport("tessellate.dll", EntryPoint = "DrawVectorFileBorderInRect", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DrawVectorFileBorderInRect(IntPtr geometry, double[] rect, int[] borderColorRGB, int borderWidth);
+		[DllImport("tessellate.dll", EntryPoint = "OpenTessCache", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern IntPtr OpenTessCache(string fileName);
+		[DllImport("tessellate.dll", EntryPoint = "CloseTessCache", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void CloseTessCache(IntPtr cache);
+		[DllImport("tessellate.dll", EntryPoint = "DrawTessCache", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void DrawTessCache(IntPtr cache, int[] fillColorRGB, bool useTwoColors, int[] fillColor2RGB, int opacity);
+		[DllImport("tessellate.dll", EntryPoint = "OpenVectorBundle", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		private static extern int OpenVectorBundle(string bundleFileName);
+		[DllImport("tessellate.dll", EntryPoint = "CloseVectorBundles", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+		public static extern void CloseVectorBundles();
+
+		// Read a basemap bundle built by tessbundle.exe.  Vector files loaded
+		// afterwards that are in the bundle, and unchanged since it was built,
+		// come out of it instead of being read.  Returns the number of files.
+		public static int OpenBundle(string bundleFileName)
+		{
+			if (!System.IO.File.Exists(bundleFileName))
+				return 0;
+			return OpenVectorBundle(bundleFileName);
+		}
 
 		public VectorFile(string vectorFileName) : this(vectorFileName, string.Empty, string.Empty)
 		{
@@ -62,12 +154,18 @@ namespace WSIMap
 			this.fillFeatures = false;
 			this.drawBorder = true;
             this.stencil = false;
+			this.levelsOfDetail = 4;
+			this.geometryBounds = new double[4];
+			this.viewRect = new double[4];
 			this.mapProjection = MapProjections.CylindricalEquidistant;
 		}
 
 		public void Dispose()
 		{
 			DeleteOpenGLDisplayList(TRACKING_CONTEXT);
+			DeleteLodDisplayLists();
+			CancelLoad();
+			DeleteGeometry();
 		}
 
 		public MapProjections MapProjection
@@ -139,6 +237,18 @@ namespace WSIMap
             set { stencil = value; }
         }
 
+		public bool LoadAsync
+		{
+			get { return loadAsync; }
+			set { loadAsync = value; }
+		}
+
+		public int LevelsOfDetail
+		{
+			get { return levelsOfDetail; }
+			set { levelsOfDetail = (value < 1) ? 1 : value; }
+		}
+
 		public void Refresh(MapProjections mapProjection, short centralLongitude)
 		{
 			this.mapProjection = mapProjection;
@@ -158,6 +268,19 @@ namespace WSIMap
 			ConfirmMainThread("VectorFile Draw()");
 #endif
 
+			// Nothing is drawn until a background load finishes; then the
+			// display lists are built from its geometry
+			if (loadJob != IntPtr.Zero)
+			{
+				SetLoadingMap(loadJob, parentMap);
+				if (IsVectorFileLoadDone(loadJob) == 0)
+					return;
+				SetLoadingMap(loadJob, null);
+				geometry = EndLoadVectorFileGeometry(loadJob);
+				loadJob = IntPtr.Zero;
+				LoadFromFile();
+			}
+
 			if (openglDisplayList == -1) return;
 
             if (stencil)
@@ -172,17 +295,24 @@ namespace WSIMap
                 Gl.glStencilOp(Gl.GL_REPLACE, Gl.GL_REPLACE, Gl.GL_REPLACE);
             }
 
+            int lod = SelectLod(parentMap);
+            if (cullToView && DrawInView(parentMap, lod))
+                return;
+
+            int displayList = (lod == 0) ? openglDisplayList : lodDisplayLists[lod - 1];
             if (parentMap.BoundingBox.Map.left < -180 || parentMap.BoundingBox.Map.right > 180)                
-                MapGL.DrawDisplayListWithShift(openglDisplayList, parentMap.BoundingBox.Map.left, parentMap.BoundingBox.Map.right);            
+                MapGL.DrawDisplayListWithShift(displayList, parentMap.BoundingBox.Map.left, parentMap.BoundingBox.Map.right);            
             else
-                Gl.glCallList(openglDisplayList);
+                Gl.glCallList(displayList);
 		}
 
-		private unsafe void LoadFromFile()
+		private void LoadFromFile()
 		{
 			// TODO: This works with ESRI shapefiles.  It hasn't been tested with other vector formats.
 
 			// Create an OpenGL display list for this file
+			cullToView = false;
+			DeleteLodDisplayLists();
 			CreateOpenGLDisplayList(TRACKING_CONTEXT);
 			Gl.glNewList(openglDisplayList, Gl.GL_COMPILE);
 
@@ -205,183 +335,301 @@ namespace WSIMap
 				return;
 			}
 
-			// Determine if this is an azimuthal projection type
-			bool isAziumuthalProj = (Projection.GetProjectionType(mapProjection) == MapProjectionTypes.Azimuthal);
-
 			// Reset the total number of vertices and features for this file
 			numVertices = 0;
 			numFeatures = 0;
 
 			//------------------------------------------------------------
-			// First, fill the polygons by tessellating them
-			//------------------------------------------------------------
-			if (fillFeatures && fillColor != Color.Transparent)
-			{
-				int[] c1 = new int[3];
-				int[] c2 = new int[3];
-				c1[0] = fillColor.R; c1[1] = fillColor.G; c1[2] = fillColor.B;
-				c2[0] = fillColor2.R; c2[1] = fillColor2.G; c2[2] = fillColor2.B;
-				TessellateVectorFile(fileName, c1, useTwoColors, c2, (int)opacity, mapProjection, centralLongitude);
-			}
-
-			//------------------------------------------------------------
-			// Second, read the file again to draw the polygon borders
+			// Fills come from the triangle cache if there is one, the
+			// rest is read from the file in a single native pass
 			//------------------------------------------------------------
-			if (!drawBorder)
+			int[] c1 = new int[3];
+			int[] c2 = new int[3];
+			c1[0] = fillColor.R; c1[1] = fillColor.G; c1[2] = fillColor.B;
+			c2[0] = fillColor2.R; c2[1] = fillColor2.G; c2[2] = fillColor2.B;
+			bool loadFill = fillFeatures && fillColor != Color.Transparent;
+			if (loadFill && DrawTriangleCache(c1, c2))
+				loadFill = false;
+			if (!loadFill && !drawBorder)
 			{
 				Gl.glEndList();
 				return;
 			}
+
+			// Simplified levels of detail are built unless the fill came from the
+			// cache, which only holds full detail
+			bool fillFromCache = fillFeatures && fillColor != Color.Transparent && !loadFill;
+			int nLods = fillFromCache ? 1 : levelsOfDetail;
+
+			bool listEnded = false;
 			try
 			{
-				// Register all OGR drivers
-				GDAL.OGRRegisterAll();
-
-				// Open the vector file
-				void* driver = null;
-				void* dataSource = GDAL.OGROpen(fileName, 0, ref driver);
-				if (dataSource == null)
+				// The geometry from the last load is reprojected if it still
+				// has everything needed; otherwise the file is read again
+				DateTime fileTime = System.IO.File.GetLastWriteTimeUtc(fileName);
+				bool geometryUsable = (!loadFill || geometryHasFill) && (!drawBorder || geometryHasBorder) &&
+					geometryLods == nLods && geometryFileTime == fileTime;
+				if (loadJob != IntPtr.Zero && !geometryUsable)
+					CancelLoad();
+				if (geometry != IntPtr.Zero && geometryUsable)
 				{
+					if (geometryProjection != mapProjection || geometryCentralLongitude != centralLongitude)
+						ReprojectVectorFileGeometry(geometry, mapProjection, centralLongitude);
+				}
+				else if (loadAsync)
+				{
+					// Read and tessellate on the native loader thread.  Draw
+					// comes back here when the geometry is ready.
+					if (loadJob == IntPtr.Zero)
+						BeginLoad(loadFill, nLods, fileTime);
 					Gl.glEndList();
+					listEnded = true;
 					DeleteOpenGLDisplayList(TRACKING_CONTEXT);
-					errorCode = ErrorCodes.ErrorOpeningFile;
 					return;
 				}
-		
-				// Get the vector layer from the data source
-				void* vectorLayer = null;
-				int numLayers = GDAL.OGR_DS_GetLayerCount(dataSource);
-				if (numLayers != 1)
+				else
+				{
+					DeleteGeometry();
+					geometry = LoadVectorFileGeometryLods(fileName, loadFill, drawBorder, mapProjection, centralLongitude, nLods, LodBaseTolerance);
+					geometryHasFill = loadFill;
+					geometryHasBorder = drawBorder;
+					geometryLods = nLods;
+					geometryFileTime = fileTime;
+				}
+				geometryProjection = mapProjection;
+				geometryCentralLongitude = centralLongitude;
+
+				int status = GetVectorFileStatus(geometry);
+				if (status != VectorFileOK)
 				{
 					Gl.glEndList();
 					DeleteOpenGLDisplayList(TRACKING_CONTEXT);
-					errorCode = ErrorCodes.WrongNumberOfLayers;
+					DeleteGeometry();
+					errorCode = (status == VectorFileLayerError) ? ErrorCodes.WrongNumberOfLayers : ErrorCodes.ErrorOpeningFile;
 					return;
 				}
-				vectorLayer = GDAL.OGR_DS_GetLayer(dataSource, 0);
-				GDAL.OGR_L_ResetReading(vectorLayer);
 
-				// Set the border color and width
-				Gl.glColor3f(glc(borderColor.R), glc(borderColor.G), glc(borderColor.B));
-				Gl.glLineWidth((float)borderWidth);
+				// First the fills, then the borders on top
+				SetVectorFileLod(geometry, 0);
+				if (loadFill)
+					DrawVectorFileFill(geometry, c1, useTwoColors, c2, (int)opacity);
+				if (drawBorder)
+				{
+					int[] b = new int[3];
+					b[0] = borderColor.R; b[1] = borderColor.G; b[2] = borderColor.B;
+					DrawVectorFileBorder(geometry, b, (int)borderWidth);
+					numVertices = GetVectorFileBorderPointCount(geometry);
+				}
+				numFeatures = GetVectorFileFeatureCount(geometry);
+
+				// End the OpenGL display list
+				Gl.glEndList();
+				listEnded = true;
+
+				CreateLodDisplayLists(geometry, loadFill, c1, c2);
 
-				// Extract the features
-				void* feature = null;
-				while ((feature = GDAL.OGR_L_GetNextFeature(vectorLayer)) != null)
+				// A fill from the triangle cache is only in the display lists
+				if (!fillFromCache)
 				{
-					// Count the number of features
-					numFeatures++;
-
-					// Get the geometry object
-					void *geometry = null;
-					geometry = GDAL.OGR_F_GetGeometryRef(feature);
-
-					// Process the geometry object
-					if (geometry != null)
-					{
-						void* shape = null;
-
-						// Determine the type and number of geometries
-						int geometryType = GDAL.OGR_G_GetGeometryType(geometry);
-						if (geometryType < 0)
-							geometryType = (geometryType << 1) >> 1; // ignore 3D geometry types
-						int numGeometries = GDAL.OGR_G_GetGeometryCount(geometry);
-
-						// Draw the shapes
-						if (numGeometries > 0)
-						{
-							// Iterate over the geometries
-							for (int i = 0; i < numGeometries; i++)
-							{
-								// Pull out the shape to process
-								shape = GDAL.OGR_G_GetGeometryRef(geometry, i);
-
-								// If shape is a "multi" type, draw all its parts
-								if (geometryType == (int)GDAL.OGRwkbGeometryType.wkbMultiPolygon ||
-									geometryType == (int)GDAL.OGRwkbGeometryType.wkbMultiLineString ||
-									geometryType == (int)GDAL.OGRwkbGeometryType.wkbMultiPoint)
-								{
-									int numParts = GDAL.OGR_G_GetGeometryCount(shape);
-									for (int j = 0; j < numParts; j++)
-									{
-										void* part = GDAL.OGR_G_GetGeometryRef(shape, j);
-										Render(geometryType, part, isAziumuthalProj);
-									}
-								}
-								else
-								{
-									Render(geometryType, shape, isAziumuthalProj);
-								}
-							}
-						}
-						else
-						{
-							if (geometryType == (int)GDAL.OGRwkbGeometryType.wkbLineString)
-								Render(geometryType, geometry, isAziumuthalProj);
-						}
-					}
-					GDAL.OGR_F_Destroy(feature);
+					cullToView = true;
+					cullFill = loadFill;
+					cullFillRGB = c1;
+					cullFill2RGB = c2;
+					cullBorderRGB = new int[3];
+					cullBorderRGB[0] = borderColor.R; cullBorderRGB[1] = borderColor.G; cullBorderRGB[2] = borderColor.B;
 				}
-				GDAL.OGR_DS_Destroy(dataSource);
 			}
 			catch
 			{
-				Gl.glEndList();
+				if (!listEnded)
+					Gl.glEndList();
 				DeleteOpenGLDisplayList(TRACKING_CONTEXT);
+				DeleteLodDisplayLists();
+				DeleteGeometry();
 				errorCode = ErrorCodes.Exception;
 				return;
 			}
+		}
+
+		private void BeginLoad(bool loadFill, int nLods, DateTime fileTime)
+		{
+			// The geometry fields describe what the job will deliver
+			DeleteGeometry();
+			loadJob = BeginLoadVectorFileGeometry(fileName, loadFill, drawBorder, mapProjection, centralLongitude, nLods, LodBaseTolerance, loadCallback, IntPtr.Zero);
+			geometryHasFill = loadFill;
+			geometryHasBorder = drawBorder;
+			geometryLods = nLods;
+			geometryFileTime = fileTime;
+			geometryProjection = mapProjection;
+			geometryCentralLongitude = centralLongitude;
+		}
+
+		private static void SetLoadingMap(IntPtr job, MapGL map)
+		{
+			lock (loadingMaps)
+			{
+				if (map != null)
+					loadingMaps[job] = map;
+				else
+					loadingMaps.Remove(job);
+			}
+		}
+
+		private static void LoadFinished(IntPtr job, IntPtr userData)
+		{
+			// Called on the loader thread; the map repaints on its own thread
+			MapGL map;
+			lock (loadingMaps)
+			{
+				if (!loadingMaps.TryGetValue(job, out map))
+					return;
+			}
+
+			// The map can be disposed or lose its handle at any moment, and
+			// nothing may be thrown back into the loader thread
+			try
+			{
+				if (map.IsHandleCreated)
+					map.BeginInvoke(new System.Windows.Forms.MethodInvoker(map.Invalidate));
+			}
+			catch (ObjectDisposedException)
+			{
+			}
+			catch (InvalidOperationException)
+			{
+			}
+		}
 
-			// End the OpenGL display list
-			Gl.glEndList();
+		private void CancelLoad()
+		{
+			if (loadJob == IntPtr.Zero)
+				return;
+			SetLoadingMap(loadJob, null);
+			CancelLoadVectorFileGeometry(loadJob);
+			loadJob = IntPtr.Zero;
 		}
 
-		private unsafe void Render(int geometryType, void* shape, bool isAzimuthalProjection)
+		private void DeleteGeometry()
 		{
-			if (shape == null) return;
+			cullToView = false;
+			if (geometry == IntPtr.Zero)
+				return;
+			DeleteVectorFileGeometry(geometry);
+			geometry = IntPtr.Zero;
+		}
 
-			bool bUnknownType = false;
+		private void CreateLodDisplayLists(IntPtr geometry, bool drawFill, int[] c1, int[] c2)
+		{
+			// Level 0 is the full detail list built by LoadFromFile
+			int nLods = GetVectorFileLodCount(geometry);
+			if (nLods < 2)
+				return;
 
-			// Begin the GL shape
-			switch (geometryType)
+			lodDisplayLists = new int[nLods - 1];
+			lodTolerances = new double[nLods - 1];
+			int[] b = new int[3];
+			b[0] = borderColor.R; b[1] = borderColor.G; b[2] = borderColor.B;
+			for (int lod = 1; lod < nLods; lod++)
 			{
-				case (int)GDAL.OGRwkbGeometryType.wkbPoint:
-				case (int)GDAL.OGRwkbGeometryType.wkbMultiPoint:
-					// TODO: this case needs to be tested
-					Gl.glBegin(Gl.GL_POINTS);
-					break;
-				case (int)GDAL.OGRwkbGeometryType.wkbPolygon:
-				case (int)GDAL.OGRwkbGeometryType.wkbMultiPolygon:
-					Gl.glBegin(Gl.GL_LINE_STRIP);
-					break;
-				case (int)GDAL.OGRwkbGeometryType.wkbLineString:
-					Gl.glBegin(Gl.GL_LINE_STRIP);
-					break;
-				default:
-					bUnknownType = true;
-					break;
+				SetVectorFileLod(geometry, lod);
+				lodTolerances[lod - 1] = GetVectorFileLodTolerance(geometry, lod);
+				lodDisplayLists[lod - 1] = Gl.glGenLists(1);
+				Gl.glNewList(lodDisplayLists[lod - 1], Gl.GL_COMPILE);
+				if (drawFill)
+					DrawVectorFileFill(geometry, c1, useTwoColors, c2, (int)opacity);
+				if (drawBorder)
+					DrawVectorFileBorder(geometry, b, (int)borderWidth);
+				Gl.glEndList();
 			}
+		}
+
+		private void DeleteLodDisplayLists()
+		{
+			if (lodDisplayLists == null)
+				return;
+			foreach (int displayList in lodDisplayLists)
+				if (displayList > 0)
+					Gl.glDeleteLists(displayList, 1);
+			lodDisplayLists = null;
+			lodTolerances = null;
+		}
+
+		private int SelectLod(MapGL parentMap)
+		{
+			// Use the coarsest level of detail whose error stays under half a pixel
+			if (lodDisplayLists == null || parentMap.ScaleX <= 0)
+				return 0;
+			double mapUnitsPerPixel = 1.0 / parentMap.ScaleX;
+			for (int i = lodDisplayLists.Length - 1; i >= 0; i--)
+				if (lodTolerances[i] <= mapUnitsPerPixel * 0.5)
+					return i + 1;
+			return 0;
+		}
 
-			// If geometry type is unknown, don't render anything
-			if (bUnknownType) return;
+		private bool DrawInView(MapGL parentMap, int lod)
+		{
+			// A view that takes in the whole file is drawn from the display list.
+			// Otherwise only the features whose bounds meet the view are drawn,
+			// straight from the native geometry, once per world copy in view.
+			if (geometry == IntPtr.Zero)
+				return false;
+			SetVectorFileLod(geometry, lod);
+			if (GetVectorFileBounds(geometry, geometryBounds) == 0)
+				return true;
+
+			double left = parentMap.BoundingBox.Map.left;
+			double right = parentMap.BoundingBox.Map.right;
+			double bottom = parentMap.BoundingBox.Map.bottom;
+			double top = parentMap.BoundingBox.Map.top;
+			bool shift = left < -180 || right > 180;
+			if (!shift && left <= geometryBounds[0] && right >= geometryBounds[1] && bottom <= geometryBounds[2] && top >= geometryBounds[3])
+				return false;
+
+			int firstCopy = 0, lastCopy = 0;
+			if (shift)
+			{
+				firstCopy = (int)Math.Ceiling((left - geometryBounds[1]) / 360);
+				lastCopy = (int)Math.Floor((right - geometryBounds[0]) / 360);
+			}
 
-			// Iterate the points of this shape
-			int nPoints = GDAL.OGR_G_GetPointCount(shape);
-			double x = 0, y = 0, z = 0;
-			for (int iPoints = 0; iPoints < nPoints; iPoints++)
+			Gl.glEnable(Gl.GL_BLEND);
+			Gl.glBlendFunc(Gl.GL_SRC_ALPHA, Gl.GL_ONE_MINUS_SRC_ALPHA);
+			Gl.glShadeModel(Gl.GL_FLAT);
+			for (int copy = firstCopy; copy <= lastCopy; copy++)
 			{
-				// Get the next point
-				GDAL.OGR_G_GetPoint(shape, iPoints, ref x, ref y, ref z);
-				double px, py;
-				if (isAzimuthalProjection && y < Projection.MinAzimuthalLatitude)
-					continue;
-				Projection.ProjectPoint(mapProjection, x, y, centralLongitude, out px, out py);
-				Gl.glVertex2d(px, py);
-				numVertices++;
+				viewRect[0] = left - 360 * copy;
+				viewRect[1] = right - 360 * copy;
+				viewRect[2] = bottom;
+				viewRect[3] = top;
+				Gl.glPushMatrix();
+				Gl.glTranslatef(360f * copy, 0.0f, 0.0f);
+				if (cullFill)
+					DrawVectorFileFillInRect(geometry, viewRect, cullFillRGB, useTwoColors, cullFill2RGB, (int)opacity);
+				if (drawBorder)
+					DrawVectorFileBorderInRect(geometry, viewRect, cullBorderRGB, (int)borderWidth);
+				Gl.glPopMatrix();
 			}
+			return true;
+		}
 
-			// End the GL shape
-			Gl.glEnd();
+		private bool DrawTriangleCache(int[] c1, int[] c2)
+		{
+			// A pre-tessellated triangle cache (see ConvertVectorFileToTriangles) next to
+			// the shapefile is memory mapped and drawn in place.  Caches hold unprojected
+			// coordinates and are ignored if they are older than the shapefile.
+			if (mapProjection != MapProjections.CylindricalEquidistant)
+				return false;
+			string cacheFileName = System.IO.Path.ChangeExtension(fileName, "wtri");
+			if (!System.IO.File.Exists(cacheFileName) ||
+				System.IO.File.GetLastWriteTimeUtc(cacheFileName) < System.IO.File.GetLastWriteTimeUtc(fileName))
+				return false;
+
+			IntPtr cache = OpenTessCache(cacheFileName);
+			if (cache == IntPtr.Zero)
+				return false;
+			DrawTessCache(cache, c1, useTwoColors, c2, (int)opacity);
+			CloseTessCache(cache);
+			return true;
 		}
 	}
 }
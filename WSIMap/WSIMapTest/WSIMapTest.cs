@@ -0,0 +1,93 @@
+using System;
+using System.Collections.Generic;
+using System.Drawing;
+using WSIMap;
+
+namespace WSIMapTest
+{
+	// Checks of WSIMap behavior that don't need a map window.  Returns 1 if
+	// any check fails.
+	class WSIMapTest
+	{
+		private static int failures = 0;
+
+		private static void Check(bool ok, string what)
+		{
+			if (!ok)
+			{
+				Console.WriteLine("FAILED: " + what);
+				failures++;
+			}
+		}
+
+		// The hit index is walked again only when the layer's features change,
+		// not on every mouse move
+		private static void TestHitIndexUpdates()
+		{
+			FeatureCollection features = new FeatureCollection();
+			PointD point = new PointD(-90, 40);
+			List<PointD> square = new List<PointD>();
+			square.Add(new PointD(-100, 30));
+			square.Add(new PointD(-80, 30));
+			square.Add(new PointD(-80, 50));
+			square.Add(new PointD(-100, 50));
+			Polygon polygon = new Polygon(square, Color.White, 1, Color.Red, 50);
+			features.Add(point);
+			features.Add(polygon);
+
+			FeatureHitIndex index = new FeatureHitIndex();
+			index.Query(features, new PointD(-90, 40), 10, false);
+			int updates = index.updateCount;
+
+			// What MapGL.ToMapPoint does to the point it returns
+			PointD mouse = new PointD(-91, 41);
+			double ux, uy;
+			Projection.UnprojectPoint(MapProjections.CylindricalEquidistant, mouse.X, mouse.Y, Projection.DefaultCentralLongitude, out ux, out uy);
+			mouse.X = ux;
+			mouse.Y = uy;
+			index.Query(features, mouse, 10, false);
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates, "mouse conversions don't rebuild the hit index");
+
+			point.X = -85;
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 1, "moving a point feature rebuilds the hit index");
+
+			polygon.Add(new PointD(-105, 40));
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 2, "editing a polygon rebuilds the hit index");
+
+			features.Add(new PointD(-70, 40));
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 3, "adding a feature rebuilds the hit index");
+
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 3, "unchanged features don't rebuild the hit index");
+
+			PointD center = new PointD(-60, 40);
+			features.Add(new Circle(center, 50, Color.White, 1, Color.Red, 50));
+			index.Query(features, mouse, 10, false);
+			center.X = -65;
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 5, "moving a circle's center in place rebuilds the hit index");
+
+			features.Remove(polygon);
+			index.Query(features, mouse, 10, false);
+			polygon.Add(new PointD(-106, 41));
+			index.Query(features, mouse, 10, false);
+			Check(index.updateCount == updates + 6, "editing a feature no longer in the layer doesn't rebuild the hit index");
+		}
+
+		static int Main(string[] args)
+		{
+			TestHitIndexUpdates();
+			if (failures > 0)
+			{
+				Console.WriteLine(failures + " check(s) failed");
+				return 1;
+			}
+			Console.WriteLine("all checks passed");
+			return 0;
+		}
+	}
+}
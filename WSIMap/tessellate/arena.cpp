@@ -0,0 +1,61 @@
+#include "stdafx.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <new>
+
+// Allocations are rounded up to this so doubles and pointers stay aligned
+static const size_t arenaAlignment = 16;
+
+TessArena::TessArena(size_t blockSize) : blockSize(blockSize), current(0), used(0)
+{
+}
+
+TessArena::~TessArena()
+{
+	for (size_t i=0; i<blocks.size(); i++)
+		free(blocks[i].data);
+}
+
+void* TessArena::Allocate(size_t bytes)
+{
+	if (bytes > (size_t)-1 - arenaAlignment) throw std::bad_alloc();
+	bytes = (bytes + arenaAlignment - 1) & ~(arenaAlignment - 1);
+	if (bytes == 0) bytes = arenaAlignment;
+
+	// Move on to the next block that has room, keeping the ones that are
+	// too small for later requests
+	while (current < blocks.size() && used + bytes > blocks[current].size)
+	{
+		current++;
+		used = 0;
+	}
+
+	if (current == blocks.size())
+	{
+		// Oversized requests get a block of their own
+		Block block;
+		block.size = bytes > blockSize ? bytes : blockSize;
+		block.data = (char *)malloc(block.size);
+		if (block.data == NULL) throw std::bad_alloc();
+		try
+		{
+			blocks.push_back(block);
+		}
+		catch (...)
+		{
+			free(block.data);
+			throw;
+		}
+		used = 0;
+	}
+
+	void *p = blocks[current].data + used;
+	used += bytes;
+	return p;
+}
+
+void TessArena::Reset()
+{
+	current = 0;
+	used = 0;
+}
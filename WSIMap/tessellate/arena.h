@@ -0,0 +1,45 @@
+// arena.h : bump allocator for the scratch memory of one tessellation job.
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <new>
+
+// Hands out memory from large blocks by bumping a pointer.  Nothing is freed
+// individually; Reset rewinds to the first block so the blocks are reused by
+// the next ring, and the destructor releases everything at once.  Not thread
+// safe: each job or worker thread owns its own arena.
+class TessArena
+{
+public:
+	explicit TessArena(size_t blockSize = 64 * 1024);
+	~TessArena();
+
+	// Allocate bytes aligned for any scalar type.  Throws std::bad_alloc,
+	// as the standard containers do, rather than returning NULL.
+	void* Allocate(size_t bytes);
+
+	template <class T> T* Allocate(size_t count)
+	{
+		if (count > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+		return static_cast<T*>(Allocate(count * sizeof(T)));
+	}
+
+	void Reset();
+
+private:
+	TessArena(const TessArena&);
+	TessArena& operator=(const TessArena&);
+
+	struct Block
+	{
+		char *data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	size_t blockSize;
+	size_t current;		// block being allocated from
+	size_t used;		// bytes used in the current block
+};
@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Background vector file loading.  Jobs are run one at a time, in the order
+// they were begun, by a loader thread that exists while there are jobs.
+// Each load still spreads its tessellation over the worker threads.
+
+enum LoadJobState { LoadJobQueued, LoadJobRunning, LoadJobDone };
+
+struct VectorFileLoadJob
+{
+	std::string fileName;
+	bool loadFill, loadBorder;
+	MapProjections mapProjection;
+	double centralLongitude;
+	int nLods;
+	double baseTolerance;
+	VectorFileLoadCallback callback;
+	void *userData;
+
+	LoadJobState state;				// guarded by jobLock
+	bool cancelled;
+	VectorFileGeometry *geometry;
+};
+
+static std::mutex jobLock;
+static std::condition_variable jobDone;
+static std::deque<VectorFileLoadJob*> jobQueue;
+static bool loaderRunning = false;
+
+static void RunLoadJobs()
+{
+	std::unique_lock<std::mutex> lock(jobLock);
+	while (!jobQueue.empty())
+	{
+		VectorFileLoadJob *job = jobQueue.front();
+		jobQueue.pop_front();
+		job->state = LoadJobRunning;
+		lock.unlock();
+
+		VectorFileGeometry *geometry = LoadVectorFileGeometryLods((char *)job->fileName.c_str(), job->loadFill, job->loadBorder,
+			job->mapProjection, job->centralLongitude, job->nLods, job->baseTolerance);
+
+		lock.lock();
+		if (job->cancelled)
+		{
+			// Nobody is waiting for it any more
+			lock.unlock();
+			DeleteVectorFileGeometry(geometry);
+			delete job;
+			lock.lock();
+			continue;
+		}
+		job->geometry = geometry;
+		job->state = LoadJobDone;
+		VectorFileLoadCallback callback = job->callback;
+		void *userData = job->userData;
+		jobDone.notify_all();
+
+		// The job may be ended as soon as the lock is released, so the
+		// callback only gets its address
+		lock.unlock();
+		if (callback != NULL)
+			callback(job, userData);
+		lock.lock();
+	}
+	loaderRunning = false;
+}
+
+extern "C" TESSELLATE_API VectorFileLoadJob* BeginLoadVectorFileGeometry(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance, VectorFileLoadCallback callback, void* userData)
+{
+	VectorFileLoadJob *job = new VectorFileLoadJob;
+	job->fileName = vectorFileName;
+	job->loadFill = loadFill;
+	job->loadBorder = loadBorder;
+	job->mapProjection = mapProjection;
+	job->centralLongitude = centralLongitude;
+	job->nLods = nLods;
+	job->baseTolerance = baseTolerance;
+	job->callback = callback;
+	job->userData = userData;
+	job->state = LoadJobQueued;
+	job->cancelled = false;
+	job->geometry = NULL;
+
+	std::lock_guard<std::mutex> lock(jobLock);
+	jobQueue.push_back(job);
+	if (!loaderRunning)
+	{
+		loaderRunning = true;
+		std::thread(RunLoadJobs).detach();
+	}
+	return job;
+}
+
+extern "C" TESSELLATE_API int IsVectorFileLoadDone(VectorFileLoadJob* job)
+{
+	if (job == NULL) return 1;
+	std::lock_guard<std::mutex> lock(jobLock);
+	return job->state == LoadJobDone;
+}
+
+extern "C" TESSELLATE_API VectorFileGeometry* EndLoadVectorFileGeometry(VectorFileLoadJob* job)
+{
+	if (job == NULL) return NULL;
+
+	std::unique_lock<std::mutex> lock(jobLock);
+	while (job->state != LoadJobDone)
+		jobDone.wait(lock);
+	VectorFileGeometry *geometry = job->geometry;
+	lock.unlock();
+
+	delete job;
+	return geometry;
+}
+
+extern "C" TESSELLATE_API void CancelLoadVectorFileGeometry(VectorFileLoadJob* job)
+{
+	if (job == NULL) return;
+
+	std::unique_lock<std::mutex> lock(jobLock);
+	if (job->state == LoadJobRunning)
+	{
+		// The loader thread deletes it when the load finishes
+		job->cancelled = true;
+		return;
+	}
+	if (job->state == LoadJobQueued)
+	{
+		for (std::deque<VectorFileLoadJob*>::iterator it = jobQueue.begin(); it != jobQueue.end(); ++it)
+			if (*it == job)
+			{
+				jobQueue.erase(it);
+				break;
+			}
+	}
+	lock.unlock();
+
+	DeleteVectorFileGeometry(job->geometry);
+	delete job;
+}
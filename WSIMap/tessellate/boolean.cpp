@@ -0,0 +1,388 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "boolean.h"
+#include <math.h>
+#include <algorithm>
+#include <thread>
+
+// Polygon booleans are done by handing every contour of both operands to the
+// GLU tessellator at once, with the operation encoded in the winding rule and
+// GLU_TESS_BOUNDARY_ONLY set, so GLU returns the outline of the result
+// instead of triangles.  Each operand is first traced on its own under the
+// odd rule, which makes its winding number 1 inside and 0 outside; then
+// union is a positive sum, intersection a sum of two, difference a positive
+// sum with the clip operand reversed and exclusive or an odd sum.
+
+// Lists with fewer points than this are not worth unioning on several threads
+static const int minUnionPointsPerThread = 5000;
+
+static double SignedArea(const double *xy, int nPoints)
+{
+	double area = 0;
+	for (int i=0, j=nPoints-1; i<nPoints; j=i++)
+		area += xy[j*2] * xy[i*2+1] - xy[i*2] * xy[j*2+1];
+	return area / 2;
+}
+
+// Collects the GL_LINE_LOOPs GLU emits in boundary only mode as contours
+class BoundaryTracer
+{
+public:
+	BoundaryTracer(GLenum windingRule);
+	~BoundaryTracer();
+
+	void Trace(const double *xy, int nPoints, const int *starts, int nMore, ContourSet &result);
+
+	// Called from the GLU callbacks
+	void Begin();
+	void Vertex(size_t index);
+	void End();
+	size_t Combine(const GLdouble coords[3]);
+
+private:
+	BoundaryTracer(const BoundaryTracer&);
+	BoundaryTracer& operator=(const BoundaryTracer&);
+
+	GLUtesselator *tobj;
+	std::vector<double> points;		// the input points, then the ones GLU adds
+	ContourSet *result;
+	int contourStart;
+};
+
+static void CALLBACK boundaryBeginCallback(GLenum which, void *polygonData)
+{
+	((BoundaryTracer *)polygonData)->Begin();
+}
+
+static void CALLBACK boundaryVertexCallback(void *vertexData, void *polygonData)
+{
+	((BoundaryTracer *)polygonData)->Vertex((size_t)vertexData);
+}
+
+static void CALLBACK boundaryEndCallback(void *polygonData)
+{
+	((BoundaryTracer *)polygonData)->End();
+}
+
+static void CALLBACK boundaryErrorCallback(GLenum errorCode, void *polygonData)
+{
+}
+
+static void CALLBACK boundaryCombineCallback(GLdouble coords[3], void *vertexData[4], GLfloat weight[4], void **dataOut, void *polygonData)
+{
+	*dataOut = (void *)((BoundaryTracer *)polygonData)->Combine(coords);
+}
+
+BoundaryTracer::BoundaryTracer(GLenum windingRule) : result(NULL), contourStart(0)
+{
+	tobj = gluNewTess();
+	gluTessCallback(tobj, GLU_TESS_BEGIN_DATA, (GluTessCallbackType)boundaryBeginCallback);
+	gluTessCallback(tobj, GLU_TESS_VERTEX_DATA, (GluTessCallbackType)boundaryVertexCallback);
+	gluTessCallback(tobj, GLU_TESS_END_DATA, (GluTessCallbackType)boundaryEndCallback);
+	gluTessCallback(tobj, GLU_TESS_ERROR_DATA, (GluTessCallbackType)boundaryErrorCallback);
+	gluTessCallback(tobj, GLU_TESS_COMBINE_DATA, (GluTessCallbackType)boundaryCombineCallback);
+	gluTessProperty(tobj, GLU_TESS_WINDING_RULE, windingRule);
+	gluTessProperty(tobj, GLU_TESS_BOUNDARY_ONLY, GL_TRUE);
+
+	// With the normal pointing up outer contours come out counterclockwise
+	// and holes clockwise
+	gluTessNormal(tobj, 0.0, 0.0, 1.0);
+}
+
+BoundaryTracer::~BoundaryTracer()
+{
+	gluDeleteTess(tobj);
+}
+
+void BoundaryTracer::Trace(const double *xy, int nPoints, const int *starts, int nMore, ContourSet &contours)
+{
+	if (nPoints < 3) return;
+	result = &contours;
+	points.assign(xy, xy + nPoints * 2);
+
+	// The vertex data handed to GLU is the point's index in points
+	std::vector<GLdouble> coords(nPoints * 3);
+	for (int i=0; i<nPoints; i++)
+	{
+		coords[i*3] = xy[i*2];
+		coords[i*3+1] = xy[i*2+1];
+		coords[i*3+2] = 0.0;
+	}
+
+	gluTessBeginPolygon(tobj, this);
+	for (int c=0; c<=nMore; c++)
+	{
+		int start = c == 0 ? 0 : starts[c-1];
+		int end = c < nMore ? starts[c] : nPoints;
+		gluTessBeginContour(tobj);
+		for (int i=start; i<end; i++)
+			gluTessVertex(tobj, &coords[i*3], (void *)(size_t)i);
+		gluTessEndContour(tobj);
+	}
+	gluTessEndPolygon(tobj);
+
+	contours.nFeatures = (int)contours.rings.size();
+	result = NULL;
+}
+
+void BoundaryTracer::Begin()
+{
+	contourStart = (int)(result->xy.size() / 2);
+}
+
+void BoundaryTracer::Vertex(size_t index)
+{
+	result->xy.push_back(points[index*2]);
+	result->xy.push_back(points[index*2+1]);
+}
+
+void BoundaryTracer::End()
+{
+	int nPoints = (int)(result->xy.size() / 2) - contourStart;
+	double area = nPoints >= 3 ? SignedArea(&result->xy[contourStart*2], nPoints) : 0;
+	if (area == 0)
+	{
+		result->xy.resize(contourStart * 2);
+		return;
+	}
+
+	TessRing contour;
+	contour.feature = (int)result->rings.size();
+	contour.ring = area < 0 ? 1 : 0;
+	contour.firstPoint = contourStart;
+	contour.nPoints = nPoints;
+	result->rings.push_back(contour);
+}
+
+size_t BoundaryTracer::Combine(const GLdouble coords[3])
+{
+	size_t index = points.size() / 2;
+	points.push_back(coords[0]);
+	points.push_back(coords[1]);
+	return index;
+}
+
+void TraceBoundary(const double *xy, int nPoints, const int *starts, int nMore, GLenum windingRule, ContourSet &result)
+{
+	BoundaryTracer tracer(windingRule);
+	tracer.Trace(xy, nPoints, starts, nMore, result);
+}
+
+// The contours of a set packed for TraceBoundary, appended to xy and starts,
+// reversed if asked
+static void AppendContours(const ContourSet &contours, bool reverse, std::vector<double> &xy, std::vector<int> &starts)
+{
+	for (size_t c=0; c<contours.rings.size(); c++)
+	{
+		const TessRing &contour = contours.rings[c];
+		if (!xy.empty())
+			starts.push_back((int)(xy.size() / 2));
+		const double *p = &contours.xy[contour.firstPoint * 2];
+		for (int i=0; i<contour.nPoints; i++)
+		{
+			int k = reverse ? contour.nPoints - 1 - i : i;
+			xy.push_back(p[k*2]);
+			xy.push_back(p[k*2+1]);
+		}
+	}
+}
+
+// Union of the listed polygons, each turned counterclockwise first so that
+// the nonzero rule sees every polygon as inside
+static void UnionPolygonRun(const double *xy, const int *offsets, const int *order, int first, int end, ContourSet *result)
+{
+	std::vector<double> packed;
+	std::vector<int> starts;
+	for (int i=first; i<end; i++)
+	{
+		int p = order[i];
+		int nPoints = offsets[p+1] - offsets[p];
+		if (nPoints < 3) continue;
+		const double *ring = &xy[offsets[p]*2];
+		bool reverse = SignedArea(ring, nPoints) < 0;
+		if (!packed.empty())
+			starts.push_back((int)(packed.size() / 2));
+		for (int k=0; k<nPoints; k++)
+		{
+			int j = reverse ? nPoints - 1 - k : k;
+			packed.push_back(ring[j*2]);
+			packed.push_back(ring[j*2+1]);
+		}
+	}
+	if (!packed.empty())
+		TraceBoundary(&packed[0], (int)(packed.size() / 2), starts.empty() ? NULL : &starts[0], (int)starts.size(), GLU_TESS_WINDING_NONZERO, *result);
+}
+
+struct MiddleLess
+{
+	const std::vector<double> *middle;
+	bool operator()(int a, int b) const { return (*middle)[a] < (*middle)[b]; }
+};
+
+void UnionPolygonList(const double *xy, const int *offsets, int nPolygons, ContourSet &result, int nThreads)
+{
+	if (nPolygons < 1) return;
+
+	int nPoints = offsets[nPolygons] - offsets[0];
+	nThreads = WorkerThreadCount(nThreads, nPoints, minUnionPointsPerThread);
+	if (nThreads > nPolygons / 2) nThreads = nPolygons / 2;
+
+	std::vector<int> order(nPolygons);
+	for (int p=0; p<nPolygons; p++)
+		order[p] = p;
+	if (nThreads <= 1)
+	{
+		UnionPolygonRun(xy, offsets, &order[0], 0, nPolygons, &result);
+		return;
+	}
+
+	// Polygons in order of the middle of their extent in x, so each group
+	// covers a strip of the map and loses most of its inner edges
+	std::vector<double> middle(nPolygons);
+	for (int p=0; p<nPolygons; p++)
+	{
+		double minX = HUGE_VAL, maxX = -HUGE_VAL;
+		for (int i=offsets[p]; i<offsets[p+1]; i++)
+		{
+			if (xy[i*2] < minX) minX = xy[i*2];
+			if (xy[i*2] > maxX) maxX = xy[i*2];
+		}
+		middle[p] = (minX + maxX) / 2;
+	}
+	MiddleLess less = { &middle };
+	std::stable_sort(order.begin(), order.end(), less);
+
+	// Runs with roughly the same number of points, unioned in parallel
+	std::vector<int> runStart(nThreads + 1, nPolygons);
+	runStart[0] = 0;
+	int run = 1;
+	int pointsSoFar = 0;
+	for (int i=0; i<nPolygons && run<nThreads; i++)
+	{
+		pointsSoFar += offsets[order[i]+1] - offsets[order[i]];
+		if ((double)pointsSoFar >= (double)nPoints * run / nThreads)
+			runStart[run++] = i + 1;
+	}
+
+	std::vector<ContourSet> partial(nThreads);
+	std::vector<std::thread> workers;
+	for (int t=1; t<nThreads; t++)
+		workers.push_back(std::thread(UnionPolygonRun, xy, offsets, &order[0], runStart[t], runStart[t+1], &partial[t]));
+	UnionPolygonRun(xy, offsets, &order[0], runStart[0], runStart[1], &partial[0]);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	// The group outlines each wind once around their inside, so a positive
+	// sum is their union
+	std::vector<double> packed;
+	std::vector<int> starts;
+	for (int t=0; t<nThreads; t++)
+		AppendContours(partial[t], false, packed, starts);
+	if (!packed.empty())
+		TraceBoundary(&packed[0], (int)(packed.size() / 2), starts.empty() ? NULL : &starts[0], (int)starts.size(), GLU_TESS_WINDING_POSITIVE, result);
+}
+
+void TriangulateContours(const ContourSet &contours, TessResult &result)
+{
+	// Outer contours go first, so that one outer contour and its holes are
+	// in the order earcut takes them
+	std::vector<double> xy;
+	std::vector<int> starts;
+	for (int hole=0; hole<=1; hole++)
+	{
+		for (size_t c=0; c<contours.rings.size(); c++)
+		{
+			const TessRing &contour = contours.rings[c];
+			if ((contour.ring == 1) != (hole == 1)) continue;
+			if (!xy.empty())
+				starts.push_back((int)(xy.size() / 2));
+			const double *p = &contours.xy[contour.firstPoint * 2];
+			xy.insert(xy.end(), p, p + contour.nPoints * 2);
+		}
+	}
+	if (xy.empty()) return;
+
+	TessRecorder recorder(&result, GLU_TESS_WINDING_ODD);
+	recorder.AddPolygon(&xy[0], (int)(xy.size() / 2), starts.empty() ? NULL : &starts[0], (int)starts.size(), 0, 0);
+}
+
+// An operand passed as x,y pairs and contour offsets, traced under the odd
+// rule as gpc reads its polygons
+static void TraceOperand(const double *xy, const int *offsets, int nContours, ContourSet &result)
+{
+	if (nContours < 1) return;
+	int nPoints = offsets[nContours] - offsets[0];
+	std::vector<int> starts;
+	for (int c=1; c<nContours; c++)
+		starts.push_back(offsets[c] - offsets[0]);
+	TraceBoundary(&xy[offsets[0]*2], nPoints, starts.empty() ? NULL : &starts[0], (int)starts.size(), GLU_TESS_WINDING_ODD, result);
+}
+
+extern "C" TESSELLATE_API PolygonResult* ClipPolygons(PolygonOperation operation, double subjectXY[], int subjectOffsets[], int nSubject, double clipXY[], int clipOffsets[], int nClip)
+{
+	ContourSet subject, clip;
+	TraceOperand(subjectXY, subjectOffsets, nSubject, subject);
+	TraceOperand(clipXY, clipOffsets, nClip, clip);
+
+	GLenum windingRule;
+	switch (operation)
+	{
+	case PolygonDifference:		windingRule = GLU_TESS_WINDING_POSITIVE; break;
+	case PolygonIntersection:	windingRule = GLU_TESS_WINDING_ABS_GEQ_TWO; break;
+	case PolygonXor:			windingRule = GLU_TESS_WINDING_ODD; break;
+	default:					windingRule = GLU_TESS_WINDING_POSITIVE; break;
+	}
+
+	std::vector<double> xy;
+	std::vector<int> starts;
+	AppendContours(subject, false, xy, starts);
+	AppendContours(clip, operation == PolygonDifference, xy, starts);
+
+	PolygonResult *result = new PolygonResult;
+	if (!xy.empty())
+		TraceBoundary(&xy[0], (int)(xy.size() / 2), starts.empty() ? NULL : &starts[0], (int)starts.size(), windingRule, result->contours);
+	TriangulateContours(result->contours, result->triangles);
+	return result;
+}
+
+extern "C" TESSELLATE_API PolygonResult* UnionPolygons(double xy[], int offsets[], int nPolygons)
+{
+	PolygonResult *result = new PolygonResult;
+	UnionPolygonList(xy, offsets, nPolygons, result->contours);
+	TriangulateContours(result->contours, result->triangles);
+	return result;
+}
+
+extern "C" TESSELLATE_API void DeletePolygonResult(PolygonResult* result)
+{
+	delete result;
+}
+
+extern "C" TESSELLATE_API int GetPolygonResultContourCount(PolygonResult* result)
+{
+	return result != NULL ? (int)result->contours.rings.size() : 0;
+}
+
+extern "C" TESSELLATE_API const TessRing* GetPolygonResultContours(PolygonResult* result)
+{
+	if (result == NULL || result->contours.rings.empty()) return NULL;
+	return &result->contours.rings[0];
+}
+
+extern "C" TESSELLATE_API int GetPolygonResultPointCount(PolygonResult* result)
+{
+	return result != NULL ? (int)(result->contours.xy.size() / 2) : 0;
+}
+
+extern "C" TESSELLATE_API const double* GetPolygonResultPoints(PolygonResult* result)
+{
+	if (result == NULL || result->contours.xy.empty()) return NULL;
+	return &result->contours.xy[0];
+}
+
+extern "C" TESSELLATE_API TessResult* GetPolygonResultTriangles(PolygonResult* result)
+{
+	return result != NULL ? &result->triangles : NULL;
+}
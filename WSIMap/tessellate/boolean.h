@@ -0,0 +1,33 @@
+// boolean.h : polygon boolean operations on the GLU tessellator.
+// Include after stdafx.h, tessellate.h and glut.h.
+
+#pragma once
+
+#include <vector>
+#include "tessresult.h"
+#include "vectorfile.h"
+
+// Contours of x,y pairs.  Each TessRing's ring is 1 for a hole and 0 for an
+// outer contour; outer contours run counterclockwise and holes clockwise, so
+// every point is inside at most one more outer contour than holes.
+typedef RingSet ContourSet;
+
+struct PolygonResult
+{
+	ContourSet contours;
+	TessResult triangles;	// the contours filled, in one range
+};
+
+// Trace the outline of the area a GLU winding rule finds inside contours
+// (each contour after the first starting at the point listed in starts)
+// into result
+void TraceBoundary(const double *xy, int nPoints, const int *starts, int nMore, GLenum windingRule, ContourSet &result);
+
+// Outline of the union of nPolygons single contour polygons, polygon i being
+// points offsets[i] to offsets[i+1]-1 of xy.  Large lists are unioned in
+// groups on worker threads, then the group outlines are unioned.
+void UnionPolygonList(const double *xy, const int *offsets, int nPolygons, ContourSet &result, int nThreads = 0);
+
+// Fill outlines into a single range of triangles.  One outer contour and its
+// holes are ear clipped; several outer contours go through GLU.
+void TriangulateContours(const ContourSet &contours, TessResult &result);
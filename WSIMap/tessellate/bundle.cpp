@@ -0,0 +1,331 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "tessresult.h"
+#include "vectorfile.h"
+#include "geometrycache.h"
+#include "bundle.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Writes values and counted arrays, remembering whether any write failed
+class BundleWriter
+{
+public:
+	BundleWriter(FILE *f) : ok(true), f(f) {}
+
+	template <class T> void Write(const T &value)
+	{
+		ok = ok && fwrite(&value, sizeof(T), 1, f) == 1;
+	}
+
+	template <class T> void WriteArray(const std::vector<T> &values)
+	{
+		uint32_t count = (uint32_t)values.size();
+		Write(count);
+		ok = ok && (count == 0 || fwrite(&values[0], sizeof(T), count, f) == count);
+	}
+
+	void WriteRingSet(const RingSet &ringSet)
+	{
+		Write((int32_t)ringSet.nFeatures);
+		WriteArray(ringSet.xy);
+		WriteArray(ringSet.rings);
+	}
+
+	void WriteTessResult(const TessResult &result)
+	{
+		WriteArray(result.vertices);
+		WriteArray(result.indices);
+		WriteArray(result.ranges);
+	}
+
+	bool ok;
+
+private:
+	FILE *f;
+};
+
+// Reads values and counted arrays out of a bundle in memory; every read
+// fails once one has run off the end
+class BundleReader
+{
+public:
+	BundleReader(const char *data, size_t size) : ok(true), p(data), end(data + size) {}
+
+	template <class T> void Read(T &value)
+	{
+		ok = ok && (size_t)(end - p) >= sizeof(T);
+		if (!ok) return;
+		memcpy(&value, p, sizeof(T));
+		p += sizeof(T);
+	}
+
+	template <class T> void ReadArray(std::vector<T> &values)
+	{
+		uint32_t count = 0;
+		Read(count);
+		ok = ok && (size_t)(end - p) / sizeof(T) >= count;
+		if (!ok) return;
+		values.resize(count);
+		if (count > 0)
+			memcpy(&values[0], p, count * sizeof(T));
+		p += count * sizeof(T);
+	}
+
+	void ReadRingSet(RingSet &ringSet)
+	{
+		int32_t nFeatures = 0;
+		Read(nFeatures);
+		ringSet.nFeatures = nFeatures;
+		ReadArray(ringSet.xy);
+		ReadArray(ringSet.rings);
+
+		for (size_t r=0; ok && r<ringSet.rings.size(); r++)
+		{
+			const TessRing &ring = ringSet.rings[r];
+			ok = ring.firstPoint >= 0 && ring.nPoints >= 0 &&
+				(size_t)ring.firstPoint + ring.nPoints <= ringSet.xy.size() / 2;
+		}
+	}
+
+	void ReadTessResult(TessResult &result)
+	{
+		ReadArray(result.vertices);
+		ReadArray(result.indices);
+		ReadArray(result.ranges);
+
+		// Reject indices outside the vertex array, as LoadTessCache does
+		size_t nVertices = result.vertices.size() / 2;
+		for (size_t i=0; ok && i<result.indices.size(); i++)
+			ok = result.indices[i] < nVertices;
+		for (size_t r=0; ok && r<result.ranges.size(); r++)
+			ok = (size_t)result.ranges[r].firstIndex + result.ranges[r].indexCount <= result.indices.size();
+	}
+
+	bool ok;
+
+private:
+	const char *p, *end;
+};
+
+static void WriteVectorBundleLayer(BundleWriter &out, const VectorFileSource *source, const std::vector<VectorFileVariant> &variants)
+{
+	for (size_t lod=0; lod<source->lods.size(); lod++)
+	{
+		const VectorFileSourceLod &level = source->lods[lod];
+		out.Write(level.tolerance);
+		out.WriteRingSet(level.fill);
+		out.WriteTessResult(*level.triangles);
+		out.WriteRingSet(level.border);
+	}
+
+	for (size_t v=0; v<variants.size(); v++)
+	{
+		VectorBundleVariant entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.mapProjection = variants[v].mapProjection;
+		entry.centralLongitude = variants[v].centralLongitude;
+		out.Write(entry);
+		for (size_t lod=0; lod<variants[v].lods.size(); lod++)
+		{
+			const VectorFileVariantLod &level = variants[v].lods[lod];
+			out.WriteTessResult(*level.fill);
+			out.WriteRingSet(level.border);
+			out.WriteArray(level.features);
+			out.WriteArray(level.bounds);
+		}
+	}
+}
+
+extern "C" TESSELLATE_API int WriteVectorBundle(char* bundleFileName, char** vectorFileNames, int nFiles, int nLods, double baseTolerance, MapProjections* projections, int nProjections, double centralLongitude)
+{
+	if (nFiles < 0 || (nFiles > 0 && vectorFileNames == NULL)) return 0;
+	if (nProjections < 0 || projections == NULL) nProjections = 0;
+
+	FILE *f = OpenFile(bundleFileName, "wb");
+	if (f == NULL) return 0;
+	BundleWriter out(f);
+
+	VectorBundleHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = VECTORBUNDLE_MAGIC;
+	header.version = VECTORBUNDLE_VERSION;
+	header.layerCount = (uint32_t)nFiles;
+	out.Write(header);
+
+	// One file at a time, so only one is ever held in memory
+	for (int i=0; i<nFiles && out.ok; i++)
+	{
+		VectorBundleLayer layer;
+		memset(&layer, 0, sizeof(layer));
+		std::string baseName;
+		long long fileTime = 0, fileSize = 0;
+		if (!GetVectorFileStamp(vectorFileNames[i], baseName, fileTime, fileSize) || baseName.size() >= sizeof(layer.fileName))
+		{
+			out.ok = false;
+			break;
+		}
+
+		VectorFileSource *source = BuildVectorFileSource(vectorFileNames[i], true, true, nLods, baseTolerance);
+		std::vector<VectorFileVariant> variants(source->status == VectorFileOK ? nProjections : 0);
+		for (size_t v=0; v<variants.size(); v++)
+			ProjectVectorFileVariant(source, projections[v], centralLongitude, variants[v]);
+
+		strcpy(layer.fileName, baseName.c_str());
+		layer.fileTime = fileTime;
+		layer.fileSize = fileSize;
+		layer.status = source->status;
+		layer.nFeatures = source->nFeatures;
+		layer.flags = (source->hasFill ? VECTORBUNDLE_FILL : 0) | (source->hasBorder ? VECTORBUNDLE_BORDER : 0);
+		layer.lodCount = (uint32_t)source->lods.size();
+		layer.variantCount = (uint32_t)variants.size();
+		layer.baseTolerance = source->baseTolerance;
+		out.Write(layer);
+		WriteVectorBundleLayer(out, source, variants);
+
+		source->variants.swap(variants);
+		DeleteVectorFileSource(source);
+	}
+
+	bool ok = out.ok;
+	if (fclose(f) != 0) ok = false;
+	if (!ok) remove(bundleFileName);
+	return ok ? 1 : 0;
+}
+
+// Limits on the counts in a layer header, so a damaged one is caught before
+// anything is allocated for it
+static const uint32_t maxBundleLods = 32;
+static const uint32_t maxBundleVariants = 64;
+
+static VectorFileSource* ReadVectorBundleLayer(BundleReader &in, const VectorBundleLayer &layer)
+{
+	VectorFileSource *source = new VectorFileSource;
+	source->status = layer.status;
+	source->nFeatures = layer.nFeatures;
+	source->hasFill = (layer.flags & VECTORBUNDLE_FILL) != 0;
+	source->hasBorder = (layer.flags & VECTORBUNDLE_BORDER) != 0;
+	source->baseTolerance = layer.baseTolerance;
+	source->refCount = 0;
+	source->cacheTime = 0;
+
+	source->lods.resize(layer.lodCount);
+	for (uint32_t lod=0; lod<layer.lodCount; lod++)
+		source->lods[lod].triangles = new TessResult;
+	for (uint32_t lod=0; lod<layer.lodCount && in.ok; lod++)
+	{
+		VectorFileSourceLod &level = source->lods[lod];
+		in.Read(level.tolerance);
+		in.ReadRingSet(level.fill);
+		in.ReadTessResult(*level.triangles);
+		in.ReadRingSet(level.border);
+	}
+
+	source->variants.resize(layer.variantCount);
+	for (uint32_t v=0; v<layer.variantCount; v++)
+	{
+		source->variants[v].lods.resize(layer.lodCount);
+		for (uint32_t lod=0; lod<layer.lodCount; lod++)
+			source->variants[v].lods[lod].fill = new TessResult;
+	}
+	for (uint32_t v=0; v<layer.variantCount && in.ok; v++)
+	{
+		VectorFileVariant &variant = source->variants[v];
+		VectorBundleVariant entry;
+		in.Read(entry);
+		variant.mapProjection = (MapProjections)entry.mapProjection;
+		variant.centralLongitude = entry.centralLongitude;
+		for (uint32_t lod=0; lod<layer.lodCount && in.ok; lod++)
+		{
+			VectorFileVariantLod &level = variant.lods[lod];
+			in.ReadTessResult(*level.fill);
+			in.ReadRingSet(level.border);
+			in.ReadArray(level.features);
+			in.ReadArray(level.bounds);
+
+			// Feature spans must lie within the ranges and rings they name
+			in.ok = in.ok && level.bounds.size() == level.features.size();
+			for (size_t i=0; in.ok && i<level.features.size(); i++)
+			{
+				const VectorFileFeature &span = level.features[i];
+				in.ok = span.firstRange >= 0 && span.nRanges >= 0 && span.firstRing >= 0 && span.nRings >= 0 &&
+					(size_t)span.firstRange + span.nRanges <= level.fill->ranges.size() &&
+					(size_t)span.firstRing + span.nRings <= level.border.rings.size();
+			}
+		}
+	}
+
+	if (!in.ok)
+	{
+		DeleteVectorFileSource(source);
+		return NULL;
+	}
+	return source;
+}
+
+extern "C" TESSELLATE_API int OpenVectorBundle(char* bundleFileName)
+{
+	FILE *f = OpenFile(bundleFileName, "rb");
+	if (f == NULL) return 0;
+
+	// Read the whole file with one call; it is parsed in memory
+	fseek(f, 0, SEEK_END);
+	long fileSize = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	std::vector<char> data(fileSize > 0 ? fileSize : 1);
+	bool ok = fileSize > 0 && fread(&data[0], 1, fileSize, f) == (size_t)fileSize;
+	fclose(f);
+	if (!ok) return 0;
+
+	BundleReader in(&data[0], (size_t)fileSize);
+	VectorBundleHeader header;
+	in.Read(header);
+	if (!in.ok || header.magic != VECTORBUNDLE_MAGIC || header.version != VECTORBUNDLE_VERSION) return 0;
+
+	// Every layer is checked before any is handed to the cache, so a damaged
+	// bundle adds nothing
+	std::vector<VectorBundleLayer> layers;
+	std::vector<VectorFileSource*> sources;
+	for (uint32_t i=0; i<header.layerCount && in.ok; i++)
+	{
+		VectorBundleLayer layer;
+		in.Read(layer);
+		if (!in.ok) break;
+		layer.fileName[sizeof(layer.fileName)-1] = 0;
+		if (layer.lodCount < 1 || layer.lodCount > maxBundleLods || layer.variantCount > maxBundleVariants)
+			break;
+		VectorFileSource *source = ReadVectorBundleLayer(in, layer);
+		if (source == NULL) break;
+		layers.push_back(layer);
+		sources.push_back(source);
+	}
+	if (!in.ok || sources.size() != header.layerCount)
+	{
+		for (size_t i=0; i<sources.size(); i++)
+			DeleteVectorFileSource(sources[i]);
+		return 0;
+	}
+
+	// Files that could not be read when the bundle was built are read again
+	int nLayers = 0;
+	for (size_t i=0; i<sources.size(); i++)
+	{
+		if (sources[i]->status != VectorFileOK)
+		{
+			DeleteVectorFileSource(sources[i]);
+			continue;
+		}
+		AddBundledVectorFileSource(layers[i].fileName, layers[i].fileTime, layers[i].fileSize, sources[i]);
+		nLayers++;
+	}
+	return nLayers;
+}
+
+extern "C" TESSELLATE_API void CloseVectorBundles(void)
+{
+	RemoveBundledVectorFileSources();
+}
@@ -0,0 +1,65 @@
+// bundle.h : basemap bundle file layout.
+//
+// A bundle holds any number of vector files already read, simplified and
+// triangulated, and optionally projected, so a whole basemap loads with one
+// sequential read.  All values are little-endian.  Every array is written as
+// a uint32 element count followed by the elements:
+//
+//   VectorBundleHeader
+//   for each layer:
+//     VectorBundleLayer
+//     for each of lodCount levels:
+//       double tolerance
+//       RingSet fill, TessResult triangles, RingSet border
+//     for each of variantCount projections:
+//       VectorBundleVariant
+//       for each of lodCount levels:
+//         TessResult fill, RingSet border
+//         VectorFileFeature[], RTreeBox[]    one box per feature
+//
+//   RingSet      int32 nFeatures, double xy[], TessRing rings[]
+//   TessResult   double vertices[], uint32 indices[], TessRange ranges[]
+//
+// Layers are matched to the files they were built from by name (without the
+// directory), write time and size; a file that has changed since is read
+// as usual.
+
+#pragma once
+
+#include <stdint.h>
+
+#define VECTORBUNDLE_MAGIC		0x444e4257	// "WBND"
+#define VECTORBUNDLE_VERSION	1
+
+// Layer flags
+#define VECTORBUNDLE_FILL		0x0001
+#define VECTORBUNDLE_BORDER		0x0002
+
+struct VectorBundleHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t layerCount;
+	uint32_t reserved;
+};
+
+struct VectorBundleLayer
+{
+	char fileName[256];			// lower case, no directory
+	int64_t fileTime;			// write time of the file, in seconds
+	int64_t fileSize;
+	int32_t status;				// VectorFileStatus
+	int32_t nFeatures;
+	uint32_t flags;
+	uint32_t lodCount;
+	uint32_t variantCount;
+	uint32_t reserved;
+	double baseTolerance;
+};
+
+struct VectorBundleVariant
+{
+	int32_t mapProjection;		// MapProjections
+	int32_t reserved;
+	double centralLongitude;
+};
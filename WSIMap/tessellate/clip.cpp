@@ -0,0 +1,67 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "clip.h"
+
+// Keep the part of ring on the inside of one rectangle edge: x >= bound when
+// side is 1 and x <= bound when it is -1, or the same for y when axis is 1
+static void ClipToEdge(const std::vector<double> &ring, int axis, double bound, int side, std::vector<double> &out)
+{
+	out.clear();
+	int nPoints = (int)(ring.size() / 2);
+	for (int i=0, j=nPoints-1; i<nPoints; j=i++)
+	{
+		const double *p = &ring[j*2], *q = &ring[i*2];
+		bool pInside = (p[axis] - bound) * side >= 0;
+		bool qInside = (q[axis] - bound) * side >= 0;
+		if (pInside != qInside)
+		{
+			// Where p-q crosses the edge
+			double t = (bound - p[axis]) / (q[axis] - p[axis]);
+			double crossing[2];
+			crossing[axis] = bound;
+			crossing[1-axis] = p[1-axis] + t * (q[1-axis] - p[1-axis]);
+			out.push_back(crossing[0]);
+			out.push_back(crossing[1]);
+		}
+		if (qInside)
+		{
+			out.push_back(q[0]);
+			out.push_back(q[1]);
+		}
+	}
+}
+
+int ClipRingToRect(const double *ring, int nPoints, const double rect[4], std::vector<double> &xy)
+{
+	if (nPoints < 3) return 0;
+
+	double left = ring[0], right = ring[0], bottom = ring[1], top = ring[1];
+	for (int i=1; i<nPoints; i++)
+	{
+		if (ring[i*2] < left) left = ring[i*2];
+		if (ring[i*2] > right) right = ring[i*2];
+		if (ring[i*2+1] < bottom) bottom = ring[i*2+1];
+		if (ring[i*2+1] > top) top = ring[i*2+1];
+	}
+
+	// Rings wholly outside cost nothing; rings wholly inside are copied
+	if (right < rect[0] || left > rect[1] || top < rect[2] || bottom > rect[3])
+		return 0;
+	if (left >= rect[0] && right <= rect[1] && bottom >= rect[2] && top <= rect[3])
+	{
+		xy.insert(xy.end(), ring, ring + nPoints * 2);
+		return nPoints;
+	}
+
+	// Sutherland-Hodgman, one edge at a time
+	std::vector<double> a(ring, ring + nPoints * 2), b;
+	ClipToEdge(a, 0, rect[0], 1, b);
+	ClipToEdge(b, 0, rect[1], -1, a);
+	ClipToEdge(a, 1, rect[2], 1, b);
+	ClipToEdge(b, 1, rect[3], -1, a);
+
+	int nKept = (int)(a.size() / 2);
+	if (nKept < 3) return 0;
+	xy.insert(xy.end(), a.begin(), a.end());
+	return nKept;
+}
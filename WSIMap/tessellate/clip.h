@@ -0,0 +1,13 @@
+// clip.h : clipping rings to a rectangle ahead of tessellation.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <vector>
+
+// Clip a ring of x,y pairs to rect (left, right, bottom, top) and append what
+// is left to xy.  Where the ring leaves the rectangle and comes back in, the
+// clipped ring follows the rectangle's edge, possibly doubling back on
+// itself; the fill is still exact under either winding rule.  Returns the
+// number of points appended, 0 if the ring is outside the rectangle.
+int ClipRingToRect(const double *ring, int nPoints, const double rect[4], std::vector<double> &xy);
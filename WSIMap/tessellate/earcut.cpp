@@ -0,0 +1,781 @@
+#include "stdafx.h"
+#include "earcut.h"
+#include "arena.h"
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+
+namespace
+{
+	struct Node
+	{
+		unsigned int i;		// vertex index
+		double x, y;
+		Node *prev, *next;	// ring order
+		int z;				// z-order curve value
+		Node *prevZ, *nextZ;	// z-order order
+		bool steiner;		// a one point hole, which is never filtered out
+	};
+
+	// Rings smaller than this are not worth hashing
+	int const minHashedPoints = 80;
+
+	class Earcut
+	{
+	public:
+		Earcut(const double *coords, int dim, std::vector<unsigned int> &triangles, unsigned int indexOffset, TessArena &nodes)
+			: coords(coords), dim(dim), triangles(triangles), indexOffset(indexOffset), nodes(nodes), minX(0), minY(0), invSize(0) {}
+
+		void Run(int nPoints, const int *holeStarts, int nHoles);
+
+	private:
+		const double *coords;
+		int dim;
+		std::vector<unsigned int> &triangles;
+		unsigned int indexOffset;
+		TessArena &nodes;
+		double minX, minY, invSize;
+
+		Node* InsertNode(unsigned int i, double x, double y, Node *last);
+		Node* LinkedList(int start, int end, bool clockwise);
+		Node* FilterPoints(Node *start, Node *end = NULL);
+		Node* EliminateHoles(const int *holeStarts, int nHoles, int nPoints, Node *outerNode);
+		Node* EliminateHole(Node *hole, Node *outerNode);
+		Node* FindHoleBridge(Node *hole, Node *outerNode);
+		void EarcutLinked(Node *ear, int pass);
+		bool IsEar(Node *ear);
+		bool IsEarHashed(Node *ear);
+		Node* CureLocalIntersections(Node *start);
+		void SplitEarcut(Node *start);
+		void IndexCurve(Node *start);
+		Node* SplitPolygon(Node *a, Node *b);
+		void AddTriangle(Node *a, Node *b, Node *c);
+		int ZOrder(double x, double y);
+	};
+
+	double SignedArea(const double *coords, int dim, int start, int end)
+	{
+		double sum = 0;
+		for (int i = start, j = end - 1; i < end; j = i++)
+			sum += (coords[j*dim] - coords[i*dim]) * (coords[i*dim+1] + coords[j*dim+1]);
+		return sum;
+	}
+
+	inline double Area(const Node *p, const Node *q, const Node *r)
+	{
+		return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+	}
+
+	inline bool Equals(const Node *p1, const Node *p2)
+	{
+		return p1->x == p2->x && p1->y == p2->y;
+	}
+
+	inline int Sign(double v)
+	{
+		return v > 0 ? 1 : (v < 0 ? -1 : 0);
+	}
+
+	inline bool PointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+	{
+		return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+			(ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+			(bx - px) * (cy - py) >= (cx - px) * (by - py);
+	}
+
+	inline bool OnSegment(const Node *p, const Node *q, const Node *r)
+	{
+		return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+			q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+	}
+
+	bool Intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2)
+	{
+		int o1 = Sign(Area(p1, q1, p2));
+		int o2 = Sign(Area(p1, q1, q2));
+		int o3 = Sign(Area(p2, q2, p1));
+		int o4 = Sign(Area(p2, q2, q1));
+
+		if (o1 != o2 && o3 != o4) return true;
+		if (o1 == 0 && OnSegment(p1, p2, q1)) return true;
+		if (o2 == 0 && OnSegment(p1, q2, q1)) return true;
+		if (o3 == 0 && OnSegment(p2, p1, q2)) return true;
+		if (o4 == 0 && OnSegment(p2, q1, q2)) return true;
+		return false;
+	}
+
+	// Which way r turns from the line p to q
+	inline int Turn(const double *p, const double *q, const double *r)
+	{
+		return Sign((q[0] - p[0]) * (r[1] - p[1]) - (q[1] - p[1]) * (r[0] - p[0]));
+	}
+
+	inline bool WithinBox(const double *p, const double *q, const double *r)
+	{
+		return r[0] <= std::max(p[0], q[0]) && r[0] >= std::min(p[0], q[0]) &&
+			r[1] <= std::max(p[1], q[1]) && r[1] >= std::min(p[1], q[1]);
+	}
+
+	// Whether segments p1-q1 and p2-q2 cross or touch
+	bool SegmentsMeet(const double *p1, const double *q1, const double *p2, const double *q2)
+	{
+		int o1 = Turn(p1, q1, p2), o2 = Turn(p1, q1, q2);
+		int o3 = Turn(p2, q2, p1), o4 = Turn(p2, q2, q1);
+		if (o1 != o2 && o3 != o4) return true;
+		return (o1 == 0 && WithinBox(p1, q1, p2)) || (o2 == 0 && WithinBox(p1, q1, q2)) ||
+			(o3 == 0 && WithinBox(p2, q2, p1)) || (o4 == 0 && WithinBox(p2, q2, q1));
+	}
+
+	struct SweepEdge
+	{
+		double minX, maxX;
+		int a, b;		// its ends, as positions in the contours with repeats dropped
+	};
+
+	bool LeftEndBefore(const SweepEdge &e, const SweepEdge &f)
+	{
+		return e.minX < f.minX;
+	}
+
+	// Whether the outer ring and holes cross or touch themselves or each other.
+	// Repeated points are dropped; neighbouring edges of a contour may then
+	// only meet at their shared vertex, and any others must not meet at all.
+	// The edges are swept in order of their left ends, each tested against
+	// those whose x extent it overlaps.
+	bool SelfIntersects(const double *coords, int nPoints, int dim, const int *holeStarts, int nHoles)
+	{
+		std::vector<const double *> ring;
+		std::vector<int> next;	// the position of each point's successor in its contour
+		ring.reserve(nPoints);
+		next.reserve(nPoints);
+		for (int h=0; h<=nHoles; h++)
+		{
+			int start = h == 0 ? 0 : holeStarts[h-1];
+			int end = h < nHoles ? holeStarts[h] : nPoints;
+			size_t first = ring.size();
+			for (int i=start; i<end; i++)
+			{
+				const double *p = coords + i * dim;
+				if (ring.size() == first || p[0] != ring.back()[0] || p[1] != ring.back()[1])
+					ring.push_back(p);
+			}
+			while (ring.size() > first + 1 && ring.back()[0] == ring[first][0] && ring.back()[1] == ring[first][1])
+				ring.pop_back();
+			if (ring.size() < first + 3) return true;
+			for (size_t i=first; i<ring.size(); i++)
+				next.push_back(i + 1 < ring.size() ? (int)i + 1 : (int)first);
+		}
+		int n = (int)ring.size();
+
+		std::vector<SweepEdge> edges(n);
+		for (int e=0; e<n; e++)
+		{
+			edges[e].a = e;
+			edges[e].b = next[e];
+			edges[e].minX = std::min(ring[e][0], ring[edges[e].b][0]);
+			edges[e].maxX = std::max(ring[e][0], ring[edges[e].b][0]);
+		}
+		std::sort(edges.begin(), edges.end(), LeftEndBefore);
+
+		std::vector<int> active;
+		for (int k=0; k<n; k++)
+		{
+			const SweepEdge &edge = edges[k];
+			const double *p = ring[edge.a], *q = ring[edge.b];
+			size_t kept = 0;
+			for (size_t j=0; j<active.size(); j++)
+			{
+				const SweepEdge &other = edges[active[j]];
+				if (other.maxX < edge.minX) continue;	// left behind by the sweep
+				active[kept++] = active[j];
+
+				const double *r = ring[other.a], *s = ring[other.b];
+				if (std::max(p[1], q[1]) < std::min(r[1], s[1]) || std::min(p[1], q[1]) > std::max(r[1], s[1]))
+					continue;
+				if (edge.b == other.a || other.b == edge.a)
+				{
+					// Neighbours fold back on each other if they run the same way
+					// from their shared vertex
+					const double *shared = edge.b == other.a ? q : p;
+					const double *u = shared == q ? p : q, *v = shared == q ? s : r;
+					if (Turn(shared, u, v) == 0 && (u[0] - shared[0]) * (v[0] - shared[0]) + (u[1] - shared[1]) * (v[1] - shared[1]) > 0)
+						return true;
+				}
+				else if (SegmentsMeet(p, q, r, s))
+					return true;
+			}
+			active.resize(kept);
+			active.push_back(k);
+		}
+		return false;
+	}
+
+	// Whether x,y is inside the contour of the points start..end-1, by the
+	// odd rule
+	bool InsideContour(const double *coords, int dim, int start, int end, double x, double y)
+	{
+		bool inside = false;
+		for (int i = start, j = end - 1; i < end; j = i++)
+		{
+			const double *p = coords + i * dim, *q = coords + j * dim;
+			if ((p[1] > y) != (q[1] > y) && x < (q[0] - p[0]) * (y - p[1]) / (q[1] - p[1]) + p[0])
+				inside = !inside;
+		}
+		return inside;
+	}
+
+	// Whether the contours are an outer ring and holes earcut can bridge:
+	// none meets another, so a hole is inside a contour if its first point
+	// is, and every hole is inside the outer ring and no other hole, which
+	// is what the odd rule would fill
+	bool HolesInsideOuter(const double *coords, int nPoints, int dim, const int *holeStarts, int nHoles)
+	{
+		for (int h=0; h<nHoles; h++)
+		{
+			const double *p = coords + holeStarts[h] * dim;
+			if (!InsideContour(coords, dim, 0, holeStarts[0], p[0], p[1]))
+				return false;
+			for (int k=0; k<nHoles; k++)
+			{
+				int end = k < nHoles - 1 ? holeStarts[k+1] : nPoints;
+				if (k != h && InsideContour(coords, dim, holeStarts[k], end, p[0], p[1]))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool IntersectsPolygon(const Node *a, const Node *b)
+	{
+		const Node *p = a;
+		do
+		{
+			if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && Intersects(p, p->next, a, b))
+				return true;
+			p = p->next;
+		} while (p != a);
+		return false;
+	}
+
+	bool LocallyInside(const Node *a, const Node *b)
+	{
+		return Area(a->prev, a, a->next) < 0 ?
+			Area(a, b, a->next) >= 0 && Area(a, a->prev, b) >= 0 :
+			Area(a, b, a->prev) < 0 || Area(a, a->next, b) < 0;
+	}
+
+	bool MiddleInside(const Node *a, const Node *b)
+	{
+		const Node *p = a;
+		bool inside = false;
+		double px = (a->x + b->x) / 2;
+		double py = (a->y + b->y) / 2;
+		do
+		{
+			if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+				(px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+				inside = !inside;
+			p = p->next;
+		} while (p != a);
+		return inside;
+	}
+
+	bool IsValidDiagonal(const Node *a, const Node *b)
+	{
+		return a->next->i != b->i && a->prev->i != b->i && !IntersectsPolygon(a, b) &&
+			((LocallyInside(a, b) && LocallyInside(b, a) && MiddleInside(a, b) &&
+			  (Area(a->prev, a, b->prev) != 0 || Area(a, b->prev, b) != 0)) ||
+			 (Equals(a, b) && Area(a->prev, a, a->next) > 0 && Area(b->prev, b, b->next) > 0));
+	}
+
+	bool SectorContainsSector(const Node *m, const Node *p)
+	{
+		return Area(m->prev, m, p->prev) < 0 && Area(p->next, m, m->next) < 0;
+	}
+
+	Node* GetLeftmost(Node *start)
+	{
+		Node *p = start, *leftmost = start;
+		do
+		{
+			if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+				leftmost = p;
+			p = p->next;
+		} while (p != start);
+		return leftmost;
+	}
+
+	bool CompareX(const Node *a, const Node *b)
+	{
+		return a->x < b->x;
+	}
+
+	void RemoveNode(Node *p)
+	{
+		p->next->prev = p->prev;
+		p->prev->next = p->next;
+		if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+		if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+	}
+
+	// Simon Tatham's linked list merge sort on the z-order links
+	Node* SortLinked(Node *list)
+	{
+		int inSize = 1;
+		int numMerges;
+		do
+		{
+			Node *p = list, *tail = NULL;
+			list = NULL;
+			numMerges = 0;
+			while (p)
+			{
+				numMerges++;
+				Node *q = p;
+				int pSize = 0;
+				for (int i=0; i<inSize; i++)
+				{
+					pSize++;
+					q = q->nextZ;
+					if (!q) break;
+				}
+				int qSize = inSize;
+				while (pSize > 0 || (qSize > 0 && q))
+				{
+					Node *e;
+					if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z))
+					{
+						e = p;
+						p = p->nextZ;
+						pSize--;
+					}
+					else
+					{
+						e = q;
+						q = q->nextZ;
+						qSize--;
+					}
+					if (tail) tail->nextZ = e;
+					else list = e;
+					e->prevZ = tail;
+					tail = e;
+				}
+				p = q;
+			}
+			tail->nextZ = NULL;
+			inSize *= 2;
+		} while (numMerges > 1);
+		return list;
+	}
+
+	Node* Earcut::InsertNode(unsigned int i, double x, double y, Node *last)
+	{
+		Node n = { i, x, y, NULL, NULL, 0, NULL, NULL, false };
+		Node *p = nodes.Allocate<Node>(1);
+		*p = n;
+		if (!last)
+		{
+			p->prev = p;
+			p->next = p;
+		}
+		else
+		{
+			p->next = last->next;
+			p->prev = last;
+			last->next->prev = p;
+			last->next = p;
+		}
+		return p;
+	}
+
+	Node* Earcut::LinkedList(int start, int end, bool clockwise)
+	{
+		Node *last = NULL;
+		if (clockwise == (SignedArea(coords, dim, start, end) > 0))
+		{
+			for (int i = start; i < end; i++)
+				last = InsertNode(i, coords[i*dim], coords[i*dim+1], last);
+		}
+		else
+		{
+			for (int i = end - 1; i >= start; i--)
+				last = InsertNode(i, coords[i*dim], coords[i*dim+1], last);
+		}
+
+		// Drop the closing point if the ring repeats its first point
+		if (last && Equals(last, last->next))
+		{
+			RemoveNode(last);
+			last = last->next;
+		}
+		return last;
+	}
+
+	Node* Earcut::FilterPoints(Node *start, Node *end)
+	{
+		if (!start) return start;
+		if (!end) end = start;
+
+		Node *p = start;
+		bool again;
+		do
+		{
+			again = false;
+			if (!p->steiner && (Equals(p, p->next) || Area(p->prev, p, p->next) == 0))
+			{
+				RemoveNode(p);
+				p = end = p->prev;
+				if (p == p->next) break;
+				again = true;
+			}
+			else
+				p = p->next;
+		} while (again || p != end);
+		return end;
+	}
+
+	Node* Earcut::EliminateHoles(const int *holeStarts, int nHoles, int nPoints, Node *outerNode)
+	{
+		std::vector<Node*> queue;
+		for (int i=0; i<nHoles; i++)
+		{
+			int start = holeStarts[i];
+			int end = i < nHoles - 1 ? holeStarts[i+1] : nPoints;
+			Node *list = LinkedList(start, end, false);
+			if (!list) continue;
+			if (list == list->next) list->steiner = true;
+			queue.push_back(GetLeftmost(list));
+		}
+		std::sort(queue.begin(), queue.end(), CompareX);
+
+		// Bridge holes to the outer ring from left to right
+		for (size_t i=0; i<queue.size(); i++)
+			outerNode = EliminateHole(queue[i], outerNode);
+		return outerNode;
+	}
+
+	Node* Earcut::EliminateHole(Node *hole, Node *outerNode)
+	{
+		Node *bridge = FindHoleBridge(hole, outerNode);
+		if (!bridge) return outerNode;
+
+		Node *bridgeReverse = SplitPolygon(bridge, hole);
+		FilterPoints(bridgeReverse, bridgeReverse->next);
+		return FilterPoints(bridge, bridge->next);
+	}
+
+	Node* Earcut::FindHoleBridge(Node *hole, Node *outerNode)
+	{
+		Node *p = outerNode, *m = NULL;
+		double hx = hole->x, hy = hole->y;
+		double qx = -HUGE_VAL;
+
+		// Find a segment intersected by a ray from the hole's leftmost point to the left;
+		// the segment's endpoint with lesser x is a potential connection point
+		do
+		{
+			if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+			{
+				double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+				if (x <= hx && x > qx)
+				{
+					qx = x;
+					m = p->x < p->next->x ? p : p->next;
+					if (x == hx) return m; // hole touches outer segment; pick leftmost endpoint
+				}
+			}
+			p = p->next;
+		} while (p != outerNode);
+
+		if (!m) return NULL;
+
+		// Look for points inside the triangle of hole point, segment intersection and
+		// endpoint; if there are none, m is the connection point, otherwise use the
+		// point with the minimum angle to the ray
+		Node *stop = m;
+		double mx = m->x, my = m->y;
+		double tanMin = HUGE_VAL;
+		p = m;
+		do
+		{
+			if (hx >= p->x && p->x >= mx && hx != p->x &&
+				PointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+			{
+				double tan = fabs(hy - p->y) / (hx - p->x);
+				if (LocallyInside(p, hole) &&
+					(tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && SectorContainsSector(m, p))))))
+				{
+					m = p;
+					tanMin = tan;
+				}
+			}
+			p = p->next;
+		} while (p != stop);
+
+		return m;
+	}
+
+	void Earcut::AddTriangle(Node *a, Node *b, Node *c)
+	{
+		// The outer ring is linked counter-clockwise (y up), so ears come out
+		// counter-clockwise like GLU's triangles
+		triangles.push_back(a->i + indexOffset);
+		triangles.push_back(b->i + indexOffset);
+		triangles.push_back(c->i + indexOffset);
+	}
+
+	void Earcut::EarcutLinked(Node *ear, int pass)
+	{
+		if (!ear) return;
+
+		// Interlink polygon nodes in z-order on the first pass
+		if (!pass && invSize) IndexCurve(ear);
+
+		Node *stop = ear;
+		while (ear->prev != ear->next)
+		{
+			Node *prev = ear->prev;
+			Node *next = ear->next;
+
+			if (invSize ? IsEarHashed(ear) : IsEar(ear))
+			{
+				AddTriangle(prev, ear, next);
+				RemoveNode(ear);
+
+				// Skipping the next vertex leads to fewer sliver triangles
+				ear = next->next;
+				stop = next->next;
+				continue;
+			}
+
+			ear = next;
+
+			// If we looped through the whole remaining polygon and can't find any more ears
+			if (ear == stop)
+			{
+				if (!pass)
+					EarcutLinked(FilterPoints(ear), 1);	// try filtering points and slicing again
+				else if (pass == 1)
+				{
+					ear = CureLocalIntersections(FilterPoints(ear));
+					EarcutLinked(ear, 2);
+				}
+				else if (pass == 2)
+					SplitEarcut(ear);	// as a last resort, try splitting the remaining polygon
+				break;
+			}
+		}
+	}
+
+	bool Earcut::IsEar(Node *ear)
+	{
+		const Node *a = ear->prev, *b = ear, *c = ear->next;
+		if (Area(a, b, c) >= 0) return false; // reflex, can't be an ear
+
+		double x0 = std::min(a->x, std::min(b->x, c->x)), x1 = std::max(a->x, std::max(b->x, c->x));
+		double y0 = std::min(a->y, std::min(b->y, c->y)), y1 = std::max(a->y, std::max(b->y, c->y));
+
+		// No other point may lie inside the ear
+		const Node *p = c->next;
+		while (p != a)
+		{
+			if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && Area(p->prev, p, p->next) >= 0)
+				return false;
+			p = p->next;
+		}
+		return true;
+	}
+
+	bool Earcut::IsEarHashed(Node *ear)
+	{
+		const Node *a = ear->prev, *b = ear, *c = ear->next;
+		if (Area(a, b, c) >= 0) return false;
+
+		double x0 = std::min(a->x, std::min(b->x, c->x)), x1 = std::max(a->x, std::max(b->x, c->x));
+		double y0 = std::min(a->y, std::min(b->y, c->y)), y1 = std::max(a->y, std::max(b->y, c->y));
+
+		// Only points whose z-order value falls in the triangle's bbox range can be inside
+		int minZ = ZOrder(x0, y0);
+		int maxZ = ZOrder(x1, y1);
+
+		const Node *p = ear->prevZ, *n = ear->nextZ;
+
+		// Look for points inside the triangle in both directions
+		while (p && p->z >= minZ && n && n->z <= maxZ)
+		{
+			if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && Area(p->prev, p, p->next) >= 0)
+				return false;
+			p = p->prevZ;
+
+			if (n->x >= x0 && n->x <= x1 && n->y >= y0 && n->y <= y1 && n != a && n != c &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, n->x, n->y) && Area(n->prev, n, n->next) >= 0)
+				return false;
+			n = n->nextZ;
+		}
+
+		// Look for remaining points in decreasing z-order
+		while (p && p->z >= minZ)
+		{
+			if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && Area(p->prev, p, p->next) >= 0)
+				return false;
+			p = p->prevZ;
+		}
+
+		// Look for remaining points in increasing z-order
+		while (n && n->z <= maxZ)
+		{
+			if (n->x >= x0 && n->x <= x1 && n->y >= y0 && n->y <= y1 && n != a && n != c &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, n->x, n->y) && Area(n->prev, n, n->next) >= 0)
+				return false;
+			n = n->nextZ;
+		}
+		return true;
+	}
+
+	Node* Earcut::CureLocalIntersections(Node *start)
+	{
+		Node *p = start;
+		do
+		{
+			Node *a = p->prev, *b = p->next->next;
+			if (!Equals(a, b) && Intersects(a, p, p->next, b) && LocallyInside(a, b) && LocallyInside(b, a))
+			{
+				AddTriangle(a, p, b);
+				RemoveNode(p);
+				RemoveNode(p->next);
+				p = start = b;
+			}
+			p = p->next;
+		} while (p != start);
+		return FilterPoints(p);
+	}
+
+	void Earcut::SplitEarcut(Node *start)
+	{
+		// Look for a valid diagonal that divides the polygon into two
+		Node *a = start;
+		do
+		{
+			Node *b = a->next->next;
+			while (b != a->prev)
+			{
+				if (a->i != b->i && IsValidDiagonal(a, b))
+				{
+					Node *c = SplitPolygon(a, b);
+					a = FilterPoints(a, a->next);
+					c = FilterPoints(c, c->next);
+					EarcutLinked(a, 0);
+					EarcutLinked(c, 0);
+					return;
+				}
+				b = b->next;
+			}
+			a = a->next;
+		} while (a != start);
+	}
+
+	void Earcut::IndexCurve(Node *start)
+	{
+		Node *p = start;
+		do
+		{
+			if (p->z == 0) p->z = ZOrder(p->x, p->y);
+			p->prevZ = p->prev;
+			p->nextZ = p->next;
+			p = p->next;
+		} while (p != start);
+
+		p->prevZ->nextZ = NULL;
+		p->prevZ = NULL;
+		SortLinked(p);
+	}
+
+	Node* Earcut::SplitPolygon(Node *a, Node *b)
+	{
+		// Link a to b with a bridge; if a and b are in the same ring this splits it in two,
+		// if they are in different rings it merges them
+		Node *a2 = InsertNode(a->i, a->x, a->y, NULL);
+		Node *b2 = InsertNode(b->i, b->x, b->y, NULL);
+		Node *an = a->next;
+		Node *bp = b->prev;
+
+		a->next = b;
+		b->prev = a;
+
+		a2->next = an;
+		an->prev = a2;
+
+		b2->next = a2;
+		a2->prev = b2;
+
+		bp->next = b2;
+		b2->prev = bp;
+
+		return b2;
+	}
+
+	int Earcut::ZOrder(double px, double py)
+	{
+		// Coordinates are scaled to a 15 bit range and their bits interleaved
+		unsigned int x = (unsigned int)((px - minX) * invSize);
+		unsigned int y = (unsigned int)((py - minY) * invSize);
+
+		x = (x | (x << 8)) & 0x00FF00FF;
+		x = (x | (x << 4)) & 0x0F0F0F0F;
+		x = (x | (x << 2)) & 0x33333333;
+		x = (x | (x << 1)) & 0x55555555;
+
+		y = (y | (y << 8)) & 0x00FF00FF;
+		y = (y | (y << 4)) & 0x0F0F0F0F;
+		y = (y | (y << 2)) & 0x33333333;
+		y = (y | (y << 1)) & 0x55555555;
+
+		return (int)(x | (y << 1));
+	}
+
+	void Earcut::Run(int nPoints, const int *holeStarts, int nHoles)
+	{
+		int outerLen = nHoles > 0 ? holeStarts[0] : nPoints;
+		Node *outerNode = LinkedList(0, outerLen, true);
+		if (!outerNode || outerNode->next == outerNode->prev) return;
+
+		if (nHoles > 0) outerNode = EliminateHoles(holeStarts, nHoles, nPoints, outerNode);
+
+		// If the shape is not too simple, use the z-order curve hash; calculate the bbox
+		if (nPoints > minHashedPoints)
+		{
+			double maxX, maxY;
+			minX = maxX = coords[0];
+			minY = maxY = coords[1];
+			for (int i=1; i<nPoints; i++)
+			{
+				double x = coords[i*dim], y = coords[i*dim+1];
+				if (x < minX) minX = x;
+				if (y < minY) minY = y;
+				if (x > maxX) maxX = x;
+				if (y > maxY) maxY = y;
+			}
+			invSize = std::max(maxX - minX, maxY - minY);
+			invSize = invSize != 0 ? 32767 / invSize : 0;
+		}
+
+		EarcutLinked(outerNode, 0);
+	}
+}
+
+bool EarcutTriangulate(const double *coords, int nPoints, int dim, const int *holeStarts, int nHoles,
+	std::vector<unsigned int> &triangles, unsigned int indexOffset, TessArena *arena)
+{
+	if (nPoints < 3 || SelfIntersects(coords, nPoints, dim, holeStarts, nHoles) ||
+		!HolesInsideOuter(coords, nPoints, dim, holeStarts, nHoles))
+		return false;
+
+	size_t firstTriangle = triangles.size();
+	TessArena localArena;
+	Earcut earcut(coords, dim, triangles, indexOffset, arena != NULL ? *arena : localArena);
+	earcut.Run(nPoints, holeStarts, nHoles);
+	return triangles.size() > firstTriangle;
+}
@@ -0,0 +1,25 @@
+// earcut.h : ear clipping triangulator used ahead of the GLU tessellator.
+//
+// Based on the ear clipping approach with z-order curve hashing described by
+// Held ("FIST") and implemented by Mapbox's earcut.  It handles simple rings
+// and rings with holes, which are bridged into the outer ring.  Contours that
+// cross or touch themselves or each other are found by a sweep over their
+// edges before any triangles are made, and the caller falls back to gluTess*.
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+class TessArena;
+
+// Triangulate a ring of nPoints vertices stored dim doubles apart (x first,
+// then y).  holeStarts lists the vertex index of the first vertex of each of
+// nHoles holes that follow the outer ring in the same array.  Counter-
+// clockwise triangles are appended to triangles as vertex indices plus
+// indexOffset.  Returns false, leaving triangles unchanged, if the contours
+// are not simple and apart, or a hole is not inside the outer ring alone.
+// The ring's nodes come from arena when one is given; the caller decides
+// when to reset it.
+bool EarcutTriangulate(const double *coords, int nPoints, int dim, const int *holeStarts, int nHoles,
+	std::vector<unsigned int> &triangles, unsigned int indexOffset = 0, TessArena *arena = NULL);
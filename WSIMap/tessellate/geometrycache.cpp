@@ -0,0 +1,181 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "vectorfile.h"
+#include "geometrycache.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+typedef std::pair<std::string, long long> SourceKey;
+
+// Sources by full path and write time.  Sources replaced by a fuller one for
+// the same file drop out of the map but live on until released.
+static std::mutex cacheLock;
+static std::map<SourceKey, VectorFileSource*> cachedSources;
+
+// Sources read from bundles, which hold a reference to each until
+// RemoveBundledVectorFileSources
+struct BundledSource
+{
+	std::string name;
+	long long time, size;
+	VectorFileSource *source;
+};
+
+static std::vector<BundledSource> bundledSources;
+
+// The full path of fileName, in lower case on Windows, the time it was last
+// written and its size.  False if the file can't be found.
+static bool GetSourceKey(const char *fileName, SourceKey &key, long long &size)
+{
+#ifdef _WIN32
+	char fullPath[_MAX_PATH];
+	if (_fullpath(fullPath, fileName, _MAX_PATH) == NULL) return false;
+	CharLowerA(fullPath);
+	struct _stat64 st;
+	if (_stat64(fullPath, &st) != 0) return false;
+	key.first = fullPath;
+#else
+	char *fullPath = realpath(fileName, NULL);
+	if (fullPath == NULL) return false;
+	struct stat st;
+	bool found = stat(fullPath, &st) == 0;
+	key.first = fullPath;
+	free(fullPath);
+	if (!found) return false;
+#endif
+	key.second = (long long)st.st_mtime;
+	size = (long long)st.st_size;
+	return true;
+}
+
+// The file name without its directory, in lower case
+static std::string BaseName(const std::string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+	for (size_t i=0; i<name.size(); i++)
+		if (name[i] >= 'A' && name[i] <= 'Z') name[i] = (char)(name[i] - 'A' + 'a');
+	return name;
+}
+
+bool GetVectorFileStamp(const char *fileName, std::string &baseName, long long &time, long long &size)
+{
+	SourceKey key;
+	if (!GetSourceKey(fileName, key, size)) return false;
+	baseName = BaseName(key.first);
+	time = key.second;
+	return true;
+}
+
+static bool Covers(const VectorFileSource *source, bool loadFill, bool loadBorder, int nLods, double baseTolerance)
+{
+	return (!loadFill || source->hasFill) && (!loadBorder || source->hasBorder) &&
+		(nLods == 1 || ((int)source->lods.size() >= nLods && source->baseTolerance == baseTolerance));
+}
+
+VectorFileSource* AcquireVectorFileSource(const char *fileName, bool loadFill, bool loadBorder, int nLods, double baseTolerance)
+{
+	if (nLods < 1 || baseTolerance <= 0) nLods = 1;
+
+	SourceKey key;
+	long long size = 0;
+	bool shareable = GetSourceKey(fileName, key, size);
+	if (shareable)
+	{
+		std::lock_guard<std::mutex> lock(cacheLock);
+		std::map<SourceKey, VectorFileSource*>::iterator found = cachedSources.find(key);
+		if (found == cachedSources.end() || !Covers(found->second, loadFill, loadBorder, nLods, baseTolerance))
+		{
+			// A bundle built from this very file will do as well
+			std::string name = BaseName(key.first);
+			for (size_t b=0; b<bundledSources.size(); b++)
+			{
+				const BundledSource &bundled = bundledSources[b];
+				if (bundled.name == name && bundled.time == key.second && bundled.size == size &&
+					Covers(bundled.source, loadFill, loadBorder, nLods, baseTolerance))
+				{
+					bundled.source->refCount++;
+					return bundled.source;
+				}
+			}
+		}
+		if (found != cachedSources.end())
+		{
+			VectorFileSource *cached = found->second;
+			if (Covers(cached, loadFill, loadBorder, nLods, baseTolerance))
+			{
+				cached->refCount++;
+				return cached;
+			}
+
+			// The replacement serves the cached source's users too
+			loadFill = loadFill || cached->hasFill;
+			loadBorder = loadBorder || cached->hasBorder;
+			if (cached->baseTolerance == baseTolerance)
+				nLods = std::max(nLods, (int)cached->lods.size());
+		}
+	}
+
+	// Built outside the lock so other files load meanwhile.  Files that could
+	// not be read are not cached.  Borders come out of the same pass as fills
+	// and cost little beside them, so they are always kept for a later
+	// border-only load of the file (basemapc after basemapl) to share.
+	if (shareable)
+		loadBorder = true;
+	VectorFileSource *source = BuildVectorFileSource(fileName, loadFill, loadBorder, nLods, baseTolerance);
+	source->refCount = 1;
+	if (shareable && source->status == VectorFileOK)
+	{
+		std::lock_guard<std::mutex> lock(cacheLock);
+		source->cacheKey = key.first;
+		source->cacheTime = key.second;
+		cachedSources[key] = source;
+	}
+	return source;
+}
+
+void ReleaseVectorFileSource(VectorFileSource *source)
+{
+	if (source == NULL) return;
+
+	{
+		std::lock_guard<std::mutex> lock(cacheLock);
+		if (--source->refCount > 0) return;
+		std::map<SourceKey, VectorFileSource*>::iterator found = cachedSources.find(SourceKey(source->cacheKey, source->cacheTime));
+		if (found != cachedSources.end() && found->second == source)
+			cachedSources.erase(found);
+	}
+	DeleteVectorFileSource(source);
+}
+
+void AddBundledVectorFileSource(const char *baseName, long long time, long long size, VectorFileSource *source)
+{
+	BundledSource bundled;
+	bundled.name = BaseName(baseName);
+	bundled.time = time;
+	bundled.size = size;
+	bundled.source = source;
+
+	std::lock_guard<std::mutex> lock(cacheLock);
+	source->refCount = 1;
+	bundledSources.push_back(bundled);
+}
+
+void RemoveBundledVectorFileSources()
+{
+	std::vector<BundledSource> removed;
+	{
+		std::lock_guard<std::mutex> lock(cacheLock);
+		removed.swap(bundledSources);
+	}
+
+	// Sources still used by geometries go when those are deleted
+	for (size_t b=0; b<removed.size(); b++)
+		ReleaseVectorFileSource(removed[b].source);
+}
@@ -0,0 +1,27 @@
+// geometrycache.h : process wide cache of parsed vector files.
+// Include after stdafx.h, tessellate.h and vectorfile.h.
+
+#pragma once
+
+// A source for fileName with at least the fill or border asked for and nLods
+// levels simplified from baseTolerance.  A source already loaded from the
+// file, unchanged since, is shared; otherwise one is built, covering whatever
+// the cached one had as well, and always with borders, so that a fill-only
+// load followed by a border-only one reads the file once.  Every call is
+// matched by ReleaseVectorFileSource.
+VectorFileSource* AcquireVectorFileSource(const char *fileName, bool loadFill, bool loadBorder, int nLods, double baseTolerance);
+
+// Drop a reference; the source is deleted with its last one
+void ReleaseVectorFileSource(VectorFileSource *source);
+
+// The lower case name (without directory), write time and size of fileName,
+// which is how bundled sources are matched to files.  False if it can't be
+// found.
+bool GetVectorFileStamp(const char *fileName, std::string &baseName, long long &time, long long &size);
+
+// Hand a source read from a bundle to the cache, which keeps it for files
+// named baseName with the same write time and size
+void AddBundledVectorFileSource(const char *baseName, long long time, long long size, VectorFileSource *source);
+
+// Let go of every bundled source
+void RemoveBundledVectorFileSources();
@@ -0,0 +1,583 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "hitindex.h"
+#include "hazards.h"
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HAZARDS_SSE2
+#endif
+
+// Fewest route points worth a worker thread
+static const int minHazardPointsPerThread = 2048;
+
+// Pieces shorter than this (in segment fractions) are dropped, and spans this
+// close are joined
+static const double spanEpsilon = 1e-9;
+
+struct RouteHazardResult
+{
+	std::vector<RouteHazardCrossing> crossings;
+};
+
+// Longitude difference folded into [-180, 180)
+static double WrapLongitude(double d)
+{
+	return d - 360 * floor((d + 180) / 360);
+}
+
+static bool Overlaps(const RTreeBox &a, const RTreeBox &b)
+{
+	return a.left <= b.right && a.right >= b.left && a.bottom <= b.top && a.top >= b.bottom;
+}
+
+// A box no query reaches, for hazards with nothing to hit
+static RTreeBox NowhereBox()
+{
+	RTreeBox box;
+	box.left = box.right = box.bottom = box.top = 1e30;
+	return box;
+}
+
+void BuildHazard(const double *xy, int n, double radius, double lower, double upper, Hazard &hazard)
+{
+	hazard.x.clear();
+	hazard.y.clear();
+	hazard.radius = 0;
+	hazard.centerX = hazard.centerY = 0;
+	hazard.lower = lower;
+	hazard.upper = upper;
+	hazard.box = NowhereBox();
+
+	if (n == 1)
+	{
+		// Circle: the box of the ellipse it is in the lon/lat plane
+		hazard.centerX = WrapLongitude(xy[0]);
+		hazard.centerY = xy[1];
+		hazard.radius = radius > 0 ? radius : 0;
+		if (hazard.radius > 0)
+		{
+			double c = cos(hazard.centerY * deg2rad);
+			double halfWidth = c * 180 > hazard.radius ? hazard.radius / c : 360;
+			hazard.box.left = hazard.centerX - std::min(halfWidth, 360.0);
+			hazard.box.right = hazard.centerX + std::min(halfWidth, 360.0);
+			hazard.box.bottom = hazard.centerY - hazard.radius;
+			hazard.box.top = hazard.centerY + hazard.radius;
+		}
+	}
+	else if (n >= 3)
+	{
+		// Polygon: each point unwrapped against the one before it, then the
+		// whole ring moved so its middle is on the map
+		hazard.x.resize(n + 1);
+		hazard.y.resize(n + 1);
+		for (int i=0; i<n; i++)
+		{
+			double lon = xy[i*2];
+			hazard.x[i] = i == 0 ? lon : hazard.x[i-1] + WrapLongitude(lon - hazard.x[i-1]);
+			hazard.y[i] = xy[i*2+1];
+		}
+		hazard.x[n] = hazard.x[0];
+		hazard.y[n] = hazard.y[0];
+
+		double left = *std::min_element(hazard.x.begin(), hazard.x.end());
+		double right = *std::max_element(hazard.x.begin(), hazard.x.end());
+		double shift = WrapLongitude((left + right) / 2) - (left + right) / 2;
+		for (int i=0; i<=n; i++)
+			hazard.x[i] += shift;
+		hazard.box.left = left + shift;
+		hazard.box.right = right + shift;
+		hazard.box.bottom = *std::min_element(hazard.y.begin(), hazard.y.end());
+		hazard.box.top = *std::max_element(hazard.y.begin(), hazard.y.end());
+	}
+}
+
+void BuildHazardSet(const double *xy, const int *offsets, int nHazards, const double *radius, const double *lower, const double *upper, HazardSet &set)
+{
+	set.hazards.resize(nHazards);
+	std::vector<RTreeBox> boxes(nHazards);
+	for (int h=0; h<nHazards; h++)
+	{
+		BuildHazard(xy + offsets[h]*2, offsets[h+1] - offsets[h], radius != NULL ? radius[h] : 0, lower[h], upper[h], set.hazards[h]);
+		boxes[h] = set.hazards[h].box;
+	}
+	set.tree.Build(boxes);
+}
+
+static double Cross(double ax, double ay, double bx, double by)
+{
+	return ax * by - ay * bx;
+}
+
+// Where segment (ax,ay)+t(dx,dy) meets edge e of the ring, as t in (0,1).  A
+// collinear edge overlapping the segment is cut at its ends.
+static void EdgeCuts(const double *px, const double *py, int e, double ax, double ay, double dx, double dy, std::vector<double> &cuts)
+{
+	double ex = px[e+1] - px[e], ey = py[e+1] - py[e];
+	double qx = px[e] - ax, qy = py[e] - ay;
+	double denom = Cross(dx, dy, ex, ey);
+	if (denom == 0)
+	{
+		double length2 = dx * dx + dy * dy;
+		if (Cross(qx, qy, dx, dy) == 0 && length2 > 0)
+		{
+			double t0 = (qx * dx + qy * dy) / length2;
+			double t1 = ((qx + ex) * dx + (qy + ey) * dy) / length2;
+			if (t0 > 0 && t0 < 1) cuts.push_back(t0);
+			if (t1 > 0 && t1 < 1) cuts.push_back(t1);
+		}
+		return;
+	}
+	double t = Cross(qx, qy, ex, ey) / denom;
+	double u = Cross(qx, qy, dx, dy) / denom;
+	if (t > 0 && t < 1 && u >= 0 && u <= 1)
+		cuts.push_back(t);
+}
+
+// EdgeCuts over the nEdges edges of a closed ring, two edges at a time
+static void RingCuts(const double *px, const double *py, int nEdges, double ax, double ay, double dx, double dy, std::vector<double> &cuts)
+{
+	int e = 0;
+#ifdef HAZARDS_SSE2
+	__m128d vax = _mm_set1_pd(ax), vay = _mm_set1_pd(ay);
+	__m128d vdx = _mm_set1_pd(dx), vdy = _mm_set1_pd(dy);
+	__m128d zero = _mm_setzero_pd();
+	for (; e+1<nEdges; e+=2)
+	{
+		__m128d xi = _mm_loadu_pd(px + e), xj = _mm_loadu_pd(px + e + 1);
+		__m128d yi = _mm_loadu_pd(py + e), yj = _mm_loadu_pd(py + e + 1);
+		__m128d ex = _mm_sub_pd(xj, xi), ey = _mm_sub_pd(yj, yi);
+		__m128d qx = _mm_sub_pd(xi, vax), qy = _mm_sub_pd(yi, vay);
+		__m128d denom = _mm_sub_pd(_mm_mul_pd(vdx, ey), _mm_mul_pd(vdy, ex));
+		__m128d tn = _mm_sub_pd(_mm_mul_pd(qx, ey), _mm_mul_pd(qy, ex));
+		__m128d un = _mm_sub_pd(_mm_mul_pd(qx, vdy), _mm_mul_pd(qy, vdx));
+
+		// With the signs of denom folded in, 0 < t < 1 and 0 <= u <= 1 need no
+		// division; parallel edges go the scalar way
+		__m128d sign = _mm_and_pd(denom, _mm_set1_pd(-0.0));
+		__m128d absDenom = _mm_xor_pd(denom, sign);
+		tn = _mm_xor_pd(tn, sign);
+		un = _mm_xor_pd(un, sign);
+		__m128d hit = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(tn, zero), _mm_cmplt_pd(tn, absDenom)),
+			_mm_and_pd(_mm_cmpge_pd(un, zero), _mm_cmple_pd(un, absDenom)));
+		int parallel = _mm_movemask_pd(_mm_cmpeq_pd(denom, zero));
+		int mask = _mm_movemask_pd(hit) & ~parallel;
+		if ((mask | parallel) == 0) continue;
+
+		double t[2];
+		_mm_storeu_pd(t, _mm_div_pd(tn, _mm_max_pd(absDenom, _mm_set1_pd(DBL_MIN))));
+		for (int lane=0; lane<2; lane++)
+		{
+			if (parallel & (1 << lane))
+				EdgeCuts(px, py, e + lane, ax, ay, dx, dy, cuts);
+			else if ((mask & (1 << lane)) && t[lane] < 1)
+				cuts.push_back(t[lane]);
+		}
+	}
+#endif
+	for (; e<nEdges; e++)
+		EdgeCuts(px, py, e, ax, ay, dx, dy, cuts);
+}
+
+// Add the parts of segment (ax,ay)-(bx,by) inside the polygon, as fractions
+// along it.  The segment is cut wherever it meets the ring and each piece is
+// tested at its middle.
+static void PolygonPieces(const Hazard &hazard, double ax, double ay, double bx, double by, std::vector<double> &pieces)
+{
+	double dx = bx - ax, dy = by - ay;
+	std::vector<double> cuts;
+	cuts.push_back(0);
+	cuts.push_back(1);
+	RingCuts(&hazard.x[0], &hazard.y[0], (int)hazard.x.size() - 1, ax, ay, dx, dy, cuts);
+	std::sort(cuts.begin(), cuts.end());
+
+	for (size_t c=0; c+1<cuts.size(); c++)
+	{
+		double t0 = cuts[c], t1 = cuts[c+1];
+		if (t1 - t0 <= spanEpsilon) continue;
+		double middle = (t0 + t1) / 2;
+		if (!PointInRing(&hazard.x[0], &hazard.y[0], (int)hazard.x.size(), ax + dx * middle, ay + dy * middle))
+			continue;
+		if (!pieces.empty() && pieces.back() >= t0 - spanEpsilon)
+			pieces.back() = t1;
+		else
+		{
+			pieces.push_back(t0);
+			pieces.push_back(t1);
+		}
+	}
+}
+
+// Add the part of the segment inside the circle
+static void CirclePieces(const Hazard &hazard, double ax, double ay, double bx, double by, std::vector<double> &pieces)
+{
+	double c = cos(hazard.centerY * deg2rad);
+	double px = WrapLongitude(ax - hazard.centerX) * c, py = ay - hazard.centerY;
+	double dx = (bx - ax) * c, dy = by - ay;
+	double a = dx * dx + dy * dy;
+	double b = 2 * (px * dx + py * dy);
+	double k = px * px + py * py - hazard.radius * hazard.radius;
+
+	double t0, t1;
+	if (a == 0)
+	{
+		if (k > 0) return;
+		t0 = 0;
+		t1 = 1;
+	}
+	else
+	{
+		double disc = b * b - 4 * a * k;
+		if (disc < 0) return;
+		double root = sqrt(disc);
+		t0 = std::max((-b - root) / (2 * a), 0.0);
+		t1 = std::min((-b + root) / (2 * a), 1.0);
+	}
+	if (t1 - t0 > spanEpsilon)
+	{
+		pieces.push_back(t0);
+		pieces.push_back(t1);
+	}
+}
+
+static bool ByHazardThenStart(const HazardSpan &a, const HazardSpan &b)
+{
+	if (a.hazard != b.hazard) return a.hazard < b.hazard;
+	return a.start < b.start;
+}
+
+void FindHazardSpans(const HazardSet &set, const double *xy, int n, std::vector<HazardSpan> &spans)
+{
+	std::vector<HazardSpan> found;
+	std::vector<int> candidates;
+	std::vector<double> pieces;
+	for (int i=0; i+1<n; i++)
+	{
+		double ax = WrapLongitude(xy[i*2]), ay = xy[i*2+1];
+		double bx = ax + WrapLongitude(xy[i*2+2] - xy[i*2]), by = xy[i*2+3];
+
+		// The segment, and a turn of the globe either way for hazards across
+		// the dateline
+		for (int shift=-1; shift<=1; shift++)
+		{
+			RTreeBox box;
+			box.left = std::min(ax, bx) + shift * 360;
+			box.right = std::max(ax, bx) + shift * 360;
+			box.bottom = std::min(ay, by);
+			box.top = std::max(ay, by);
+			double rect[4] = { box.left, box.right, box.bottom, box.top };
+			candidates.clear();
+			set.tree.Query(rect, candidates);
+
+			for (size_t c=0; c<candidates.size(); c++)
+			{
+				const Hazard &hazard = set.hazards[candidates[c]];
+				pieces.clear();
+				if (hazard.radius > 0)
+				{
+					// Circles are measured from their center whatever the shift;
+					// only the first shift that finds one tests it
+					bool tested = false;
+					for (int s=-1; s<shift && !tested; s++)
+					{
+						RTreeBox earlier = box;
+						earlier.left += (s - shift) * 360;
+						earlier.right += (s - shift) * 360;
+						tested = Overlaps(earlier, hazard.box);
+					}
+					if (!tested)
+						CirclePieces(hazard, ax, ay, bx, by, pieces);
+				}
+				else if (!hazard.x.empty())
+					PolygonPieces(hazard, ax + shift * 360, ay, bx + shift * 360, by, pieces);
+
+				for (size_t p=0; p<pieces.size(); p+=2)
+				{
+					HazardSpan span = { candidates[c], i + pieces[p], i + pieces[p+1] };
+					found.push_back(span);
+				}
+			}
+		}
+	}
+
+	// Join the pieces of each hazard that meet at segment ends (or overlap,
+	// from a hazard found at two shifts)
+	std::sort(found.begin(), found.end(), ByHazardThenStart);
+	for (size_t f=0; f<found.size(); f++)
+	{
+		if (!spans.empty() && spans.back().hazard == found[f].hazard && found[f].start <= spans.back().end + spanEpsilon)
+			spans.back().end = std::max(spans.back().end, found[f].end);
+		else
+			spans.push_back(found[f]);
+	}
+}
+
+bool FindAltitudeOverlap(const double *altitudes, int n, double start, double end, double lower, double upper, double &first, double &last)
+{
+	bool any = false;
+	int k0 = std::max((int)floor(start), 0), k1 = std::min((int)ceil(end), n - 1);
+	for (int k=k0; k<k1; k++)
+	{
+		double p0 = std::max(start, (double)k), p1 = std::min(end, (double)(k + 1));
+		if (p1 < p0) continue;
+		double a0 = altitudes[k], da = altitudes[k+1] - altitudes[k];
+
+		// Where the altitude, linear along the segment, is between the levels
+		double lo = p0, hi = p1;
+		if (da == 0)
+		{
+			if (a0 < lower || a0 > upper) continue;
+		}
+		else
+		{
+			double q0 = k + (lower - a0) / da, q1 = k + (upper - a0) / da;
+			if (q0 > q1) std::swap(q0, q1);
+			lo = std::max(lo, q0);
+			hi = std::min(hi, q1);
+			if (hi < lo) continue;
+		}
+		if (!any)
+			first = lo;
+		last = hi;
+		any = true;
+	}
+	return any;
+}
+
+void RoutePositionAt(const double *xy, const double *altitudes, int n, double position, double &lon, double &lat, double &altitude)
+{
+	int k = std::min(std::max((int)floor(position), 0), std::max(n - 2, 0));
+	double f = n > 1 ? position - k : 0;
+	const double *p = xy + k*2;
+	double dLon = n > 1 ? WrapLongitude(p[2] - p[0]) : 0;
+	lon = WrapLongitude(p[0] + dLon * f);
+	lat = n > 1 ? p[1] + (p[3] - p[1]) * f : p[1];
+	altitude = n > 1 ? altitudes[k] + (altitudes[k+1] - altitudes[k]) * f : altitudes[k];
+}
+
+static void IntersectRouteRun(const HazardSet *set, const double *xy, const double *altitudes, const int *offsets, int firstRoute, int endRoute, std::vector<RouteHazardCrossing> *crossings)
+{
+	std::vector<HazardSpan> spans;
+	for (int r=firstRoute; r<endRoute; r++)
+	{
+		int first = offsets[r], n = offsets[r+1] - offsets[r];
+		const double *routeXY = xy + first*2;
+		const double *routeAltitudes = altitudes + first;
+		spans.clear();
+		FindHazardSpans(*set, routeXY, n, spans);
+
+		for (size_t s=0; s<spans.size(); s++)
+		{
+			const Hazard &hazard = set->hazards[spans[s].hazard];
+			RouteHazardCrossing crossing;
+			crossing.route = r;
+			crossing.hazard = spans[s].hazard;
+			crossing.entryPosition = spans[s].start;
+			crossing.exitPosition = spans[s].end;
+			RoutePositionAt(routeXY, routeAltitudes, n, spans[s].start, crossing.entryLon, crossing.entryLat, crossing.entryAltitude);
+			RoutePositionAt(routeXY, routeAltitudes, n, spans[s].end, crossing.exitLon, crossing.exitLat, crossing.exitAltitude);
+			crossing.overlapEntryPosition = crossing.overlapExitPosition = 0;
+			crossing.altitudeOverlap = FindAltitudeOverlap(routeAltitudes, n, spans[s].start, spans[s].end, hazard.lower, hazard.upper,
+				crossing.overlapEntryPosition, crossing.overlapExitPosition) ? 1 : 0;
+			crossings->push_back(crossing);
+		}
+	}
+}
+
+extern "C" TESSELLATE_API RouteHazardResult* IntersectRoutesWithHazards(double routeXY[], double routeAltitudes[], int routeOffsets[], int nRoutes, double hazardXY[], int hazardOffsets[], int nHazards, double hazardRadius[], double hazardLower[], double hazardUpper[], int nThreads)
+{
+	RouteHazardResult *result = new RouteHazardResult;
+	if (nRoutes < 1 || nHazards < 1) return result;
+
+	HazardSet set;
+	BuildHazardSet(hazardXY, hazardOffsets, nHazards, hazardRadius, hazardLower, hazardUpper, set);
+
+	// Runs of routes with about the same number of points on each thread,
+	// gathered in route order
+	int nPoints = routeOffsets[nRoutes] - routeOffsets[0];
+	nThreads = WorkerThreadCount(nThreads, nPoints, minHazardPointsPerThread);
+	if (nThreads > nRoutes) nThreads = nRoutes;
+	std::vector<std::vector<RouteHazardCrossing> > partial(nThreads);
+	std::vector<std::thread> workers;
+	int run = 0, firstRoute = 0;
+	for (int r=0; r<nRoutes && run<nThreads-1; r++)
+	{
+		if ((double)(routeOffsets[r+1] - routeOffsets[0]) >= (double)nPoints * (run + 1) / nThreads)
+		{
+			workers.push_back(std::thread(IntersectRouteRun, &set, routeXY, routeAltitudes, routeOffsets, firstRoute, r + 1, &partial[run]));
+			firstRoute = r + 1;
+			run++;
+		}
+	}
+	IntersectRouteRun(&set, routeXY, routeAltitudes, routeOffsets, firstRoute, nRoutes, &partial[run]);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	for (int t=0; t<=run; t++)
+		result->crossings.insert(result->crossings.end(), partial[t].begin(), partial[t].end());
+	return result;
+}
+
+extern "C" TESSELLATE_API void DeleteRouteHazardResult(RouteHazardResult* result)
+{
+	delete result;
+}
+
+extern "C" TESSELLATE_API int GetRouteHazardCrossingCount(RouteHazardResult* result)
+{
+	return result != NULL ? (int)result->crossings.size() : 0;
+}
+
+extern "C" TESSELLATE_API const RouteHazardCrossing* GetRouteHazardCrossings(RouteHazardResult* result)
+{
+	return result != NULL && !result->crossings.empty() ? &result->crossings[0] : NULL;
+}
+
+void HazardVelocity(double direction, double speed, double lat, double &vx, double &vy)
+{
+	// A knot is a nautical mile an hour, and a nautical mile a minute of arc
+	double rate = speed / 60 / 3600;
+	double c = cos(lat * deg2rad);
+	vx = c > 1e-6 ? rate * sin(direction * deg2rad) / c : 0;
+	vy = rate * cos(direction * deg2rad);
+}
+
+bool FindEarliestConflict(const Hazard &hazard, double vx, double vy, double start, double end, const double *xy, const double *times, const double *altitudes, int n, double &time, double &position)
+{
+	bool found = false;
+	std::vector<double> pieces;
+	for (int k=0; k+1<n; k++)
+	{
+		double t0 = times[k], t1 = times[k+1];
+		if (!(t1 > t0)) continue;
+		if (found && t0 >= time) break;		// times rise along the route
+		double ta = std::max(t0, start), tb = std::min(t1, end);
+		if (tb <= ta) continue;
+
+		// The part of the segment flown while the hazard is valid, seen from the
+		// hazard: the route less the hazard's drift is still a straight line,
+		// and the hazard holds still at where it is at start
+		double f0 = (ta - t0) / (t1 - t0), f1 = (tb - t0) / (t1 - t0);
+		double lon = WrapLongitude(xy[k*2]), dLon = WrapLongitude(xy[k*2+2] - xy[k*2]);
+		double lat = xy[k*2+1], dLat = xy[k*2+3] - xy[k*2+1];
+		double ax = lon + dLon * f0 - vx * (ta - start), ay = lat + dLat * f0 - vy * (ta - start);
+		double bx = lon + dLon * f1 - vx * (tb - start), by = lat + dLat * f1 - vy * (tb - start);
+		double levels[2];
+		levels[0] = altitudes[k] + (altitudes[k+1] - altitudes[k]) * f0;
+		levels[1] = altitudes[k] + (altitudes[k+1] - altitudes[k]) * f1;
+
+		pieces.clear();
+		if (hazard.radius > 0)
+			CirclePieces(hazard, ax, ay, bx, by, pieces);
+		else if (!hazard.x.empty())
+		{
+			double onMap = WrapLongitude(ax) - ax;
+			ax += onMap;
+			bx += onMap;
+			for (int shift=-1; shift<=1; shift++)
+			{
+				RTreeBox box;
+				box.left = std::min(ax, bx) + shift * 360;
+				box.right = std::max(ax, bx) + shift * 360;
+				box.bottom = std::min(ay, by);
+				box.top = std::max(ay, by);
+				if (Overlaps(box, hazard.box))
+					PolygonPieces(hazard, ax + shift * 360, ay, bx + shift * 360, by, pieces);
+			}
+		}
+
+		for (size_t p=0; p<pieces.size(); p+=2)
+		{
+			double first, last;
+			if (!FindAltitudeOverlap(levels, 2, pieces[p], pieces[p+1], hazard.lower, hazard.upper, first, last))
+				continue;
+			double t = ta + (tb - ta) * first;
+			if (!found || t < time)
+			{
+				time = t;
+				position = k + f0 + (f1 - f0) * first;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+// The arguments of FindMovingHazardConflicts, for the worker threads
+struct MovingHazardBatch
+{
+	const double *routeXY, *routeTimes, *routeAltitudes;
+	const int *routeOffsets;
+	const double *hazardXY;
+	const int *hazardOffsets;
+	const double *hazardRadius, *hazardLower, *hazardUpper;
+	const double *hazardDirection, *hazardSpeed, *hazardStart, *hazardEnd;
+	MovingHazardConflict *conflicts;
+};
+
+static void FindConflictRun(const MovingHazardBatch *batch, int firstPair, int endPair, int *nFound)
+{
+	Hazard hazard;
+	for (int i=firstPair; i<endPair; i++)
+	{
+		MovingHazardConflict &conflict = batch->conflicts[i];
+		memset(&conflict, 0, sizeof(conflict));
+
+		int first = batch->routeOffsets[i], n = batch->routeOffsets[i+1] - first;
+		int hazardFirst = batch->hazardOffsets[i];
+		BuildHazard(batch->hazardXY + hazardFirst*2, batch->hazardOffsets[i+1] - hazardFirst, batch->hazardRadius != NULL ? batch->hazardRadius[i] : 0,
+			batch->hazardLower[i], batch->hazardUpper[i], hazard);
+
+		double vx = 0, vy = 0;
+		double lat = hazard.radius > 0 ? hazard.centerY : (hazard.box.bottom + hazard.box.top) / 2;
+		if (batch->hazardSpeed != NULL && batch->hazardSpeed[i] > 0)
+			HazardVelocity(batch->hazardDirection[i], batch->hazardSpeed[i], lat, vx, vy);
+
+		const double *xy = batch->routeXY + first*2;
+		const double *altitudes = batch->routeAltitudes + first;
+		if (!FindEarliestConflict(hazard, vx, vy, batch->hazardStart[i], batch->hazardEnd[i], xy, batch->routeTimes + first, altitudes, n, conflict.time, conflict.position))
+			continue;
+		conflict.conflict = 1;
+		RoutePositionAt(xy, altitudes, n, conflict.position, conflict.lon, conflict.lat, conflict.altitude);
+		(*nFound)++;
+	}
+}
+
+extern "C" TESSELLATE_API int FindMovingHazardConflicts(double routeXY[], double routeTimes[], double routeAltitudes[], int routeOffsets[], double hazardXY[], int hazardOffsets[], double hazardRadius[], double hazardLower[], double hazardUpper[], double hazardDirection[], double hazardSpeed[], double hazardStart[], double hazardEnd[], int nPairs, MovingHazardConflict conflicts[], int nThreads)
+{
+	if (nPairs < 1) return 0;
+	MovingHazardBatch batch = { routeXY, routeTimes, routeAltitudes, routeOffsets, hazardXY, hazardOffsets, hazardRadius, hazardLower, hazardUpper,
+		hazardDirection, hazardSpeed, hazardStart, hazardEnd, conflicts };
+
+	// Runs of pairs with about the same number of route points on each thread;
+	// each writes its own part of conflicts
+	int nPoints = routeOffsets[nPairs] - routeOffsets[0];
+	nThreads = WorkerThreadCount(nThreads, nPoints, minHazardPointsPerThread);
+	if (nThreads > nPairs) nThreads = nPairs;
+	std::vector<int> nFound(nThreads, 0);
+	std::vector<std::thread> workers;
+	int run = 0, firstPair = 0;
+	for (int i=0; i<nPairs && run<nThreads-1; i++)
+	{
+		if ((double)(routeOffsets[i+1] - routeOffsets[0]) >= (double)nPoints * (run + 1) / nThreads)
+		{
+			workers.push_back(std::thread(FindConflictRun, &batch, firstPair, i + 1, &nFound[run]));
+			firstPair = i + 1;
+			run++;
+		}
+	}
+	FindConflictRun(&batch, firstPair, nPairs, &nFound[run]);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	int total = 0;
+	for (int t=0; t<=run; t++)
+		total += nFound[t];
+	return total;
+}
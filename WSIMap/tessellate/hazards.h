@@ -0,0 +1,62 @@
+// hazards.h : flight routes against weather hazards.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <vector>
+#include "rtree.h"
+
+// A hazard as the intersection code keeps it: a polygon ring, closed and
+// unwrapped so no edge jumps the dateline, or a circle (a single point with
+// a radius), measured in a frame centered on it with longitudes scaled by the
+// cosine of its latitude
+struct Hazard
+{
+	std::vector<double> x, y;	// polygon ring, last point repeating the first
+	double centerX, centerY;	// circle center
+	double radius;				// circle radius in degrees of arc; 0 for a polygon
+	double lower, upper;		// flight levels
+	RTreeBox box;
+};
+
+struct HazardSet
+{
+	std::vector<Hazard> hazards;
+	PackedRTree tree;			// over the hazard boxes
+};
+
+// A stretch of a route inside one hazard, in route positions: segment index
+// plus fraction along it
+struct HazardSpan
+{
+	int hazard;
+	double start, end;
+};
+
+// Build a hazard from n x,y points; a single point takes radius
+void BuildHazard(const double *xy, int n, double radius, double lower, double upper, Hazard &hazard);
+
+// Build hazard i from points offsets[i] to offsets[i+1]-1 of xy; a single
+// point takes radius[i]
+void BuildHazardSet(const double *xy, const int *offsets, int nHazards, const double *radius, const double *lower, const double *upper, HazardSet &set);
+
+// The stretches of the route of n points inside each hazard, merged across
+// segment ends, ordered by hazard and then position
+void FindHazardSpans(const HazardSet &set, const double *xy, int n, std::vector<HazardSpan> &spans);
+
+// The first and last route positions in [start, end] at which the route's
+// altitude is between lower and upper; false if there are none
+bool FindAltitudeOverlap(const double *altitudes, int n, double start, double end, double lower, double upper, double &first, double &last);
+
+// The longitude, latitude and altitude at a route position
+void RoutePositionAt(const double *xy, const double *altitudes, int n, double position, double &lon, double &lat, double &altitude);
+
+// The rate in degrees per second a hazard at latitude lat drifts at, moving
+// toward direction degrees true at speed knots
+void HazardVelocity(double direction, double speed, double lat, double &vx, double &vy);
+
+// The earliest time the route of n points, reaching each at times[i] seconds,
+// is inside the hazard and within its levels while the hazard drifts at vx,vy
+// from where it is at start until end.  Returns false if it never is; time
+// and position (a route position) are set otherwise.
+bool FindEarliestConflict(const Hazard &hazard, double vx, double vy, double start, double end, const double *xy, const double *times, const double *altitudes, int n, double &time, double &position);
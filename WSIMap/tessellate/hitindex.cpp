@@ -0,0 +1,520 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "hitindex.h"
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <algorithm>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HITINDEX_SSE2
+#endif
+
+// Grid cell size in degrees, and the most cells a feature is listed in before
+// it goes in the large list instead
+static const double cellSize = 2.0;
+static const int maxFeatureCells = 256;
+
+// Curve.StrictPointOnLine's slack beyond a segment's ends, in degrees, and
+// the earth radius it measures distances with, in kilometers
+static const double segmentSlack = 0.15;
+static const double lineEarthRadius = 6378.137;
+
+static bool Overlaps(const RTreeBox &box, const RTreeBox &rect)
+{
+	return box.left <= rect.right && box.right >= rect.left && box.bottom <= rect.top && box.top >= rect.bottom;
+}
+
+static int CellOf(double v)
+{
+	return (int)floor(v / cellSize);
+}
+
+static long long CellKey(int column, int row)
+{
+	return (long long)(((unsigned long long)(unsigned int)column << 32) | (unsigned int)row);
+}
+
+// Box around the points within radius degrees of arc of x,y on the sphere; a
+// cap reaching a pole covers every longitude
+static RTreeBox CapBox(double x, double y, double radius)
+{
+	// A little slack for distances measured with other formulas
+	radius += radius * 1e-9 + 1e-9;
+
+	RTreeBox box;
+	box.bottom = y - radius;
+	box.top = y + radius;
+	double halfWidth = 360;
+	if (fabs(y) + radius < 90)
+	{
+		double s = sin(radius * deg2rad) / cos(y * deg2rad);
+		if (s < 1)
+			halfWidth = asin(s) / deg2rad + 1e-9;
+	}
+	box.left = x - halfWidth;
+	box.right = x + halfWidth;
+	return box;
+}
+
+static bool FiniteBox(const RTreeBox &box)
+{
+	return box.left == box.left && box.right == box.right && box.bottom == box.bottom && box.top == box.top &&
+		fabs(box.left) < 1e6 && fabs(box.right) < 1e6 && fabs(box.bottom) < 1e6 && fabs(box.top) < 1e6;
+}
+
+static RTreeBox PointsBox(const double *px, const double *py, int n)
+{
+	RTreeBox box;
+	box.left = box.bottom = DBL_MAX;
+	box.right = box.top = -DBL_MAX;
+	for (int i=0; i<n; i++)
+	{
+		box.left = std::min(box.left, px[i]);
+		box.right = std::max(box.right, px[i]);
+		box.bottom = std::min(box.bottom, py[i]);
+		box.top = std::max(box.top, py[i]);
+	}
+	return box;
+}
+
+// Number of segments i (from point i to point i+1) that a ray from x,y
+// towards -x crosses, by Polygon.IsPointIn's rule
+static int RayCrossingsScalar(const double *px, const double *py, int first, int nSegments, double x, double y)
+{
+	int count = 0;
+	for (int i=first; i<nSegments; i++)
+	{
+		double yi = py[i], yj = py[i+1];
+		if ((yi < y && yj >= y) || (yj < y && yi >= y))
+			if (px[i] + (y - yi) / (yj - yi) * (px[i+1] - px[i]) < x)
+				count++;
+	}
+	return count;
+}
+
+static int RayCrossings(const double *px, const double *py, int nSegments, double x, double y)
+{
+	int i = 0, count = 0;
+#ifdef HITINDEX_SSE2
+	__m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y);
+	for (; i+2<=nSegments; i+=2)
+	{
+		__m128d xi = _mm_loadu_pd(px + i), xj = _mm_loadu_pd(px + i + 1);
+		__m128d yi = _mm_loadu_pd(py + i), yj = _mm_loadu_pd(py + i + 1);
+		__m128d spans = _mm_or_pd(_mm_and_pd(_mm_cmplt_pd(yi, vy), _mm_cmpge_pd(yj, vy)),
+			_mm_and_pd(_mm_cmplt_pd(yj, vy), _mm_cmpge_pd(yi, vy)));
+		if (_mm_movemask_pd(spans) == 0) continue;
+
+		// Lanes that do not span y may divide by zero; they are masked off
+		__m128d cross = _mm_add_pd(xi, _mm_mul_pd(_mm_div_pd(_mm_sub_pd(vy, yi), _mm_sub_pd(yj, yi)), _mm_sub_pd(xj, xi)));
+		int mask = _mm_movemask_pd(_mm_and_pd(spans, _mm_cmplt_pd(cross, vx)));
+		count += (mask & 1) + (mask >> 1);
+	}
+#endif
+	return count + RayCrossingsScalar(px, py, i, nSegments, x, y);
+}
+
+static bool NearSegmentsScalar(const double *px, const double *py, int first, int nSegments, double x, double y, double distance)
+{
+	for (int i=first; i<nSegments; i++)
+	{
+		double ax = px[i], ay = py[i], bx = px[i+1], by = py[i+1];
+		if (ax == bx && ay == by)
+		{
+			if (x == ax && y == ay) return true;
+			continue;
+		}
+		if ((bx < ax && ax + segmentSlack < x) || (by < ay && ay + segmentSlack < y)) continue;
+		if ((x < ax - segmentSlack && ax < bx) || (y < ay - segmentSlack && ay < by)) continue;
+		if ((ax < bx && bx + segmentSlack < x) || (ay < by && by + segmentSlack < y)) continue;
+		if ((x < bx - segmentSlack && bx < ax) || (y < by - segmentSlack && by < ay)) continue;
+
+		double rax = ax * deg2rad, ray = ay * deg2rad, rbx = bx * deg2rad, rby = by * deg2rad;
+		double rx = x * deg2rad, ry = y * deg2rad;
+		double d = fabs((ray - ry) * (rbx - rax) - (rby - ray) * (rax - rx)) / sqrt((rax - rbx) * (rax - rbx) + (ray - rby) * (ray - rby));
+		if (d * lineEarthRadius <= distance) return true;
+	}
+	return false;
+}
+
+static bool NearSegments(const double *px, const double *py, int nSegments, double x, double y, double distance)
+{
+	int i = 0;
+#ifdef HITINDEX_SSE2
+	__m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y);
+	__m128d slack = _mm_set1_pd(segmentSlack), toRadians = _mm_set1_pd(deg2rad);
+	__m128d limit = _mm_set1_pd(distance), radius = _mm_set1_pd(lineEarthRadius);
+	__m128d signBit = _mm_set1_pd(-0.0);
+	for (; i+2<=nSegments; i+=2)
+	{
+		__m128d ax = _mm_loadu_pd(px + i), bx = _mm_loadu_pd(px + i + 1);
+		__m128d ay = _mm_loadu_pd(py + i), by = _mm_loadu_pd(py + i + 1);
+
+		// A segment of one point is only hit exactly on it
+		__m128d degenerate = _mm_and_pd(_mm_cmpeq_pd(ax, bx), _mm_cmpeq_pd(ay, by));
+		__m128d onPoint = _mm_and_pd(degenerate, _mm_and_pd(_mm_cmpeq_pd(vx, ax), _mm_cmpeq_pd(vy, ay)));
+		if (_mm_movemask_pd(onPoint) != 0) return true;
+
+		// Beyond either end by more than the slack
+		__m128d outside = _mm_or_pd(
+			_mm_or_pd(_mm_and_pd(_mm_cmplt_pd(bx, ax), _mm_cmplt_pd(_mm_add_pd(ax, slack), vx)),
+				_mm_and_pd(_mm_cmplt_pd(by, ay), _mm_cmplt_pd(_mm_add_pd(ay, slack), vy))),
+			_mm_or_pd(_mm_and_pd(_mm_cmplt_pd(vx, _mm_sub_pd(ax, slack)), _mm_cmplt_pd(ax, bx)),
+				_mm_and_pd(_mm_cmplt_pd(vy, _mm_sub_pd(ay, slack)), _mm_cmplt_pd(ay, by))));
+		outside = _mm_or_pd(outside, _mm_or_pd(
+			_mm_or_pd(_mm_and_pd(_mm_cmplt_pd(ax, bx), _mm_cmplt_pd(_mm_add_pd(bx, slack), vx)),
+				_mm_and_pd(_mm_cmplt_pd(ay, by), _mm_cmplt_pd(_mm_add_pd(by, slack), vy))),
+			_mm_or_pd(_mm_and_pd(_mm_cmplt_pd(vx, _mm_sub_pd(bx, slack)), _mm_cmplt_pd(bx, ax)),
+				_mm_and_pd(_mm_cmplt_pd(vy, _mm_sub_pd(by, slack)), _mm_cmplt_pd(by, ay)))));
+		__m128d candidate = _mm_andnot_pd(_mm_or_pd(degenerate, outside), _mm_castsi128_pd(_mm_set1_epi32(-1)));
+		if (_mm_movemask_pd(candidate) == 0) continue;
+
+		// Distance to the line through the segment, in radians
+		__m128d rax = _mm_mul_pd(ax, toRadians), ray = _mm_mul_pd(ay, toRadians);
+		__m128d rbx = _mm_mul_pd(bx, toRadians), rby = _mm_mul_pd(by, toRadians);
+		__m128d rx = _mm_mul_pd(vx, toRadians), ry = _mm_mul_pd(vy, toRadians);
+		__m128d cross = _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(ray, ry), _mm_sub_pd(rbx, rax)), _mm_mul_pd(_mm_sub_pd(rby, ray), _mm_sub_pd(rax, rx)));
+		__m128d dx = _mm_sub_pd(rax, rbx), dy = _mm_sub_pd(ray, rby);
+		__m128d d = _mm_div_pd(_mm_andnot_pd(signBit, cross), _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+		__m128d hit = _mm_and_pd(candidate, _mm_cmple_pd(_mm_mul_pd(d, radius), limit));
+		if (_mm_movemask_pd(hit) != 0) return true;
+	}
+#endif
+	return NearSegmentsScalar(px, py, i, nSegments, x, y, distance);
+}
+
+bool PointInRing(const double *px, const double *py, int n, double x, double y)
+{
+	// The ring is stored closed, so segment n-1 runs back to the first point
+	return n > 0 && (RayCrossings(px, py, n - 1, x, y) & 1) != 0;
+}
+
+bool PointOnPolyline(const double *px, const double *py, int n, double x, double y, double distance)
+{
+	return n > 1 && NearSegments(px, py, n - 1, x, y, distance);
+}
+
+void HitIndex::Set(int id, int type, const double *xy, int nPoints, bool crossDateline, double radius)
+{
+	if (id < 0) return;
+	if (id >= (int)features.size())
+	{
+		HitIndexFeature unused;
+		unused.type = -1;
+		unused.crossDateline = false;
+		unused.radius = 0;
+		unused.cellLeft = 0;
+		unused.cellRight = -1;
+		unused.cellBottom = 0;
+		unused.cellTop = -1;
+		unused.large = false;
+		unused.visitStamp = 0;
+		unused.hitStamp = 0;
+		features.resize(id + 1, unused);
+	}
+	else
+		RemoveFromCells(id);
+
+	HitIndexFeature &feature = features[id];
+	feature.type = type;
+	feature.crossDateline = crossDateline;
+	feature.radius = radius;
+	feature.x.clear();
+	feature.y.clear();
+	feature.runs.clear();
+	if (xy == NULL || nPoints < 0) nPoints = 0;
+
+	// Polygon rings are closed here so the kernels need no wrap around;
+	// Curve adjusts its own points for the dateline, Polygon only the mouse
+	bool closed = type == HitPolygon && nPoints > 0;
+	feature.x.reserve(nPoints + (closed ? 1 : 0));
+	feature.y.reserve(nPoints + (closed ? 1 : 0));
+	for (int i=0; i<nPoints; i++)
+	{
+		double x = xy[i*2];
+		if (type == HitPolyline && crossDateline && x > 0)
+			x -= 360;
+		feature.x.push_back(x);
+		feature.y.push_back(xy[i*2+1]);
+	}
+	if (closed)
+	{
+		feature.x.push_back(feature.x[0]);
+		feature.y.push_back(feature.y[0]);
+	}
+
+	int n = (int)feature.x.size();
+	switch (type)
+	{
+	case HitPoint:
+		if (n > 0)
+			feature.box = CapBox(feature.x[0], feature.y[0], 0);
+		break;
+	case HitCircle:
+		if (n > 0)
+			feature.box = CapBox(feature.x[0], feature.y[0], radius);
+		break;
+	case HitPolyline:
+	case HitPolygon:
+		if (n > 1)
+		{
+			for (int first=0; first<n-1; first+=HITINDEX_RUN)
+			{
+				int count = std::min(HITINDEX_RUN, n - 1 - first) + 1;
+				feature.runs.push_back(PointsBox(&feature.x[first], &feature.y[first], count));
+			}
+			feature.box = PointsBox(&feature.x[0], &feature.y[0], n);
+		}
+		break;
+	}
+
+	bool listed = (type == HitPoint || type == HitCircle) ? n > 0 : n > 1;
+	if (listed && FiniteBox(feature.box))
+		AddToCells(id);
+}
+
+void HitIndex::Remove(int id)
+{
+	if (id < 0 || id >= (int)features.size()) return;
+	RemoveFromCells(id);
+	HitIndexFeature &feature = features[id];
+	feature.type = -1;
+	std::vector<double>().swap(feature.x);
+	std::vector<double>().swap(feature.y);
+	std::vector<RTreeBox>().swap(feature.runs);
+
+	// Trailing unused ids are dropped, so a layer that shrinks gives back its
+	// memory
+	while (!features.empty() && features.back().type < 0)
+		features.pop_back();
+}
+
+void HitIndex::Clear()
+{
+	features.clear();
+	cells.clear();
+	large.clear();
+}
+
+void HitIndex::AddToCells(int id)
+{
+	HitIndexFeature &feature = features[id];
+	int left = CellOf(feature.box.left), right = CellOf(feature.box.right);
+	int bottom = CellOf(feature.box.bottom), top = CellOf(feature.box.top);
+	if ((long long)(right - left + 1) * (top - bottom + 1) > maxFeatureCells)
+	{
+		feature.large = true;
+		large.push_back(id);
+		return;
+	}
+
+	feature.cellLeft = left;
+	feature.cellRight = right;
+	feature.cellBottom = bottom;
+	feature.cellTop = top;
+	for (int column=left; column<=right; column++)
+		for (int row=bottom; row<=top; row++)
+			cells[CellKey(column, row)].push_back(id);
+}
+
+static void EraseId(std::vector<int> &ids, int id)
+{
+	std::vector<int>::iterator found = std::find(ids.begin(), ids.end(), id);
+	if (found != ids.end())
+	{
+		*found = ids.back();
+		ids.pop_back();
+	}
+}
+
+void HitIndex::RemoveFromCells(int id)
+{
+	HitIndexFeature &feature = features[id];
+	if (feature.large)
+		EraseId(large, id);
+	for (int column=feature.cellLeft; column<=feature.cellRight; column++)
+		for (int row=feature.cellBottom; row<=feature.cellTop; row++)
+		{
+			CellMap::iterator cell = cells.find(CellKey(column, row));
+			if (cell == cells.end()) continue;
+			EraseId(cell->second, id);
+			if (cell->second.empty())
+				cells.erase(cell);
+		}
+	feature.large = false;
+	feature.cellLeft = 0;
+	feature.cellRight = -1;
+}
+
+bool HitIndex::Hits(const HitIndexFeature &feature, double x, double y, double lineDistance) const
+{
+	const double *px = &feature.x[0], *py = &feature.y[0];
+	int nSegments = (int)feature.x.size() - 1;
+	if (feature.crossDateline && x > 0)
+		x -= 360;
+
+	if (feature.type == HitPolyline)
+	{
+		// Only runs the point is near can have a segment it is on
+		double margin = std::max(segmentSlack, lineDistance / lineEarthRadius / deg2rad);
+		for (int r=0; r<(int)feature.runs.size(); r++)
+		{
+			const RTreeBox &run = feature.runs[r];
+			if (x < run.left - margin || x > run.right + margin || y < run.bottom - margin || y > run.top + margin)
+				continue;
+			int first = r * HITINDEX_RUN;
+			if (PointOnPolyline(px + first, py + first, std::min(HITINDEX_RUN, nSegments - first) + 1, x, y, lineDistance))
+				return true;
+		}
+		return false;
+	}
+
+	// Polygon: only runs that span y can be crossed by the ray
+	int crossings = 0;
+	for (int r=0; r<(int)feature.runs.size(); r++)
+	{
+		const RTreeBox &run = feature.runs[r];
+		if (y <= run.bottom || y > run.top)
+			continue;
+		int first = r * HITINDEX_RUN;
+		crossings += RayCrossings(px + first, py + first, std::min(HITINDEX_RUN, nSegments - first), x, y);
+	}
+	return (crossings & 1) != 0;
+}
+
+void HitIndex::Query(double x, double y, double radius, double lineDistance, std::vector<int> &ids)
+{
+	// Three stamps a query: one per pass, the last also marking its hits
+	if (queryStamp > UINT_MAX - 4)
+	{
+		for (size_t i=0; i<features.size(); i++)
+			features[i].visitStamp = features[i].hitStamp = 0;
+		queryStamp = 0;
+	}
+	unsigned int hitStamp = queryStamp + 3;
+
+	// One rectangle holding the cap around the point and the reach of a
+	// polyline hit; points and circles are only boxed here, the caller
+	// measures them
+	double lineMargin = std::max(segmentSlack, lineDistance / lineEarthRadius / deg2rad);
+	RTreeBox cap = CapBox(x, y, std::max(radius, 0.0));
+	RTreeBox rect;
+	rect.left = std::min(cap.left, x - lineMargin);
+	rect.right = std::max(cap.right, x + lineMargin);
+	rect.bottom = std::min(cap.bottom, y - lineMargin);
+	rect.top = std::max(cap.top, y + lineMargin);
+	if (!FiniteBox(rect))
+	{
+		queryStamp = hitStamp;
+		return;
+	}
+
+	long long columns = CellOf(rect.right) - CellOf(rect.left) + 1, rows = CellOf(rect.top) - CellOf(rect.bottom) + 1;
+	bool scanAll = columns * rows * 3 > (long long)features.size();
+
+	// The same point a turn of the globe either way, for features on the
+	// other side of the dateline
+	std::vector<int> candidates;
+	for (int shift=-1; shift<=1; shift++)
+	{
+		unsigned int visitStamp = queryStamp + 2 + shift;
+		RTreeBox shifted = rect;
+		shifted.left += shift * 360;
+		shifted.right += shift * 360;
+
+		candidates.clear();
+		if (scanAll)
+		{
+			for (int id=0; id<(int)features.size(); id++)
+				candidates.push_back(id);
+		}
+		else
+		{
+			candidates.assign(large.begin(), large.end());
+			for (int column=CellOf(shifted.left); column<=CellOf(shifted.right); column++)
+				for (int row=CellOf(shifted.bottom); row<=CellOf(shifted.top); row++)
+				{
+					CellMap::const_iterator cell = cells.find(CellKey(column, row));
+					if (cell != cells.end())
+						candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+				}
+		}
+
+		for (size_t c=0; c<candidates.size(); c++)
+		{
+			HitIndexFeature &feature = features[candidates[c]];
+			if (feature.visitStamp == visitStamp || feature.hitStamp == hitStamp || feature.x.empty())
+				continue;
+			feature.visitStamp = visitStamp;
+
+			bool hit;
+			double shiftedX = x + shift * 360;
+			switch (feature.type)
+			{
+			case HitPoint:
+				hit = Overlaps(feature.box, CapBox(shiftedX, y, std::max(radius, 0.0)));
+				break;
+			case HitCircle:
+				hit = shiftedX >= feature.box.left && shiftedX <= feature.box.right && y >= feature.box.bottom && y <= feature.box.top;
+				break;
+			case HitPolyline:
+			case HitPolygon:
+				// Tested against the point as given; the shift only finds them
+				hit = Overlaps(feature.box, shifted) && Hits(feature, x, y, lineDistance);
+				break;
+			default:
+				hit = false;
+				break;
+			}
+			if (hit)
+			{
+				feature.hitStamp = hitStamp;
+				ids.push_back(candidates[c]);
+			}
+		}
+	}
+	queryStamp = hitStamp;
+
+	std::sort(ids.begin(), ids.end());
+}
+
+extern "C" TESSELLATE_API HitIndex* CreateHitIndex(void)
+{
+	return new HitIndex;
+}
+
+extern "C" TESSELLATE_API void DeleteHitIndex(HitIndex* index)
+{
+	delete index;
+}
+
+extern "C" TESSELLATE_API void SetHitIndexFeature(HitIndex* index, int id, HitFeatureTypes type, double xy[], int nPoints, int crossDateline, double radius)
+{
+	if (index == NULL) return;
+	index->Set(id, type, xy, nPoints, crossDateline != 0, radius);
+}
+
+extern "C" TESSELLATE_API void RemoveHitIndexFeature(HitIndex* index, int id)
+{
+	if (index == NULL) return;
+	index->Remove(id);
+}
+
+extern "C" TESSELLATE_API void ClearHitIndex(HitIndex* index)
+{
+	if (index == NULL) return;
+	index->Clear();
+}
+
+extern "C" TESSELLATE_API int QueryHitIndex(HitIndex* index, double x, double y, double radius, double lineDistance, int ids[], int maxIds)
+{
+	if (index == NULL) return 0;
+	std::vector<int> hits;
+	index->Query(x, y, radius, lineDistance, hits);
+	for (int i=0; i<(int)hits.size() && i<maxIds; i++)
+		ids[i] = hits[i];
+	return (int)hits.size();
+}
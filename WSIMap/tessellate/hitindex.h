@@ -0,0 +1,68 @@
+// hitindex.h : spatial index for picking map features under the mouse.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "rtree.h"
+
+// Segments are boxed in runs of this many, so a long polyline is only tested
+// where the mouse is near it
+#define HITINDEX_RUN	32
+
+struct HitIndexFeature
+{
+	int type;					// HitFeatureTypes; -1 for an unused id
+	bool crossDateline;
+	double radius;				// circles, in degrees of arc
+	RTreeBox box;
+	std::vector<double> x, y;
+	std::vector<RTreeBox> runs;	// polylines and polygons, one per HITINDEX_RUN segments
+	int cellLeft, cellRight, cellBottom, cellTop;	// cells it is listed in; cellLeft > cellRight if in none
+	bool large;					// in the large list rather than in cells
+	unsigned int visitStamp;	// last query pass that tested it
+	unsigned int hitStamp;		// last query it was found by
+};
+
+// Grid cells by column and row packed into one key
+typedef std::unordered_map<long long, std::vector<int> > CellMap;
+
+// Features are listed in every cell of a uniform grid their box touches, or
+// in one list tested by every query when that would be too many cells.  Cells
+// live in a hash map, so the grid has no fixed extent.
+class HitIndex
+{
+public:
+	HitIndex() : queryStamp(0) {}
+
+	void Set(int id, int type, const double *xy, int nPoints, bool crossDateline, double radius);
+	void Remove(int id);
+	void Clear();
+
+	// The ids of the features the point hits, ascending; see QueryHitIndex
+	void Query(double x, double y, double radius, double lineDistance, std::vector<int> &ids);
+
+	int FeatureCount() const { return (int)features.size(); }
+
+private:
+	void AddToCells(int id);
+	void RemoveFromCells(int id);
+	bool Hits(const HitIndexFeature &feature, double x, double y, double lineDistance) const;
+
+	std::vector<HitIndexFeature> features;	// by id
+	CellMap cells;
+	std::vector<int> large;
+	unsigned int queryStamp;
+};
+
+// Point-in-polygon and polyline distance kernels, two lanes at a time
+
+// Even-odd test of x,y against a ring of n points whose last point repeats
+// the first, as Polygon.IsPointIn does it
+bool PointInRing(const double *px, const double *py, int n, double x, double y);
+
+// Whether any segment of the polyline passes within distance kilometers of
+// x,y, as Curve.IsPointOn decides it: the point must lie within 0.15 degrees
+// of a segment's extent and within distance of the line through it
+bool PointOnPolyline(const double *px, const double *py, int n, double x, double y, double distance);
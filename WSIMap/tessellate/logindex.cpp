@@ -0,0 +1,276 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "logindex.h"
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <thread>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LOGINDEX_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Fewest bytes worth a worker thread
+static const unsigned long long minLogBytesPerThread = 4 << 20;
+
+// The file is mapped this much at a time, so logs larger than the address
+// space of a 32-bit process can be indexed; a window grows up to the largest
+// for a longer line, and lines longer than that are left out
+static const size_t logWindowBytes = 16 << 20;
+static const size_t maxLogWindowBytes = 256 << 20;
+
+// Lines holding this are duplicates the alerting engine logged and are left out
+static const char redundantMark[] = "REDUNDANT";
+static const int redundantMarkLength = sizeof(redundantMark) - 1;
+
+struct LogLineScan
+{
+	long long base;
+	size_t lineStart;
+	long long jsonStart;	// first '{' on the line, or -1
+	bool redundant;
+};
+
+static void EndLogLine(const char *data, size_t lineEnd, LogLineScan &scan, std::vector<LogIndexEntry> &entries)
+{
+	size_t length = lineEnd - scan.lineStart;
+	if (length > 0 && data[lineEnd-1] == '\r') length--;
+	if (length > 0 && length <= INT_MAX && !scan.redundant)
+	{
+		LogIndexEntry entry;
+		entry.offset = scan.base + (long long)scan.lineStart;
+		entry.length = (int)length;
+		entry.jsonOffset = scan.jsonStart >= 0 && scan.jsonStart < (long long)(scan.lineStart + length) ? (int)(scan.jsonStart - scan.lineStart) : -1;
+		entries.push_back(entry);
+	}
+	scan.lineStart = lineEnd + 1;
+	scan.jsonStart = -1;
+	scan.redundant = false;
+}
+
+// A newline, brace or 'R' at i
+static void LogLineMark(const char *data, size_t i, size_t end, LogLineScan &scan, std::vector<LogIndexEntry> &entries)
+{
+	char c = data[i];
+	if (c == '\n')
+		EndLogLine(data, i, scan, entries);
+	else if (c == '{')
+	{
+		if (scan.jsonStart < 0) scan.jsonStart = (long long)i;
+	}
+	else if (!scan.redundant && i + redundantMarkLength <= end && memcmp(data + i, redundantMark, redundantMarkLength) == 0)
+		scan.redundant = true;
+}
+
+#ifdef LOGINDEX_SSE2
+static int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward(&bit, mask);
+	return (int)bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+void IndexLogLines(const char *data, size_t begin, size_t end, long long base, std::vector<LogIndexEntry> &entries)
+{
+	LogLineScan scan;
+	scan.base = base;
+	scan.lineStart = begin;
+	scan.jsonStart = -1;
+	scan.redundant = false;
+
+	// Only newlines, braces and the R that starts the mark matter; sixteen
+	// bytes are checked for all three at once
+	size_t i = begin;
+#ifdef LOGINDEX_SSE2
+	__m128i newline = _mm_set1_epi8('\n'), brace = _mm_set1_epi8('{'), r = _mm_set1_epi8(redundantMark[0]);
+	for (; i+16<=end; i+=16)
+	{
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+			_mm_cmpeq_epi8(chunk, brace)), _mm_cmpeq_epi8(chunk, r)));
+		while (mask != 0)
+		{
+			LogLineMark(data, i + LowestBit(mask), end, scan, entries);
+			mask &= mask - 1;
+		}
+	}
+#endif
+	for (; i<end; i++)
+	{
+		char c = data[i];
+		if (c == '\n' || c == '{' || c == redundantMark[0])
+			LogLineMark(data, i, end, scan, entries);
+	}
+	if (scan.lineStart < end)
+		EndLogLine(data, end, scan, entries);
+}
+
+// Offset just past the first newline at or after from, or the file size
+static unsigned long long NextLogLine(const FileMapping &file, unsigned long long from)
+{
+	MappedView view;
+	while (view.Map(file, from, logWindowBytes))
+	{
+		const char *newline = (const char *)memchr(view.Data(), '\n', view.Size());
+		if (newline != NULL) return from + (newline - view.Data()) + 1;
+		from += view.Size();
+	}
+	return file.Size();
+}
+
+// Index the lines in [begin, end) of the file, both on line starts, a window
+// at a time; the line running over the end of a window starts the next one
+static void IndexLogRange(const FileMapping *file, unsigned long long begin, unsigned long long end, std::vector<LogIndexEntry> *entries)
+{
+	MappedView view;
+	size_t window = logWindowBytes;
+	while (begin < end)
+	{
+		if (!view.Map(*file, begin, (size_t)std::min((unsigned long long)window, end - begin))) return;
+		const char *data = view.Data();
+		size_t n = view.Size();
+		if (begin + n < end)
+		{
+			while (n > 0 && data[n-1] != '\n') n--;
+			if (n == 0)
+			{
+				if (window < maxLogWindowBytes)
+					window *= 2;
+				else
+				{
+					window = logWindowBytes;
+					begin = NextLogLine(*file, begin + view.Size());
+				}
+				continue;
+			}
+		}
+		IndexLogLines(data, 0, n, (long long)begin, *entries);
+		begin += n;
+		window = logWindowBytes;
+	}
+}
+
+extern "C" TESSELLATE_API LogIndex* OpenLogIndex(char* fileName, int nThreads)
+{
+	LogIndex *index = new LogIndex;
+	if (!index->file.Open(fileName))
+	{
+		delete index;
+		return NULL;
+	}
+	unsigned long long size = index->file.Size();
+	unsigned long long begin = 0;
+	MappedView start;
+	if (start.Map(index->file, 0, 3) && start.Size() == 3 && memcmp(start.Data(), "\xEF\xBB\xBF", 3) == 0) begin = 3;
+	start.Unmap();
+
+	// Even slices of the file, each moved on to the start of a line, on
+	// worker threads
+	int nWork = (int)std::min((size - begin) / minLogBytesPerThread, (unsigned long long)INT_MAX);
+	nThreads = WorkerThreadCount(nThreads, nWork, 1);
+	std::vector<unsigned long long> bounds(nThreads + 1);
+	bounds[0] = begin;
+	bounds[nThreads] = size;
+	for (int t=1; t<nThreads; t++)
+		bounds[t] = NextLogLine(index->file, std::max(begin + (size - begin) / nThreads * t, bounds[t-1]));
+
+	std::vector<std::vector<LogIndexEntry> > partial(nThreads);
+	std::vector<std::thread> workers;
+	for (int t=0; t<nThreads-1; t++)
+		workers.push_back(std::thread(IndexLogRange, &index->file, bounds[t], bounds[t+1], &partial[t]));
+	IndexLogRange(&index->file, bounds[nThreads-1], bounds[nThreads], &partial[nThreads-1]);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	size_t count = 0;
+	for (int t=0; t<nThreads; t++)
+		count += partial[t].size();
+	index->entries.reserve(count);
+	for (int t=0; t<nThreads; t++)
+		index->entries.insert(index->entries.end(), partial[t].begin(), partial[t].end());
+	return index;
+}
+
+extern "C" TESSELLATE_API void CloseLogIndex(LogIndex* index)
+{
+	delete index;
+}
+
+extern "C" TESSELLATE_API int GetLogIndexEntryCount(LogIndex* index)
+{
+	return index != NULL ? (int)index->entries.size() : 0;
+}
+
+extern "C" TESSELLATE_API int GetLogIndexEntry(LogIndex* index, int entry, LogIndexEntry* result)
+{
+	if (index == NULL || entry < 0 || entry >= (int)index->entries.size()) return 0;
+	*result = index->entries[entry];
+	return 1;
+}
+
+extern "C" TESSELLATE_API int ReadLogIndexEntry(LogIndex* index, int entry, int start, char* buffer, int bufferSize)
+{
+	if (index == NULL || entry < 0 || entry >= (int)index->entries.size() || start < 0 || bufferSize <= 0) return 0;
+	const LogIndexEntry &e = index->entries[entry];
+	if (start >= e.length) return 0;
+	MappedView view;
+	if (!view.Map(index->file, (unsigned long long)e.offset + start, (size_t)std::min(e.length - start, bufferSize))) return 0;
+	memcpy(buffer, view.Data(), view.Size());
+	return (int)view.Size();
+}
+
+// length cut back so a UTF-8 sequence split by the end of text[0..length)
+// is left out whole
+static size_t Utf8Boundary(const char *text, size_t length)
+{
+	size_t lead = length;
+	while (lead > 0 && length - lead < 4 && ((unsigned char)text[lead-1] & 0xC0) == 0x80)
+		lead--;
+	if (lead == 0) return length;
+	unsigned char c = (unsigned char)text[lead-1];
+	size_t sequence = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+	return length - (lead - 1) < sequence ? lead - 1 : length;
+}
+
+extern "C" TESSELLATE_API int ReadLogIndexEntries(LogIndex* index, int first, int count, int maxLength, char* buffer, int* lengths)
+{
+	if (index == NULL || first < 0 || count <= 0 || maxLength <= 0 || first >= (int)index->entries.size()) return 0;
+	count = std::min(count, (int)index->entries.size() - first);
+
+	// Consecutive lines are close together in the file, so a page of them
+	// usually comes out of one window
+	MappedView view;
+	unsigned long long viewOffset = 0;
+	for (int i=0; i<count; i++)
+	{
+		const LogIndexEntry &e = index->entries[first + i];
+		size_t length = (size_t)std::min(e.length, maxLength);
+		unsigned long long offset = (unsigned long long)e.offset;
+		if (view.Data() == NULL || offset < viewOffset || offset + length > viewOffset + view.Size())
+		{
+			viewOffset = offset;
+			if (!view.Map(index->file, offset, std::max(length, logWindowBytes)))
+			{
+				lengths[i] = 0;
+				continue;
+			}
+		}
+		length = (size_t)std::min((unsigned long long)length, viewOffset + view.Size() - offset);
+		const char *text = view.Data() + (offset - viewOffset);
+		if (length < (size_t)e.length)
+			length = Utf8Boundary(text, length);
+		memcpy(buffer + (size_t)i * maxLength, text, length);
+		lengths[i] = (int)length;
+	}
+	return count;
+}
@@ -0,0 +1,17 @@
+// logindex.h : line index over an intersection log, mapped a window at a time.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <vector>
+#include "mappedfile.h"
+
+struct LogIndex
+{
+	FileMapping file;
+	std::vector<LogIndexEntry> entries;
+};
+
+// Add the entries of the whole lines in [begin, end) of data, which starts at
+// offset base in the file
+void IndexLogLines(const char *data, size_t begin, size_t end, long long base, std::vector<LogIndexEntry> &entries);
@@ -0,0 +1,164 @@
+#include "stdafx.h"
+#include "mappedfile.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+FileMapping::FileMapping() : size(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+{
+}
+
+bool FileMapping::Open(const char *fileName)
+{
+	Close();
+
+	file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		Close();
+		return false;
+	}
+	size = (unsigned long long)fileSize.QuadPart;
+
+	// Windows can't map an empty file
+	if (size == 0) return true;
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FileMapping::Close()
+{
+	if (mapping != NULL) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	size = 0;
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+}
+
+static unsigned long long MappingGranularity()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+}
+
+#else
+
+FileMapping::FileMapping() : size(0), fd(-1)
+{
+}
+
+bool FileMapping::Open(const char *fileName)
+{
+	Close();
+
+	fd = open(fileName, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		Close();
+		return false;
+	}
+	size = (unsigned long long)st.st_size;
+	return true;
+}
+
+void FileMapping::Close()
+{
+	if (fd >= 0) close(fd);
+	size = 0;
+	fd = -1;
+}
+
+static unsigned long long MappingGranularity()
+{
+	return (unsigned long long)sysconf(_SC_PAGESIZE);
+}
+
+#endif
+
+FileMapping::~FileMapping()
+{
+	Close();
+}
+
+MappedView::MappedView() : view(NULL), viewSize(0), data(NULL), size(0)
+{
+}
+
+bool MappedView::Map(const FileMapping &file, unsigned long long offset, size_t length)
+{
+	Unmap();
+
+	if (offset >= file.size) return false;
+	if (length > file.size - offset) length = (size_t)(file.size - offset);
+	if (length == 0) return false;
+
+	// Views start on the allocation granularity
+	unsigned long long start = offset - offset % MappingGranularity();
+	size_t skip = (size_t)(offset - start);
+	if (length > (size_t)-1 - skip) return false;
+#ifdef _WIN32
+	void *p = MapViewOfFile(file.mapping, FILE_MAP_READ, (DWORD)(start >> 32), (DWORD)start, skip + length);
+	if (p == NULL) return false;
+#else
+	void *p = mmap(NULL, skip + length, PROT_READ, MAP_SHARED, file.fd, (off_t)start);
+	if (p == MAP_FAILED) return false;
+#endif
+	view = (const char *)p;
+	viewSize = skip + length;
+	data = view + skip;
+	size = length;
+	return true;
+}
+
+void MappedView::Unmap()
+{
+#ifdef _WIN32
+	if (view != NULL) UnmapViewOfFile(view);
+#else
+	if (view != NULL) munmap((void *)view, viewSize);
+#endif
+	view = NULL;
+	viewSize = 0;
+	data = NULL;
+	size = 0;
+}
+
+MappedView::~MappedView()
+{
+	Unmap();
+}
+
+bool MappedFile::Open(const char *fileName)
+{
+	Close();
+
+	if (!file.Open(fileName) || file.Size() == 0 || file.Size() > (size_t)-1 || !view.Map(file, 0, (size_t)file.Size()))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	view.Unmap();
+	file.Close();
+}
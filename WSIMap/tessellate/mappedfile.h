@@ -0,0 +1,73 @@
+// mappedfile.h : read-only memory mapped files.
+
+#pragma once
+
+#include <stddef.h>
+
+// A file opened for mapping; views of it are taken with MappedView, so a
+// file larger than the address space can be read a window at a time
+class FileMapping
+{
+public:
+	FileMapping();
+	~FileMapping();
+
+	// Returns false if the file can't be opened; an empty file opens
+	bool Open(const char *fileName);
+	void Close();
+
+	unsigned long long Size() const { return size; }
+
+private:
+	FileMapping(const FileMapping&);
+	FileMapping& operator=(const FileMapping&);
+	friend class MappedView;
+
+	unsigned long long size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;		// NULL for an empty file
+#else
+	int fd;
+#endif
+};
+
+// The bytes [offset, offset + length) of a FileMapping
+class MappedView
+{
+public:
+	MappedView();
+	~MappedView();
+
+	// Map the window, cut short at the end of the file; returns false if it
+	// is empty or can't be mapped
+	bool Map(const FileMapping &file, unsigned long long offset, size_t length);
+	void Unmap();
+
+	const char* Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	MappedView(const MappedView&);
+	MappedView& operator=(const MappedView&);
+
+	const char *view;	// as mapped, at the allocation granularity below data
+	size_t viewSize;
+	const char *data;
+	size_t size;
+};
+
+class MappedFile
+{
+public:
+	// Map the whole file; returns false if it can't be opened or is empty
+	bool Open(const char *fileName);
+	void Close();
+
+	const char* Data() const { return view.Data(); }
+	size_t Size() const { return view.Size(); }
+
+private:
+	FileMapping file;
+	MappedView view;
+};
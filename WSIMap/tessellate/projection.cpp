@@ -0,0 +1,377 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "projection.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+void InitProjection(ProjectionParams &params, MapProjections mapProjection, double centralLongitude)
+{
+	params.mapProjection = mapProjection;
+	params.centralLongitude = centralLongitude;
+	params.lambertN = params.lambertF = params.lambertRho0 = 0;
+
+	if (mapProjection == Lambert)
+	{
+		double sp1 = lambertStdParallel1 * deg2rad;
+		double sp2 = lambertStdParallel2 * deg2rad;
+
+		double n = (log(cos(sp1) * (1.0 / cos(sp2))))
+			/ (log(tan((0.25 * pi) + (0.5 * sp2)) * (1.0 / tan((0.25 * pi) + (0.5 * sp1)))));
+		double F = (cos(sp1) * pow(tan((0.25 * pi) + (0.5 * sp1)), n)) / n;
+		params.lambertN = n;
+		params.lambertF = F;
+		params.lambertRho0 = F * pow((1.0 / tan((0.25 * pi) + (0.5 * lambertRefLat * deg2rad))), n);
+	}
+}
+
+void ProjectPointsScalar(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n)
+{
+	double centralLongitude = params.centralLongitude;
+	switch (params.mapProjection)
+	{
+	case Stereographic:
+		// Assumes a central latitude of 90 degrees
+		for (int i=0; i<n; i++)
+		{
+			double x = lon[i], y = lat[i];
+			double k = scaleFactor / (1 + sin(y * deg2rad));
+			px[i] = k * cos(y * deg2rad) * sin((x - centralLongitude) * deg2rad);
+			py[i] = -k * cos(y * deg2rad) * cos((x - centralLongitude) * deg2rad);
+		}
+		break;
+	case Orthographic:
+		// Assumes a central latitude of 90 degrees
+		for (int i=0; i<n; i++)
+		{
+			double x = lon[i], y = lat[i];
+			px[i] = scaleFactor * cos(y * deg2rad) * sin((x - centralLongitude) * deg2rad);
+			py[i] = -scaleFactor * cos(y * deg2rad) * cos((x - centralLongitude) * deg2rad);
+		}
+		break;
+	case Mercator:
+		for (int i=0; i<n; i++)
+		{
+			double y = lat[i];
+			px[i] = lon[i];
+			py[i] = 50 * log(tan(y * deg2rad) + (1 / cos(y * deg2rad)));
+		}
+		break;
+	case Lambert:
+		for (int i=0; i<n; i++)
+		{
+			double x = lon[i], y = lat[i];
+			double rho = params.lambertF * pow((1.0 / tan((0.25 * pi) + (0.5 * y * deg2rad))), params.lambertN);
+			px[i] = lambertScaleFactor * rho * sin(params.lambertN * ((x - centralLongitude) * deg2rad));
+			py[i] = params.lambertRho0 - (lambertScaleFactor * rho * cos(params.lambertN * ((x - centralLongitude) * deg2rad)));
+		}
+		break;
+	default: // CylindricalEquidistant
+		for (int i=0; i<n; i++)
+		{
+			px[i] = lon[i];
+			py[i] = lat[i];
+		}
+		break;
+	}
+}
+
+bool HasAVX2(void)
+{
+	static int hasAVX2 = -1;
+	if (hasAVX2 < 0)
+	{
+#if defined(_MSC_VER)
+		// AVX2 needs the CPU feature bit and the OS saving the YMM registers
+		int info[4];
+		__cpuid(info, 0);
+		bool avx2 = false;
+		if (info[0] >= 7)
+		{
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			__cpuidex(info, 7, 0);
+			avx2 = osxsave && avx && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+		}
+		hasAVX2 = avx2 ? 1 : 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		hasAVX2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+		hasAVX2 = 0;
+#endif
+	}
+	return hasAVX2 == 1;
+}
+
+void ProjectPointsBatch(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n)
+{
+	if (params.mapProjection != CylindricalEquidistant && HasAVX2())
+		ProjectPointsAVX2(params, lon, lat, px, py, n);
+	else
+		ProjectPointsScalar(params, lon, lat, px, py, n);
+}
+
+void ProjectInterleaved(const ProjectionParams &params, double *xy, int n)
+{
+	if (n <= 0) return;
+
+	std::vector<double> lon(n), lat(n);
+	for (int i=0; i<n; i++)
+	{
+		lon[i] = xy[i*2];
+		lat[i] = xy[i*2+1];
+	}
+	ProjectPointsBatch(params, &lon[0], &lat[0], &lon[0], &lat[0], n);
+	for (int i=0; i<n; i++)
+	{
+		xy[i*2] = lon[i];
+		xy[i*2+1] = lat[i];
+	}
+}
+
+// Longitude step of the points added along the cutoff
+static const double cutoffStep = 1.0;
+
+static inline bool AboveCutoff(const double *p)
+{
+	return p[1] > MinAzimuthalLatitude;
+}
+
+// Append the point where the segment p-q crosses the cutoff.  An end on the
+// cutoff is used as is, so crossings at a shared vertex compare equal.
+static void AddCutoffPoint(std::vector<double> &xy, const double *p, const double *q)
+{
+	double x;
+	if (p[1] == MinAzimuthalLatitude)
+		x = p[0];
+	else if (q[1] == MinAzimuthalLatitude)
+		x = q[0];
+	else
+		x = p[0] + (MinAzimuthalLatitude - p[1]) / (q[1] - p[1]) * (q[0] - p[0]);
+	xy.push_back(x);
+	xy.push_back(MinAzimuthalLatitude);
+}
+
+// Where a ring crosses the cutoff.  Crossings at the same longitude, which
+// happen where a vertex sits exactly on the cutoff, are ordered as if the
+// cutoff were a hair higher, by how far east the edge leans going up.
+struct CutoffCrossing
+{
+	double x;
+	double lean;
+
+	CutoffCrossing() : x(0), lean(0) {}
+	CutoffCrossing(const double *crossing, const double *above) : x(crossing[0]), lean((above[0] - crossing[0]) / (above[1] - crossing[1])) {}
+	bool operator<(const CutoffCrossing &other) const { return x < other.x || (x == other.x && lean < other.lean); }
+};
+
+// A stretch of a ring above the cutoff, from the point where it comes up
+// through the cutoff to the point where it goes back down
+struct CutoffRun
+{
+	int firstPoint;
+	int nPoints;
+	CutoffCrossing entry;
+	CutoffCrossing exit;
+};
+
+struct EntryLess
+{
+	const std::vector<CutoffRun> *runs;
+	bool operator()(int a, int b) const { return (*runs)[a].entry < (*runs)[b].entry; }
+};
+
+int ClipRingToHemisphere(const double *ring, int nPoints, std::vector<double> &xy, std::vector<int> &starts)
+{
+	int start = -1, nAbove = 0;
+	for (int i=0; i<nPoints; i++)
+	{
+		if (AboveCutoff(&ring[i*2]))
+			nAbove++;
+		else if (start < 0)
+			start = i;
+	}
+
+	// Rings wholly on one side cost nothing
+	if (nAbove == 0) return 0;
+	if (start < 0)
+	{
+		starts.push_back((int)(xy.size() / 2));
+		xy.insert(xy.end(), ring, ring + nPoints * 2);
+		return 1;
+	}
+
+	// Walk the ring counterclockwise from a point below the cutoff, so every
+	// run above it both starts and ends on the cutoff
+	double area = 0;
+	for (int i=0, j=nPoints-1; i<nPoints; j=i++)
+		area += ring[j*2] * ring[i*2+1] - ring[i*2] * ring[j*2+1];
+	int step = area >= 0 ? 1 : nPoints - 1;
+
+	std::vector<double> runPoints;
+	std::vector<CutoffRun> runs;
+	for (int k=0, i=start; k<nPoints; k++)
+	{
+		int j = (i + step) % nPoints;
+		const double *p = &ring[i*2], *q = &ring[j*2];
+		bool pAbove = AboveCutoff(p), qAbove = AboveCutoff(q);
+		if (!pAbove && qAbove)
+		{
+			CutoffRun run;
+			run.firstPoint = (int)(runPoints.size() / 2);
+			AddCutoffPoint(runPoints, p, q);
+			run.entry = CutoffCrossing(&runPoints[runPoints.size()-2], q);
+			runs.push_back(run);
+		}
+		if (qAbove)
+		{
+			runPoints.push_back(q[0]);
+			runPoints.push_back(q[1]);
+		}
+		else if (pAbove)
+		{
+			AddCutoffPoint(runPoints, p, q);
+			CutoffRun &run = runs.back();
+			run.exit = CutoffCrossing(&runPoints[runPoints.size()-2], p);
+			run.nPoints = (int)(runPoints.size() / 2) - run.firstPoint;
+		}
+		i = j;
+	}
+
+	// With the region above the cutoff on the left, the boundary leaving a
+	// run follows the cutoff east to the nearest run coming back up.  That
+	// pairs the runs into the separate pieces of the clipped ring.
+	int nRuns = (int)runs.size();
+	std::vector<int> byEntry(nRuns);
+	for (int r=0; r<nRuns; r++) byEntry[r] = r;
+	EntryLess entryLess = { &runs };
+	std::sort(byEntry.begin(), byEntry.end(), entryLess);
+
+	std::vector<int> next(nRuns);
+	std::vector<char> taken(nRuns, 0);
+	for (int r=0; r<nRuns; r++)
+	{
+		int s = 0;
+		while (s < nRuns && runs[byEntry[s]].entry < runs[r].exit) s++;
+		while (s < nRuns && taken[byEntry[s]]) s++;
+		if (s == nRuns)
+		{
+			// Only reached with rounding trouble or a self-intersecting ring
+			s = 0;
+			while (taken[byEntry[s]]) s++;
+		}
+		next[r] = byEntry[s];
+		taken[byEntry[s]] = 1;
+	}
+
+	int nPieces = 0;
+	std::vector<char> used(nRuns, 0);
+	for (int r0=0; r0<nRuns; r0++)
+	{
+		if (used[r0]) continue;
+		int first = (int)(xy.size() / 2);
+		for (int r=r0; !used[r]; r=next[r])
+		{
+			used[r] = 1;
+			const CutoffRun &run = runs[r];
+			xy.insert(xy.end(), runPoints.begin() + run.firstPoint * 2, runPoints.begin() + (run.firstPoint + run.nPoints) * 2);
+
+			// Follow the cutoff to the next run
+			double x0 = run.exit.x, x1 = runs[next[r]].entry.x;
+			int nSteps = (int)ceil(fabs(x1 - x0) / cutoffStep);
+			for (int k=1; k<nSteps; k++)
+			{
+				xy.push_back(x0 + (x1 - x0) * k / nSteps);
+				xy.push_back(MinAzimuthalLatitude);
+			}
+		}
+
+		if ((int)(xy.size() / 2) - first < 3)
+			xy.resize(first * 2);
+		else
+		{
+			starts.push_back(first);
+			nPieces++;
+		}
+	}
+	return nPieces;
+}
+
+int ClipLineToHemisphere(const double *line, int nPoints, std::vector<double> &xy, std::vector<int> &starts)
+{
+	int nPieces = 0;
+	int first = -1;
+	for (int i=0; i<nPoints; i++)
+	{
+		const double *q = &line[i*2];
+		bool qAbove = AboveCutoff(q);
+		bool pAbove = i > 0 && AboveCutoff(&line[(i-1)*2]);
+		if (qAbove)
+		{
+			if (first < 0)
+			{
+				first = (int)(xy.size() / 2);
+				if (i > 0)
+					AddCutoffPoint(xy, &line[(i-1)*2], q);
+			}
+			xy.push_back(q[0]);
+			xy.push_back(q[1]);
+		}
+		else if (pAbove)
+			AddCutoffPoint(xy, &line[(i-1)*2], q);
+
+		if (first >= 0 && (!qAbove || i == nPoints - 1))
+		{
+			if ((int)(xy.size() / 2) - first < 2)
+				xy.resize(first * 2);
+			else
+			{
+				starts.push_back(first);
+				nPieces++;
+			}
+			first = -1;
+		}
+	}
+	return nPieces;
+}
+
+int ClipAndProjectRing(const ProjectionParams &params, const double *ring, int nPoints, std::vector<double> &xy, std::vector<int> &starts)
+{
+	size_t firstPoint = xy.size() / 2;
+	int nPieces;
+	if (IsAzimuthal(params.mapProjection))
+		nPieces = ClipRingToHemisphere(ring, nPoints, xy, starts);
+	else
+	{
+		starts.push_back((int)firstPoint);
+		xy.insert(xy.end(), ring, ring + nPoints * 2);
+		nPieces = 1;
+	}
+
+	if (xy.size() / 2 > firstPoint)
+		ProjectInterleaved(params, &xy[firstPoint * 2], (int)(xy.size() / 2 - firstPoint));
+	return nPieces;
+}
+
+void ProjectPoint(double x, double y, MapProjections mapProjection, double centralLongitude, double *px, double *py)
+{
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	ProjectPointsScalar(params, &x, &y, px, py, 1);
+}
+
+extern "C" TESSELLATE_API void ProjectPoints(MapProjections mapProjection, double centralLongitude, const double* lon, const double* lat, double* px, double* py, int n)
+{
+	if (n <= 0) return;
+
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	ProjectPointsBatch(params, lon, lat, px, py, n);
+}
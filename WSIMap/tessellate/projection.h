@@ -0,0 +1,44 @@
+// projection.h : batch map projection with the per-projection constants
+// worked out once.  Include after stdafx.h, tessellate.h and tesscommon.h.
+
+#pragma once
+
+#include <vector>
+
+struct ProjectionParams
+{
+	MapProjections mapProjection;
+	double centralLongitude;
+	double lambertN;		// Lambert cone constant
+	double lambertF;
+	double lambertRho0;
+};
+
+void InitProjection(ProjectionParams &params, MapProjections mapProjection, double centralLongitude);
+
+// Project n points.  The scalar loop gives the same results as ProjectPoint;
+// the AVX2 loop, used when the CPU and OS support it, agrees to a few units in
+// the last place away from the poles, where both lose precision.  px and py
+// may be the lon and lat arrays.
+void ProjectPointsScalar(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n);
+void ProjectPointsAVX2(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n);
+void ProjectPointsBatch(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n);
+
+// Project n interleaved x,y points in place
+void ProjectInterleaved(const ProjectionParams &params, double *xy, int n);
+
+bool HasAVX2(void);
+
+// Clip to the part of the globe an azimuthal projection shows, the latitudes
+// above MinAzimuthalLatitude (the near hemisphere for orthographic), ahead of
+// projecting.  A ring of longitude/latitude pairs is cut into the pieces left
+// above the cutoff, closed along the cutoff with a point every degree of
+// longitude so the new edges project as arcs.  A line is cut into the runs
+// above the cutoff.  Pieces are appended to xy with the index of their first
+// point added to starts.  Both return the number of pieces.
+int ClipRingToHemisphere(const double *ring, int nPoints, std::vector<double> &xy, std::vector<int> &starts);
+int ClipLineToHemisphere(const double *line, int nPoints, std::vector<double> &xy, std::vector<int> &starts);
+
+// Clip a ring of longitude/latitude pairs for the projection, as above when it
+// is azimuthal, and project the pieces
+int ClipAndProjectRing(const ProjectionParams &params, const double *ring, int nPoints, std::vector<double> &xy, std::vector<int> &starts);
@@ -0,0 +1,214 @@
+// AVX2 projection loops.  Only called after HasAVX2() says the CPU and OS
+// support it.  The sin/cos, log and exp approximations are the Cephes
+// double precision ones, evaluated four lanes at a time.
+
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "projection.h"
+#include <math.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+namespace
+{
+	// Cephes sin.c
+	const double DP1 = 7.85398125648498535156E-1;
+	const double DP2 = 3.77489470793079817668E-8;
+	const double DP3 = 2.69515142907905952645E-15;
+	const double sinCoef[] = { 1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+		-1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1 };
+	const double cosCoef[] = { -1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7,
+		2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2 };
+
+	// Cephes log.c
+	const double logP[] = { 1.01875663804580931796E-4, 4.97494994976747001425E-1, 4.70579119878881725854E0,
+		1.44989225341610930846E1, 1.79368678507819816313E1, 7.70838733755885391666E0 };
+	const double logQ[] = { 1.12873587189167450590E1, 4.52279145837532221105E1, 8.29875266912776603211E1,
+		7.11544750618563894466E1, 2.31251620126765340583E1 };
+
+	// Cephes exp.c
+	const double expP[] = { 1.26177193074810590878E-4, 3.02994407707441961300E-2, 9.99999999999999999910E-1 };
+	const double expQ[] = { 3.00198505138664455042E-6, 2.52448340349684104192E-3, 2.27265548208155028766E-1, 2.00000000000000000009E0 };
+
+	AVX2_TARGET inline __m256d Polevl(__m256d x, const double *coef, int degree)
+	{
+		__m256d y = _mm256_set1_pd(coef[0]);
+		for (int i=1; i<=degree; i++)
+			y = _mm256_add_pd(_mm256_mul_pd(y, x), _mm256_set1_pd(coef[i]));
+		return y;
+	}
+
+	// Like Polevl with an implied leading coefficient of 1
+	AVX2_TARGET inline __m256d P1evl(__m256d x, const double *coef, int degree)
+	{
+		__m256d y = _mm256_add_pd(x, _mm256_set1_pd(coef[0]));
+		for (int i=1; i<degree; i++)
+			y = _mm256_add_pd(_mm256_mul_pd(y, x), _mm256_set1_pd(coef[i]));
+		return y;
+	}
+
+	// Widen four 32 bit lane masks to 64 bit double lane masks
+	AVX2_TARGET inline __m256d WidenMask(__m128i mask)
+	{
+		return _mm256_castsi256_pd(_mm256_cvtepi32_epi64(mask));
+	}
+
+	AVX2_TARGET inline void SinCos4(__m256d x, __m256d *s, __m256d *c)
+	{
+		const __m256d signBit = _mm256_set1_pd(-0.0);
+		__m256d sign = _mm256_and_pd(x, signBit);
+		x = _mm256_andnot_pd(signBit, x);
+
+		// Reduce to an octant; j is made even so z lands in [-pi/4, pi/4]
+		__m256d y = _mm256_floor_pd(_mm256_mul_pd(x, _mm256_set1_pd(4 / pi)));
+		__m128i j = _mm256_cvttpd_epi32(y);
+		__m128i odd = _mm_and_si128(j, _mm_set1_epi32(1));
+		j = _mm_add_epi32(j, odd);
+		y = _mm256_add_pd(y, _mm256_cvtepi32_pd(odd));
+		j = _mm_and_si128(j, _mm_set1_epi32(7));
+		__m128i upper = _mm_cmpgt_epi32(j, _mm_set1_epi32(3));
+		j = _mm_sub_epi32(j, _mm_and_si128(upper, _mm_set1_epi32(4)));
+		__m128i swap = _mm_cmpeq_epi32(j, _mm_set1_epi32(2));
+
+		__m256d z = _mm256_sub_pd(x, _mm256_mul_pd(y, _mm256_set1_pd(DP1)));
+		z = _mm256_sub_pd(z, _mm256_mul_pd(y, _mm256_set1_pd(DP2)));
+		z = _mm256_sub_pd(z, _mm256_mul_pd(y, _mm256_set1_pd(DP3)));
+		__m256d zz = _mm256_mul_pd(z, z);
+
+		__m256d polySin = _mm256_add_pd(z, _mm256_mul_pd(_mm256_mul_pd(z, zz), Polevl(zz, sinCoef, 5)));
+		__m256d polyCos = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(zz, _mm256_set1_pd(0.5)));
+		polyCos = _mm256_add_pd(polyCos, _mm256_mul_pd(_mm256_mul_pd(zz, zz), Polevl(zz, cosCoef, 5)));
+
+		__m256d upperMask = WidenMask(upper);
+		__m256d swapMask = WidenMask(swap);
+		__m256d sinSign = _mm256_xor_pd(sign, _mm256_and_pd(upperMask, signBit));
+		__m256d cosSign = _mm256_and_pd(_mm256_xor_pd(upperMask, swapMask), signBit);
+		*s = _mm256_xor_pd(_mm256_blendv_pd(polySin, polyCos, swapMask), sinSign);
+		*c = _mm256_xor_pd(_mm256_blendv_pd(polyCos, polySin, swapMask), cosSign);
+	}
+
+	// Natural log of positive, finite, normal values
+	AVX2_TARGET inline __m256d Log4(__m256d x)
+	{
+		__m256i bits = _mm256_castpd_si256(x);
+		__m256i exponent = _mm256_and_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x7ff));
+		__m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+			_mm256_set1_epi64x(0x3fe0000000000000LL)));
+
+		// The exponent converted to a double through the 2^52 trick
+		const __m256d two52 = _mm256_castsi256_pd(_mm256_set1_epi64x(0x4330000000000000LL));
+		__m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(exponent, _mm256_castpd_si256(two52))), two52);
+		e = _mm256_sub_pd(e, _mm256_set1_pd(1022));
+
+		__m256d small = _mm256_cmp_pd(m, _mm256_set1_pd(0.70710678118654752440), _CMP_LT_OQ);
+		e = _mm256_sub_pd(e, _mm256_and_pd(small, _mm256_set1_pd(1.0)));
+		x = _mm256_sub_pd(_mm256_add_pd(m, _mm256_and_pd(small, m)), _mm256_set1_pd(1.0));
+
+		__m256d z = _mm256_mul_pd(x, x);
+		__m256d y = _mm256_mul_pd(x, _mm256_div_pd(_mm256_mul_pd(z, Polevl(x, logP, 5)), P1evl(x, logQ, 5)));
+		y = _mm256_sub_pd(y, _mm256_mul_pd(e, _mm256_set1_pd(2.121944400546905827679e-4)));
+		y = _mm256_sub_pd(y, _mm256_mul_pd(z, _mm256_set1_pd(0.5)));
+		z = _mm256_add_pd(x, y);
+		return _mm256_add_pd(z, _mm256_mul_pd(e, _mm256_set1_pd(0.693359375)));
+	}
+
+	// e^x for |x| well inside the double range
+	AVX2_TARGET inline __m256d Exp4(__m256d x)
+	{
+		__m256d n = _mm256_floor_pd(_mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634073599)), _mm256_set1_pd(0.5)));
+		x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(6.93145751953125E-1)));
+		x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(1.42860682030941723212E-6)));
+
+		__m256d xx = _mm256_mul_pd(x, x);
+		__m256d px = _mm256_mul_pd(x, Polevl(xx, expP, 2));
+		x = _mm256_div_pd(px, _mm256_sub_pd(Polevl(xx, expQ, 3), px));
+		x = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_add_pd(x, x));
+
+		// Scale by 2^n
+		__m256i pow2 = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023)), 52);
+		return _mm256_mul_pd(x, _mm256_castsi256_pd(pow2));
+	}
+
+	// (1 + sin(lat)) / cos(lat), which is tan(pi/4 + lat/2)
+	AVX2_TARGET inline __m256d HalfAngleTan(__m256d sinLat, __m256d cosLat)
+	{
+		return _mm256_div_pd(_mm256_add_pd(_mm256_set1_pd(1.0), sinLat), cosLat);
+	}
+}
+
+AVX2_TARGET void ProjectPointsAVX2(const ProjectionParams &params, const double *lon, const double *lat, double *px, double *py, int n)
+{
+	const __m256d radians = _mm256_set1_pd(deg2rad);
+	const __m256d centralLongitude = _mm256_set1_pd(params.centralLongitude);
+	const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+	const __m256d maxLat = _mm256_set1_pd(90.0);
+	const __m256d maxLon = _mm256_set1_pd(1.0e6);
+
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d x = _mm256_loadu_pd(lon + i);
+		__m256d y = _mm256_loadu_pd(lat + i);
+
+		// Poles, NaNs and wild longitudes take the scalar path
+		__m256d ok = _mm256_and_pd(_mm256_cmp_pd(_mm256_and_pd(y, absMask), maxLat, _CMP_LT_OQ),
+			_mm256_cmp_pd(_mm256_and_pd(x, absMask), maxLon, _CMP_LT_OQ));
+		if (_mm256_movemask_pd(ok) != 0xf)
+		{
+			ProjectPointsScalar(params, lon + i, lat + i, px + i, py + i, 4);
+			continue;
+		}
+
+		__m256d sinLat, cosLat, sinLon, cosLon;
+		SinCos4(_mm256_mul_pd(y, radians), &sinLat, &cosLat);
+		__m256d dLon = _mm256_mul_pd(_mm256_sub_pd(x, centralLongitude), radians);
+
+		switch (params.mapProjection)
+		{
+		case Stereographic:
+		{
+			SinCos4(dLon, &sinLon, &cosLon);
+			__m256d kc = _mm256_mul_pd(_mm256_div_pd(_mm256_set1_pd(scaleFactor), _mm256_add_pd(_mm256_set1_pd(1.0), sinLat)), cosLat);
+			_mm256_storeu_pd(px + i, _mm256_mul_pd(kc, sinLon));
+			_mm256_storeu_pd(py + i, _mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(kc, cosLon)));
+			break;
+		}
+		case Orthographic:
+		{
+			SinCos4(dLon, &sinLon, &cosLon);
+			__m256d kc = _mm256_mul_pd(_mm256_set1_pd(scaleFactor), cosLat);
+			_mm256_storeu_pd(px + i, _mm256_mul_pd(kc, sinLon));
+			_mm256_storeu_pd(py + i, _mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(kc, cosLon)));
+			break;
+		}
+		case Mercator:
+			_mm256_storeu_pd(px + i, x);
+			_mm256_storeu_pd(py + i, _mm256_mul_pd(_mm256_set1_pd(50), Log4(HalfAngleTan(sinLat, cosLat))));
+			break;
+		case Lambert:
+		{
+			__m256d coneN = _mm256_set1_pd(params.lambertN);
+			__m256d rho = _mm256_mul_pd(_mm256_set1_pd(params.lambertF * lambertScaleFactor),
+				Exp4(_mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), coneN), Log4(HalfAngleTan(sinLat, cosLat)))));
+			SinCos4(_mm256_mul_pd(coneN, dLon), &sinLon, &cosLon);
+			_mm256_storeu_pd(px + i, _mm256_mul_pd(rho, sinLon));
+			_mm256_storeu_pd(py + i, _mm256_sub_pd(_mm256_set1_pd(params.lambertRho0), _mm256_mul_pd(rho, cosLon)));
+			break;
+		}
+		default:
+			_mm256_storeu_pd(px + i, x);
+			_mm256_storeu_pd(py + i, y);
+			break;
+		}
+	}
+
+	if (i < n)
+		ProjectPointsScalar(params, lon + i, lat + i, px + i, py + i, n - i);
+}
@@ -0,0 +1,125 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "rtree.h"
+#include <math.h>
+#include <algorithm>
+
+struct RTreeEntry
+{
+	RTreeBox box;
+	int child;
+};
+
+static bool ByCenterX(const RTreeEntry &a, const RTreeEntry &b)
+{
+	return a.box.left + a.box.right < b.box.left + b.box.right;
+}
+
+static bool ByCenterY(const RTreeEntry &a, const RTreeEntry &b)
+{
+	return a.box.bottom + a.box.top < b.box.bottom + b.box.top;
+}
+
+static bool Overlaps(const RTreeBox &box, const double rect[4])
+{
+	return box.left <= rect[1] && box.right >= rect[0] && box.bottom <= rect[3] && box.top >= rect[2];
+}
+
+// Sort-Tile-Recursive order for one level: vertical slices of whole nodes by
+// x, then each slice by y
+static void TileEntries(std::vector<RTreeEntry> &entries, int nodeSize)
+{
+	size_t nNodes = (entries.size() + nodeSize - 1) / nodeSize;
+	size_t nSlices = (size_t)ceil(sqrt((double)nNodes));
+	size_t sliceSize = ((nNodes + nSlices - 1) / nSlices) * nodeSize;
+
+	std::sort(entries.begin(), entries.end(), ByCenterX);
+	for (size_t s=0; s<entries.size(); s+=sliceSize)
+		std::sort(entries.begin() + s, entries.begin() + std::min(s + sliceSize, entries.size()), ByCenterY);
+}
+
+void PackedRTree::Build(const std::vector<RTreeBox> &items)
+{
+	Clear();
+	nItems = (int)items.size();
+	if (nItems == 0) return;
+
+	std::vector<RTreeEntry> level(items.size());
+	for (size_t i=0; i<items.size(); i++)
+	{
+		level[i].box = items[i];
+		level[i].child = (int)i;
+	}
+
+	// Each pass tiles one level, stores it and makes the next one up from
+	// runs of NodeSize entries
+	while (true)
+	{
+		TileEntries(level, NodeSize);
+		int levelStart = (int)boxes.size();
+		for (size_t i=0; i<level.size(); i++)
+		{
+			boxes.push_back(level[i].box);
+			children.push_back(level[i].child);
+		}
+		levelEnds.push_back((int)boxes.size());
+		if (level.size() == 1) break;
+
+		std::vector<RTreeEntry> parents;
+		parents.reserve((level.size() + NodeSize - 1) / NodeSize);
+		for (size_t i=0; i<level.size(); i+=NodeSize)
+		{
+			RTreeEntry node;
+			node.box = level[i].box;
+			node.child = levelStart + (int)i;
+			for (size_t j=i+1; j<std::min(i + NodeSize, level.size()); j++)
+			{
+				node.box.left = std::min(node.box.left, level[j].box.left);
+				node.box.right = std::max(node.box.right, level[j].box.right);
+				node.box.bottom = std::min(node.box.bottom, level[j].box.bottom);
+				node.box.top = std::max(node.box.top, level[j].box.top);
+			}
+			parents.push_back(node);
+		}
+		level.swap(parents);
+	}
+}
+
+void PackedRTree::Clear()
+{
+	nItems = 0;
+	boxes.clear();
+	children.clear();
+	levelEnds.clear();
+}
+
+void PackedRTree::Query(const double rect[4], std::vector<int> &items) const
+{
+	if (boxes.empty()) return;
+	size_t firstFound = items.size();
+
+	// Nodes to visit, with the level each lies on
+	std::vector<std::pair<int,int> > stack;
+	int root = (int)boxes.size() - 1;
+	if (Overlaps(boxes[root], rect))
+		stack.push_back(std::make_pair(root, (int)levelEnds.size() - 1));
+	while (!stack.empty())
+	{
+		int node = stack.back().first;
+		int depth = stack.back().second;
+		stack.pop_back();
+		if (depth == 0)
+		{
+			items.push_back(children[node]);
+			continue;
+		}
+
+		int first = children[node];
+		int last = std::min(first + (int)NodeSize, levelEnds[depth-1]);
+		for (int c=first; c<last; c++)
+			if (Overlaps(boxes[c], rect))
+				stack.push_back(std::make_pair(c, depth - 1));
+	}
+
+	std::sort(items.begin() + firstFound, items.end());
+}
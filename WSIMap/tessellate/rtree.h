@@ -0,0 +1,47 @@
+// rtree.h : a packed, read only R-tree over rectangles.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <vector>
+
+struct RTreeBox
+{
+	double left, right, bottom, top;
+};
+
+// Built once from all its boxes with Sort-Tile-Recursive packing: the boxes
+// are sorted into vertical slices by x, each slice by y, and cut into full
+// nodes, and the same is done to the nodes until one is left.  Every node but
+// the last of each level is full and the whole tree lives in two arrays.
+class PackedRTree
+{
+public:
+	PackedRTree() : nItems(0) {}
+
+	// Replace the tree with one over boxes; item numbers are positions in it
+	void Build(const std::vector<RTreeBox> &boxes);
+	void Clear();
+
+	// Append the numbers of the items whose boxes meet rect (left, right,
+	// bottom, top), in ascending order
+	void Query(const double rect[4], std::vector<int> &items) const;
+
+	int ItemCount() const { return nItems; }
+
+	// The box around every item; false if there are none
+	bool Bounds(RTreeBox &box) const
+	{
+		if (boxes.empty()) return false;
+		box = boxes.back();
+		return true;
+	}
+
+private:
+	enum { NodeSize = 16 };
+
+	int nItems;
+	std::vector<RTreeBox> boxes;	// items in packed order, then each level of nodes
+	std::vector<int> children;		// item number for items, first child for nodes
+	std::vector<int> levelEnds;		// end of each level in boxes, leaves first
+};
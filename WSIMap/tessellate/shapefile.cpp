@@ -0,0 +1,128 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "shapefile.h"
+#include <string.h>
+#include <string>
+
+static const int shapeFileCode = 9994;
+static const size_t headerSize = 100;
+static const size_t polyHeaderSize = 44;	// type, box, part and point counts
+
+static int BigEndianInt(const char *p)
+{
+	const unsigned char *b = (const unsigned char *)p;
+	return (int)(((unsigned int)b[0] << 24) | ((unsigned int)b[1] << 16) | ((unsigned int)b[2] << 8) | b[3]);
+}
+
+static int LittleEndianInt(const char *p)
+{
+	int value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+// fileName with its three letter extension replaced, in the same case
+static std::string SiblingFile(const char *fileName, const char *extension)
+{
+	std::string name(fileName);
+	if (name.size() < 4 || name[name.size()-4] != '.') return std::string();
+	bool upper = name[name.size()-3] >= 'A' && name[name.size()-3] <= 'Z';
+	for (int i=0; i<3; i++)
+		name[name.size()-3+i] = upper ? (char)(extension[i] - 'a' + 'A') : extension[i];
+	return name;
+}
+
+bool ShapeFile::Open(const char *fileName)
+{
+	Close();
+
+	std::string shxName = SiblingFile(fileName, "shx");
+	if (shxName.empty() || !shp.Open(fileName) || !shx.Open(shxName.c_str()))
+	{
+		Close();
+		return false;
+	}
+	if (shp.Size() < headerSize || shx.Size() < headerSize ||
+		BigEndianInt(shp.Data()) != shapeFileCode || BigEndianInt(shx.Data()) != shapeFileCode)
+	{
+		Close();
+		return false;
+	}
+	shapeType = LittleEndianInt(shp.Data() + 32);
+	nRecords = (int)((shx.Size() - headerSize) / 8);
+
+	// The .dbf is optional; without it no record counts as deleted
+	std::string dbfName = SiblingFile(fileName, "dbf");
+	if (dbf.Open(dbfName.c_str()) && dbf.Size() >= 32)
+	{
+		const unsigned char *h = (const unsigned char *)dbf.Data();
+		int nDbf = h[4] | (h[5] << 8) | (h[6] << 16) | (h[7] << 24);
+		size_t headerLength = h[8] | (h[9] << 8);
+		size_t recordLength = h[10] | (h[11] << 8);
+		if (nDbf > 0 && recordLength > 0 && headerLength + (size_t)nDbf * recordLength <= dbf.Size())
+		{
+			dbfRecords = dbf.Data() + headerLength;
+			dbfRecordSize = recordLength;
+			nDbfRecords = nDbf;
+		}
+	}
+	return true;
+}
+
+void ShapeFile::Close()
+{
+	shp.Close();
+	shx.Close();
+	dbf.Close();
+	nRecords = 0;
+	shapeType = ShapeNull;
+	dbfRecords = NULL;
+	dbfRecordSize = 0;
+	nDbfRecords = 0;
+}
+
+unsigned long long ShapeFile::RecordOffset(int i) const
+{
+	return (unsigned long long)(unsigned int)BigEndianInt(shx.Data() + headerSize + (size_t)i * 8) * 2;
+}
+
+bool ShapeFile::IsDeleted(int i) const
+{
+	return i < nDbfRecords && dbfRecords[(size_t)i * dbfRecordSize] == '*';
+}
+
+bool ShapeFile::Record(int i, ShapeRecord &record) const
+{
+	record.shapeType = ShapeNull;
+	record.nParts = 0;
+	record.parts = NULL;
+	record.nPoints = 0;
+	record.points = NULL;
+	if (i < 0 || i >= nRecords) return false;
+
+	// Record header: number and content length in 16 bit words, big-endian.
+	// Sizes are worked out in 64 bits, since a damaged header can make them
+	// overflow a 32 bit size_t; anything that passes lies inside the mapping.
+	unsigned long long offset = RecordOffset(i);
+	if (offset < headerSize || offset + 12 > shp.Size()) return false;
+	const char *header = shp.Data() + (size_t)offset;
+	unsigned long long contentLength = (unsigned long long)(unsigned int)BigEndianInt(header + 4) * 2;
+	const char *content = header + 8;
+	if (contentLength < 4 || contentLength > shp.Size() - offset - 8) return false;
+
+	record.shapeType = LittleEndianInt(content);
+	if (!IsPolyShape(record.shapeType)) return true;
+	if (contentLength < polyHeaderSize) return false;
+
+	int nParts = LittleEndianInt(content + 36);
+	int nPoints = LittleEndianInt(content + 40);
+	if (nParts < 0 || nPoints < 0 ||
+		polyHeaderSize + (unsigned long long)nParts * 4 + (unsigned long long)nPoints * 16 > contentLength)
+		return false;
+
+	record.nParts = nParts;
+	record.parts = (const int *)(content + polyHeaderSize);
+	record.nPoints = nPoints;
+	record.points = (const double *)(content + polyHeaderSize + (size_t)nParts * 4);
+	return true;
+}
@@ -0,0 +1,80 @@
+// shapefile.h : memory mapped ESRI shapefile reader.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include "mappedfile.h"
+
+// Shape types from the ESRI shapefile specification
+enum ShapeType
+{
+	ShapeNull = 0,
+	ShapePolyLine = 3, ShapePolygon = 5,
+	ShapePolyLineZ = 13, ShapePolygonZ = 15,
+	ShapePolyLineM = 23, ShapePolygonM = 25
+};
+
+// One record, pointing straight into the mapped .shp.  Parts and points are
+// little-endian as in the file and, since records are only aligned to two
+// bytes, are read with memcpy.  Records of other shape types (points,
+// multipoints, patches) come back with no parts.
+struct ShapeRecord
+{
+	int shapeType;			// ShapeNull or the file's shape type
+	int nParts;
+	const int *parts;		// first point of each part
+	int nPoints;
+	const double *points;	// x,y pairs; Z and M values are not exposed
+};
+
+// The .shp and .shx (and the .dbf, if there is one, for deleted records) of a
+// shapefile mapped read only.  Records are found through the .shx offsets, so
+// any range of them can be read from any thread.
+class ShapeFile
+{
+public:
+	ShapeFile() : nRecords(0), shapeType(ShapeNull), dbfRecords(NULL), dbfRecordSize(0), nDbfRecords(0) {}
+
+	// Map fileName (the .shp) and the .shx beside it; false if either is
+	// missing or their headers are not a shapefile's
+	bool Open(const char *fileName);
+	void Close();
+
+	int RecordCount() const { return nRecords; }
+	int GetShapeType() const { return shapeType; }
+
+	// Read record i; false if the record lies outside the file or its counts
+	// do not fit in it
+	bool Record(int i, ShapeRecord &record) const;
+
+	// Records deleted in the .dbf, which OGR skips
+	bool IsDeleted(int i) const;
+
+	// Offset of record i in the .shp, for splitting records into runs of
+	// roughly the same size
+	unsigned long long RecordOffset(int i) const;
+
+private:
+	ShapeFile(const ShapeFile&);
+	ShapeFile& operator=(const ShapeFile&);
+
+	MappedFile shp, shx, dbf;
+	int nRecords;
+	int shapeType;
+	const char *dbfRecords;
+	size_t dbfRecordSize;
+	int nDbfRecords;
+};
+
+// True for the types whose records are parts of x,y points
+inline bool IsPolyShape(int shapeType)
+{
+	return shapeType == ShapePolyLine || shapeType == ShapePolygon ||
+		shapeType == ShapePolyLineZ || shapeType == ShapePolygonZ ||
+		shapeType == ShapePolyLineM || shapeType == ShapePolygonM;
+}
+
+inline bool IsPolygonShape(int shapeType)
+{
+	return shapeType == ShapePolygon || shapeType == ShapePolygonZ || shapeType == ShapePolygonM;
+}
@@ -0,0 +1,321 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "vectorfile.h"
+#include "simplify.h"
+#include <math.h>
+#include <string.h>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+// Squared distance from p to the segment a-b
+static double SegmentDistance2(const double *p, const double *a, const double *b)
+{
+	double dx = b[0] - a[0], dy = b[1] - a[1];
+	double len2 = dx * dx + dy * dy;
+	double t = len2 > 0 ? ((p[0] - a[0]) * dx + (p[1] - a[1]) * dy) / len2 : 0;
+	if (t < 0) t = 0;
+	else if (t > 1) t = 1;
+	double ex = a[0] + t * dx - p[0], ey = a[1] + t * dy - p[1];
+	return ex * ex + ey * ey;
+}
+
+void DouglasPeucker(const double *xy, int first, int last, double tolerance, std::vector<char> &keep)
+{
+	keep[first] = 1;
+	keep[last] = 1;
+
+	double tolerance2 = tolerance * tolerance;
+	std::vector<int> stack;
+	stack.push_back(first);
+	stack.push_back(last);
+	while (!stack.empty())
+	{
+		int b = stack.back(); stack.pop_back();
+		int a = stack.back(); stack.pop_back();
+
+		double maxDist2 = 0;
+		int index = -1;
+		for (int i=a+1; i<b; i++)
+		{
+			double d2 = SegmentDistance2(&xy[i*2], &xy[a*2], &xy[b*2]);
+			if (d2 > maxDist2)
+			{
+				maxDist2 = d2;
+				index = i;
+			}
+		}
+
+		if (index >= 0 && maxDist2 > tolerance2)
+		{
+			keep[index] = 1;
+			stack.push_back(a);
+			stack.push_back(index);
+			stack.push_back(index);
+			stack.push_back(b);
+		}
+	}
+}
+
+static double TriangleArea(const double *a, const double *b, const double *c)
+{
+	return fabs((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1])) / 2;
+}
+
+namespace
+{
+	struct AreaEntry
+	{
+		double area;
+		int index;
+		int version;	// stale once the point's area has been recomputed
+		bool operator<(const AreaEntry &other) const { return area > other.area; }	// smallest on top
+	};
+}
+
+void Visvalingam(const double *xy, int first, int last, double minArea, std::vector<char> &keep)
+{
+	for (int i=first; i<=last; i++)
+		keep[i] = 1;
+	if (last - first < 2) return;
+
+	int n = last - first + 1;
+	std::vector<int> prev(n), next(n), version(n, 0);
+	std::priority_queue<AreaEntry> heap;
+	for (int i=0; i<n; i++)
+	{
+		prev[i] = i - 1;
+		next[i] = i + 1;
+		if (i > 0 && i < n - 1)
+		{
+			AreaEntry entry = { TriangleArea(&xy[(first+i-1)*2], &xy[(first+i)*2], &xy[(first+i+1)*2]), i, 0 };
+			heap.push(entry);
+		}
+	}
+
+	double lastArea = 0;
+	while (!heap.empty())
+	{
+		AreaEntry entry = heap.top();
+		heap.pop();
+		if (entry.version != version[entry.index]) continue;
+		if (entry.area >= minArea) break;
+
+		// Remove the point and link its neighbors
+		int i = entry.index;
+		keep[first + i] = 0;
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		lastArea = entry.area;
+
+		// A neighbor's area never drops below the area just removed, so
+		// points are eliminated in order of significance
+		int neighbors[2] = { prev[i], next[i] };
+		for (int k=0; k<2; k++)
+		{
+			int j = neighbors[k];
+			if (j <= 0 || j >= n - 1) continue;
+			double area = TriangleArea(&xy[(first+prev[j])*2], &xy[(first+j)*2], &xy[(first+next[j])*2]);
+			AreaEntry updated = { area > lastArea ? area : lastArea, j, ++version[j] };
+			heap.push(updated);
+		}
+	}
+}
+
+namespace
+{
+	struct PointKey
+	{
+		double x, y;
+		bool operator==(const PointKey &other) const { return x == other.x && y == other.y; }
+	};
+
+	struct PointKeyHash
+	{
+		size_t operator()(const PointKey &key) const
+		{
+			unsigned long long bx, by;
+			memcpy(&bx, &key.x, sizeof(bx));
+			memcpy(&by, &key.y, sizeof(by));
+			unsigned long long h = bx * 0x9E3779B97F4A7C15ULL ^ (by + 0x632BE59BD9B4E019ULL + (bx << 6) + (bx >> 2));
+			return (size_t)(h ^ (h >> 32));
+		}
+	};
+
+	struct PointUse
+	{
+		int nRings;		// number of distinct rings the point is in
+		int lastRing;
+		bool isStart;	// some ring starts (and ends) at the point
+	};
+}
+
+void SimplifyRingSet(const RingSet &src, double tolerance, int minPoints, RingSet &dst)
+{
+	dst.xy.clear();
+	dst.rings.clear();
+	dst.nFeatures = src.nFeatures;
+	if (src.rings.empty()) return;
+
+	// Count the rings each point appears in, and note where rings start
+	std::unordered_map<PointKey, PointUse, PointKeyHash> uses;
+	uses.reserve(src.xy.size() / 2);
+	for (size_t r=0; r<src.rings.size(); r++)
+	{
+		const TessRing &ring = src.rings[r];
+		for (int i=0; i<ring.nPoints; i++)
+		{
+			PointKey key = { src.xy[(ring.firstPoint + i) * 2], src.xy[(ring.firstPoint + i) * 2 + 1] };
+			PointUse &use = uses[key];
+			if (use.nRings == 0 || use.lastRing != (int)r)
+			{
+				use.nRings++;
+				use.lastRing = (int)r;
+			}
+			if (i == 0)
+				use.isStart = true;
+		}
+	}
+
+	dst.xy.reserve(src.xy.size() / 2);
+	dst.rings.reserve(src.rings.size());
+	std::vector<int> count;
+	std::vector<char> pinned, keep;
+	for (size_t r=0; r<src.rings.size(); r++)
+	{
+		const TessRing &ring = src.rings[r];
+		const double *xy = &src.xy[ring.firstPoint * 2];
+		int n = ring.nPoints;
+
+		count.resize(n);
+		pinned.resize(n);
+		for (int i=0; i<n; i++)
+		{
+			PointKey key = { xy[i*2], xy[i*2+1] };
+			const PointUse &use = uses[key];
+			count[i] = use.nRings;
+			pinned[i] = use.isStart;
+		}
+
+		// Anchor the ring ends, junctions and the ends of shared runs, then
+		// simplify each arc between anchors.  A ring that starts partway
+		// along a shared run keeps its start, so every ring sharing the run
+		// keeps that point too.
+		keep.assign(n, 0);
+		int anchor = 0;
+		for (int i=1; i<n; i++)
+		{
+			bool isAnchor = i == n - 1 || pinned[i] || count[i] >= 3 || count[i] != count[i-1] || count[i] != count[i+1];
+			if (isAnchor)
+			{
+				DouglasPeucker(xy, anchor, i, tolerance, keep);
+				anchor = i;
+			}
+		}
+
+		int nKept = 0;
+		double minX = xy[0], maxX = xy[0], minY = xy[1], maxY = xy[1];
+		for (int i=0; i<n; i++)
+		{
+			nKept += keep[i];
+			if (xy[i*2] < minX) minX = xy[i*2];
+			if (xy[i*2] > maxX) maxX = xy[i*2];
+			if (xy[i*2+1] < minY) minY = xy[i*2+1];
+			if (xy[i*2+1] > maxY) maxY = xy[i*2+1];
+		}
+		if (nKept < minPoints)
+		{
+			if (maxX - minX < tolerance && maxY - minY < tolerance)
+				continue;
+			keep.assign(n, 1);
+		}
+
+		TessRing out = ring;
+		out.firstPoint = (int)(dst.xy.size() / 2);
+		for (int i=0; i<n; i++)
+		{
+			if (!keep[i]) continue;
+			dst.xy.push_back(xy[i*2]);
+			dst.xy.push_back(xy[i*2+1]);
+		}
+		out.nPoints = (int)(dst.xy.size() / 2) - out.firstPoint;
+		dst.rings.push_back(out);
+	}
+}
+
+static void SimplifyPolylineRun(const double *xy, const int *offsets, int firstPolyline, int endPolyline, double tolerance, int method, char *keepFlags)
+{
+	std::vector<char> keep;
+	for (int p=firstPolyline; p<endPolyline; p++)
+	{
+		int first = offsets[p], n = offsets[p+1] - offsets[p];
+		if (n <= 0) continue;
+		if (n < 3)
+		{
+			memset(keepFlags + first, 1, n);
+			continue;
+		}
+
+		keep.assign(n, 0);
+		if (method == SimplifyVisvalingam)
+			Visvalingam(xy + first * 2, 0, n - 1, tolerance, keep);
+		else
+			DouglasPeucker(xy + first * 2, 0, n - 1, tolerance, keep);
+		memcpy(keepFlags + first, &keep[0], n);
+	}
+}
+
+// Polylines with fewer points than this in total are simplified serially
+static const int minSimplifyPointsPerThread = 50000;
+
+extern "C" TESSELLATE_API int SimplifyPolyline(double xy[], int nPoints, double tolerance, int method, int keptIndices[])
+{
+	int offsets[2] = { 0, nPoints };
+	int keptOffsets[2];
+	return SimplifyPolylines(xy, offsets, 1, tolerance, method, keptIndices, keptOffsets, 1);
+}
+
+extern "C" TESSELLATE_API int SimplifyPolylines(double xy[], int offsets[], int nPolylines, double tolerance, int method, int keptIndices[], int keptOffsets[], int nThreads)
+{
+	if (nPolylines < 1) return 0;
+
+	int nPoints = offsets[nPolylines];
+	std::vector<char> keepFlags(nPoints > 0 ? nPoints : 1, 0);
+
+	// Mark the points to keep, spreading runs of polylines over threads
+	nThreads = WorkerThreadCount(nThreads, nPoints, minSimplifyPointsPerThread);
+	if (nThreads > nPolylines) nThreads = nPolylines;
+	if (nThreads <= 1)
+		SimplifyPolylineRun(xy, offsets, 0, nPolylines, tolerance, method, &keepFlags[0]);
+	else
+	{
+		std::vector<std::thread> workers;
+		int run = 0, firstPolyline = 0;
+		for (int p=0; p<nPolylines && run<nThreads-1; p++)
+		{
+			if ((double)offsets[p+1] >= (double)nPoints * (run + 1) / nThreads)
+			{
+				workers.push_back(std::thread(SimplifyPolylineRun, xy, offsets, firstPolyline, p + 1, tolerance, method, &keepFlags[0]));
+				firstPolyline = p + 1;
+				run++;
+			}
+		}
+		SimplifyPolylineRun(xy, offsets, firstPolyline, nPolylines, tolerance, method, &keepFlags[0]);
+		for (size_t t=0; t<workers.size(); t++)
+			workers[t].join();
+	}
+
+	// Gather the indices of the kept points
+	int nKept = 0;
+	for (int p=0; p<nPolylines; p++)
+	{
+		keptOffsets[p] = nKept;
+		for (int i=offsets[p]; i<offsets[p+1]; i++)
+			if (keepFlags[i])
+				keptIndices[nKept++] = i;
+	}
+	keptOffsets[nPolylines] = nKept;
+	return nKept;
+}
@@ -0,0 +1,27 @@
+// simplify.h : line and ring simplification.
+// Include after stdafx.h, tessellate.h and vectorfile.h.
+
+#pragma once
+
+#include <vector>
+
+// Douglas-Peucker simplification of the points first..last (inclusive) of an
+// interleaved x,y array.  keep[first] and keep[last] are set, along with every
+// point needed to stay within tolerance of the original line.
+void DouglasPeucker(const double *xy, int first, int last, double tolerance, std::vector<char> &keep);
+
+// Visvalingam-Whyatt simplification of the points first..last (inclusive).
+// Interior points are removed smallest effective area first until every
+// remaining point forms a triangle of at least minArea with its neighbors.
+void Visvalingam(const double *xy, int first, int last, double minArea, std::vector<char> &keep);
+
+// Simplify every ring of src into dst, preserving the boundaries rings share.
+// A point that appears in more than one ring is shared; the ends of each run
+// of shared points, any point where three or more rings meet and the point
+// each ring starts at (in every ring it appears in) are never removed, and
+// the arcs between them are simplified independently.  A border two polygons
+// have in common therefore simplifies to the same points in both and no gaps
+// or overlaps open up between neighbors.  Rings left with fewer than
+// minPoints points are dropped if they are smaller than the tolerance and
+// kept at full detail otherwise.
+void SimplifyRingSet(const RingSet &src, double tolerance, int minPoints, RingSet &dst);
@@ -6,8 +6,11 @@
 #pragma once
 
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#define NOMINMAX				// Keep min/max macros away from std::min/std::max
 // Windows Header Files:
 #include <windows.h>
+#endif
 
 // TODO: reference additional headers your program requires here
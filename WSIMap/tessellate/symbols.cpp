@@ -0,0 +1,837 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "tessresult.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Built-in symbol outlines, x,y pairs in symbol units.  Rings are filled with
+// the odd winding rule; an optional border is drawn as a white line loop.
+
+static const double planeOutline[] =
+{
+	4, 3,
+	28, -7,
+	28, -2,
+	4, 14,
+	3, 23,
+	2, 26,
+	0, 29,
+	-2, 26,
+	-3, 23,
+	-4, 14,
+	-28, -2,
+	-28, -7,
+	-4, 3,
+	-2, -20,
+	-8, -24,
+	-8, -27,
+	0, -24,
+	8, -27,
+	8, -24,
+	2, -20,
+};
+
+static const double planeBorder[] =
+{
+	4.5, 2.5,
+	28.5, -7.5,
+	28.5, -1.5,
+	4.5, 14,
+	3.5, 23,
+	2.5, 26,
+	0, 29.5,
+	-2.5, 26,
+	-3.5, 23,
+	-4.5, 14,
+	-28.5, -1.5,
+	-28.5, -7.5,
+	-4.5, 2.5,
+	-2.5, -20,
+	-8.5, -23.5,
+	-8.5, -27.5,
+	0, -24.5,
+	8.5, -27.5,
+	8.5, -23.5,
+	2.5, -20,
+};
+
+static const double bell206Outline[] =
+{
+	0, 28.5,
+	1, 28,
+	2, 27.5,
+	3, 26.5,
+	4, 25,
+	4.5, 23,
+	4.5, 15,
+	21.5, 31,
+	24, 29,
+	4.5, 10,
+	4.5, 6,
+	24, -12,
+	21.5, -15,
+	3, 2,
+	2.75, 1,
+	2.5, 0,
+	2.25, -1,
+	2, -2,
+	1.75, -3,
+	1.5, -4,
+	1.25, -5,
+	1, -6,
+	1, -12,
+	6, -12,
+	6, -15,
+	1, -15,
+	1, -29,
+	-1, -29,
+	-1, -15,
+	-6, -15,
+	-6, -12,
+	-1, -12,
+	-1, -6,
+	-1.25, -5,
+	-1.5, -4,
+	-1.75, -3,
+	-2, -2,
+	-2.25, -1,
+	-2.5, 0,
+	-2.75, 1,
+	-21.5, -15,
+	-24, -12,
+	-4.5, 6,
+	-4.5, 10,
+	-24, 29,
+	-21.5, 31,
+	-4.5, 15,
+	-4.5, 23,
+	-4, 25,
+	-3, 26.5,
+	-2, 27.5,
+	-1, 28,
+};
+
+static const double b737Outline[] =
+{
+	0, 30.5,
+	0.5, 30,
+	1, 28.5,
+	1.5, 27.5,
+	2, 26,
+	2.5, 23.5,
+	3, 21,
+	3.5, 18,
+	4, 15,
+	3.75, 9.5,
+	8.75, 6,
+	8.75, 8,
+	11, 8,
+	11.75, 4.25,
+	28, -4,
+	28.75, -7,
+	28, -7.75,
+	11, -3,
+	4, -3,
+	4, -6,
+	3.75, -9,
+	3.5, -11,
+	3.25, -13,
+	3, -15,
+	2.75, -17,
+	2.5, -18,
+	2.25, -19,
+	2, -20,
+	2, -21,
+	10.75, -27,
+	11.5, -28,
+	11, -30,
+	1, -28,
+	0, -28.5,
+	-1, -28,
+	-11, -30,
+	-11.5, -28,
+	-10.75, -27,
+	-2, -21,
+	-2, -20,
+	-2.25, -19,
+	-2.5, -18,
+	-2.75, -17,
+	-3, -15,
+	-3.25, -13,
+	-3.5, -11,
+	-3.75, -9,
+	-4, -6,
+	-4, -3,
+	-11, -3,
+	-28, -7.75,
+	-28.75, -7,
+	-28, -4,
+	-11.75, 4.25,
+	-11, 8,
+	-8.75, 8,
+	-8.75, 6,
+	-3.75, 9.5,
+	-4, 15,
+	-3.5, 18,
+	-3, 21,
+	-2.5, 23.5,
+	-2, 26,
+	-1.5, 27.5,
+	-1, 28.5,
+	-0.5, 30,
+};
+
+static const double b747Outline[] =
+{
+	0, 31.5,
+	0.5, 31,
+	1, 30,
+	1.5, 28.5,
+	2, 27,
+	2.5, 24.5,
+	3, 22,
+	3, 13,
+	9, 7,
+	9, 8,
+	8.5, 8,
+	8.5, 10.5,
+	11, 10.5,
+	11, 8,
+	10.5, 8,
+	10.5, 6,
+	19, -0.5,
+	19, 0.5,
+	18.5, 0.5,
+	18.5, 3,
+	21, 3,
+	21, 0.5,
+	20.5, 0.5,
+	20.5, -1.5,
+	28, -8,
+	28, -13,
+	12, -2,
+	3, -0.25,
+	3, -14,
+	2.5, -16,
+	2, -19,
+	1.75, -22,
+	10, -29,
+	10, -31.5,
+	1, -28.5,
+	0, -32,
+	-0, -32,
+	-1, -28.5,
+	-10, -31.5,
+	-10, -29,
+	-1.75, -22,
+	-2, -19,
+	-2.5, -16,
+	-3, -14,
+	-3, -0.25,
+	-12, -2,
+	-28, -13,
+	-28, -8,
+	-20.5, -1.5,
+	-20.5, 0.5,
+	-21, 0.5,
+	-21, 3,
+	-18.5, 3,
+	-18.5, 0.5,
+	-19, 0.5,
+	-19, -0.5,
+	-10.5, 6,
+	-10.5, 8,
+	-11, 8,
+	-11, 10.5,
+	-8.5, 10.5,
+	-8.5, 8,
+	-9, 8,
+	-9, 7,
+	-3, 13,
+	-3, 22,
+	-2.5, 24.5,
+	-2, 27,
+	-1.5, 28.5,
+	-1, 30,
+	-0.5, 31,
+};
+
+static const double c172Outline[] =
+{
+	0, 21,
+	0.5, 19.5,
+	2, 19,
+	2.25, 18,
+	2.5, 16,
+	2.75, 15,
+	3, 13,
+	3, 11,
+	14, 11,
+	29, 9.5,
+	29, 4,
+	15, 2.25,
+	3, 2.25,
+	1, -13.5,
+	9, -15,
+	9, -18.5,
+	1, -20,
+	0.5, -18.5,
+	0, -19.5,
+	-0.5, -18.5,
+	-1, -20,
+	-9, -18.5,
+	-9, -15,
+	-1, -13.5,
+	-3, 2.25,
+	-15, 2.25,
+	-29, 4,
+	-29, 9.5,
+	-14, 11,
+	-3, 11,
+	-3, 13,
+	-2.75, 15,
+	-2.5, 16,
+	-2.25, 18,
+	-2, 19,
+	-0.5, 19.5,
+};
+
+static const double learJetOutline[] =
+{
+	0, 25.25,
+	0.5, 25,
+	1, 24.75,
+	1.25, 24,
+	1.5, 23.5,
+	1.75, 23,
+	2, 22,
+	2, 9.25,
+	24, -8,
+	25.75, -11,
+	23, -9,
+	8, -2.5,
+	2, -2.5,
+	2, -5.5,
+	5, -5.5,
+	5.25, -8,
+	5, -10,
+	4.75, -14,
+	4.5, -14.5,
+	1, -15.5,
+	0.75, -17,
+	8.5, -24,
+	8.5, -26,
+	0, -22.5,
+	-8.5, -26,
+	-8.5, -24,
+	-0.75, -17,
+	-1, -15.5,
+	-4.5, -14.5,
+	-4.75, -14,
+	-5, -10,
+	-5.25, -8,
+	-5, -5.5,
+	-2, -5.5,
+	-2, -2.5,
+	-8, -2.5,
+	-23, -9,
+	-25.75, -11,
+	-24, -8,
+	-2, 9.25,
+	-2, 22,
+	-1.75, 23,
+	-1.5, 23.5,
+	-1.25, 24,
+	-1, 24.75,
+	-0.5, 25,
+};
+
+static const double saabOutline[] =
+{
+	0, 26.5,
+	0.5, 26,
+	1, 25.5,
+	1.5, 25,
+	2, 24,
+	2.5, 23,
+	2.75, 21,
+	3, 20,
+	3, 6,
+	7.5, 5.5,
+	8, 11,
+	9, 12,
+	10, 11,
+	10.5, 5,
+	28, 3,
+	28.5, 2.5,
+	29, 2,
+	29, 0,
+	3, -1.5,
+	3, -16,
+	2.25, -17,
+	11, -18.75,
+	12, -19.25,
+	12.5, -20,
+	12.5, -22,
+	1.5, -23,
+	1.25, -24,
+	1, -25,
+	0.5, -26,
+	0, -26.5,
+	-0.5, -26,
+	-1, -25,
+	-1.25, -24,
+	-1.5, -23,
+	-12.5, -22,
+	-12.5, -20,
+	-12, -19.25,
+	-11, -18.75,
+	-2.25, -17,
+	-3, -16,
+	-3, -1.5,
+	-29, 0,
+	-29, 2,
+	-28.5, 2.5,
+	-28, 3,
+	-11.5, 5,
+	-11, 11,
+	-10, 12,
+	-9, 11,
+	-8.5, 5.5,
+	-3, 6,
+	-3, 20,
+	-2.75, 21,
+	-2.5, 23,
+	-2, 24,
+	-1.5, 25,
+	-1, 25.5,
+	-0.5, 26,
+};
+
+static const double triangleOutline[] =
+{
+	0, 15,
+	-15, -15,
+	15, -15,
+};
+
+static const double circleOutline[] =
+{
+	15.000000, 0.000000,
+	14.488887, 3.882286,
+	12.990381, 7.500000,
+	10.606602, 10.606602,
+	7.500000, 12.990381,
+	3.882285, 14.488887,
+	-0.000000, 15.000000,
+	-3.882286, 14.488887,
+	-7.500000, 12.990381,
+	-10.606602, 10.606601,
+	-12.990381, 7.499999,
+	-14.488888, 3.882285,
+	-15.000000, -0.000001,
+	-14.488887, -3.882286,
+	-12.990381, -7.500001,
+	-10.606601, -10.606602,
+	-7.499999, -12.990382,
+	-3.882285, -14.488888,
+	0.000001, -15.000000,
+	3.882287, -14.488887,
+	7.500001, -12.990380,
+	10.606603, -10.606601,
+	12.990382, -7.499999,
+	14.488888, -3.882284,
+};
+
+static const double squareOutline[] =
+{
+	15, -15,
+	15, 15,
+	-15, 15,
+	-15, -15,
+};
+
+static const double arrowOutline[] =
+{
+	0, 30,
+	-12, 5,
+	-3, 5,
+	-3, -30,
+	3, -30,
+	3, 5,
+	12, 5,
+};
+
+static const double shiftedArrowOutline[] =
+{
+	0, 60,
+	-12, 35,
+	-3, 35,
+	-3, 0,
+	3, 0,
+	3, 35,
+	12, 35,
+};
+
+struct SymbolDefinition
+{
+	int id;
+	const char *name;
+	const double *outline;
+	int nPoints;
+	const double *border;
+	int nBorderPoints;
+	double fillDepthNear;		// near end of glDepthRange while filling
+};
+
+#define SYMBOL_POINTS(a) (int)(sizeof(a) / sizeof(a[0]) / 2)
+
+static const SymbolDefinition symbolTable[] =
+{
+	{ PlaneSymbol,			"Plane",		planeOutline,		SYMBOL_POINTS(planeOutline),		NULL,			0,								0.0 },
+	{ OutlinedPlaneSymbol,	"OutlinedPlane",planeOutline,		SYMBOL_POINTS(planeOutline),		planeBorder,	SYMBOL_POINTS(planeBorder),		0.0 },
+	{ Bell206Symbol,		"Bell206",		bell206Outline,		SYMBOL_POINTS(bell206Outline),		NULL,			0,								0.0 },
+	{ B737Symbol,			"737",			b737Outline,		SYMBOL_POINTS(b737Outline),			NULL,			0,								0.0 },
+	{ B747Symbol,			"747",			b747Outline,		SYMBOL_POINTS(b747Outline),			NULL,			0,								0.0 },
+	{ C172Symbol,			"C172",			c172Outline,		SYMBOL_POINTS(c172Outline),			NULL,			0,								0.0 },
+	{ LearJetSymbol,		"LearJet",		learJetOutline,		SYMBOL_POINTS(learJetOutline),		NULL,			0,								0.0 },
+	{ SAABSymbol,			"SAAB",			saabOutline,		SYMBOL_POINTS(saabOutline),			NULL,			0,								0.0 },
+	{ TriangleSymbol,		"Triangle",		triangleOutline,	SYMBOL_POINTS(triangleOutline),		NULL,			0,								0.0 },
+	{ CircleSymbol,			"Circle",		circleOutline,		SYMBOL_POINTS(circleOutline),		NULL,			0,								0.1 },
+	{ SquareSymbol,			"Square",		squareOutline,		SYMBOL_POINTS(squareOutline),		NULL,			0,								0.0 },
+	{ ArrowSymbol,			"Arrow",		arrowOutline,		SYMBOL_POINTS(arrowOutline),		NULL,			0,								0.0 },
+	{ ShiftedArrowSymbol,	"ShiftedArrow",	shiftedArrowOutline,SYMBOL_POINTS(shiftedArrowOutline),	NULL,			0,								0.0 }
+};
+
+// A registered symbol.  firstIndex/indexCount locate its triangles in the
+// shared index array, firstBorderVertex/nBorderVertices its border in the
+// shared vertex array.
+struct SymbolEntry
+{
+	int id;
+	std::string name;
+	std::vector<double> outline;
+	std::vector<double> border;
+	double fillDepthNear;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	int firstBorderVertex;
+	int nBorderVertices;
+};
+
+// All symbols tessellated into one vertex and index buffer.  The buffer is
+// rebuilt the next time it is used after a symbol is registered, which
+// invalidates pointers returned by GetSymbolVertices and GetSymbolIndices.
+class SymbolRegistry
+{
+public:
+	SymbolRegistry() : dirty(true)
+	{
+		for (size_t i=0; i<sizeof(symbolTable)/sizeof(symbolTable[0]); i++)
+		{
+			const SymbolDefinition &def = symbolTable[i];
+			Register(def.id, def.name, def.outline, def.nPoints, def.border, def.nBorderPoints, def.fillDepthNear);
+		}
+	}
+
+	bool Register(int id, const char *name, const double *xy, int nPoints, const double *borderXY, int nBorderPoints, double fillDepthNear)
+	{
+		if (nPoints < 3 || xy == NULL) return false;
+
+		SymbolEntry *entry = Find(id);
+		if (entry == NULL)
+		{
+			entries.push_back(SymbolEntry());
+			entry = &entries.back();
+		}
+		entry->id = id;
+		entry->name = name != NULL ? name : "";
+		entry->outline.assign(xy, xy + nPoints * 2);
+		if (borderXY != NULL && nBorderPoints > 1)
+			entry->border.assign(borderXY, borderXY + nBorderPoints * 2);
+		else
+			entry->border.clear();
+		entry->fillDepthNear = fillDepthNear;
+		dirty = true;
+		return true;
+	}
+
+	SymbolEntry* Find(int id)
+	{
+		for (size_t i=0; i<entries.size(); i++)
+			if (entries[i].id == id)
+				return &entries[i];
+		return NULL;
+	}
+
+	int FindByName(const char *name) const
+	{
+		for (size_t i=0; i<entries.size(); i++)
+			if (entries[i].name == name)
+				return entries[i].id;
+		return -1;
+	}
+
+	const TessResult& Buffer()
+	{
+		if (dirty) Build();
+		return buffer;
+	}
+
+private:
+	void Build()
+	{
+		buffer.vertices.clear();
+		buffer.indices.clear();
+		buffer.ranges.clear();
+
+		TessRecorder recorder(&buffer);
+		for (size_t i=0; i<entries.size(); i++)
+		{
+			SymbolEntry &entry = entries[i];
+			entry.firstIndex = (unsigned int)buffer.indices.size();
+			recorder.AddRing(&entry.outline[0], (int)entry.outline.size() / 2, entry.id, 0);
+			entry.indexCount = (unsigned int)buffer.indices.size() - entry.firstIndex;
+
+			// Borders live in the same vertex array, after the symbol's fill
+			entry.firstBorderVertex = (int)(buffer.vertices.size() / 2);
+			entry.nBorderVertices = (int)entry.border.size() / 2;
+			buffer.vertices.insert(buffer.vertices.end(), entry.border.begin(), entry.border.end());
+		}
+		dirty = false;
+	}
+
+	std::vector<SymbolEntry> entries;
+	TessResult buffer;
+	bool dirty;
+};
+
+static SymbolRegistry& Registry()
+{
+	static SymbolRegistry registry;
+	return registry;
+}
+
+extern "C" TESSELLATE_API int RegisterSymbol(int id, char* name, double xy[], int nPoints, double borderXY[], int nBorderPoints)
+{
+	return Registry().Register(id, name, xy, nPoints, borderXY, nBorderPoints, 0.0) ? 1 : 0;
+}
+
+extern "C" TESSELLATE_API int LoadSymbolFile(char* fileName)
+{
+	// The file holds any number of symbols:
+	//
+	//   # comment
+	//   symbol <id> <name>
+	//   <x> <y>          outline points, one per line
+	//   border
+	//   <x> <y>          optional border points
+	//   end
+	FILE *fp = OpenFile(fileName, "r");
+	if (fp == NULL) return 0;
+
+	int nLoaded = 0;
+	int id = 0;
+	char name[64];
+	bool inSymbol = false, inBorder = false;
+	std::vector<double> outline, border;
+	char line[256];
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		double x, y;
+		if (line[0] == '#')
+			continue;
+		else if (sscanf(line, " symbol %d %63s", &id, name) == 2)
+		{
+			inSymbol = true;
+			inBorder = false;
+			outline.clear();
+			border.clear();
+		}
+		else if (!inSymbol)
+			continue;
+		else if (strncmp(line, "border", 6) == 0)
+			inBorder = true;
+		else if (strncmp(line, "end", 3) == 0)
+		{
+			if (outline.size() >= 6 && Registry().Register(id, name, &outline[0], (int)outline.size() / 2,
+					border.empty() ? NULL : &border[0], (int)border.size() / 2, 0.0))
+				nLoaded++;
+			inSymbol = false;
+		}
+		else if (sscanf(line, "%lf %lf", &x, &y) == 2)
+		{
+			std::vector<double> &points = inBorder ? border : outline;
+			points.push_back(x);
+			points.push_back(y);
+		}
+	}
+	fclose(fp);
+
+	return nLoaded;
+}
+
+extern "C" TESSELLATE_API int FindSymbol(char* name)
+{
+	if (name == NULL) return -1;
+	return Registry().FindByName(name);
+}
+
+extern "C" TESSELLATE_API int GetSymbolRange(int id, unsigned int* firstIndex, unsigned int* indexCount, int* firstBorderVertex, int* nBorderVertices)
+{
+	Registry().Buffer();
+	const SymbolEntry *entry = Registry().Find(id);
+	if (entry == NULL) return 0;
+
+	if (firstIndex != NULL) *firstIndex = entry->firstIndex;
+	if (indexCount != NULL) *indexCount = entry->indexCount;
+	if (firstBorderVertex != NULL) *firstBorderVertex = entry->firstBorderVertex;
+	if (nBorderVertices != NULL) *nBorderVertices = entry->nBorderVertices;
+	return 1;
+}
+
+extern "C" TESSELLATE_API int GetSymbolVertexCount(void)
+{
+	return (int)(Registry().Buffer().vertices.size() / 2);
+}
+
+extern "C" TESSELLATE_API const double* GetSymbolVertices(void)
+{
+	const TessResult &buffer = Registry().Buffer();
+	return buffer.vertices.empty() ? NULL : &buffer.vertices[0];
+}
+
+extern "C" TESSELLATE_API int GetSymbolIndexCount(void)
+{
+	return (int)Registry().Buffer().indices.size();
+}
+
+extern "C" TESSELLATE_API const unsigned int* GetSymbolIndices(void)
+{
+	const TessResult &buffer = Registry().Buffer();
+	return buffer.indices.empty() ? NULL : &buffer.indices[0];
+}
+
+extern "C" TESSELLATE_API void BeginSymbols(void)
+{
+	const TessResult &buffer = Registry().Buffer();
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &buffer.vertices[0]);
+}
+
+extern "C" TESSELLATE_API int DrawSymbol(int id)
+{
+	const TessResult &buffer = Registry().Buffer();
+	const SymbolEntry *entry = Registry().Find(id);
+	if (entry == NULL) return 0;
+
+	// Fill in the current color
+	if (entry->fillDepthNear != 0.0)
+		glDepthRange(entry->fillDepthNear, 1.0);
+	glDrawElements(GL_TRIANGLES, entry->indexCount, GL_UNSIGNED_INT, &buffer.indices[entry->firstIndex]);
+	if (entry->fillDepthNear != 0.0)
+		glDepthRange(0.0, 1.0);
+
+	// Draw a white border around the symbol
+	if (entry->nBorderVertices > 0)
+	{
+		glDepthRange(0.0,0.9);
+		glColor3f(1,1,1);
+		glLineWidth(1);
+		glDrawArrays(GL_LINE_LOOP, entry->firstBorderVertex, entry->nBorderVertices);
+		glDepthRange(0.0,1.0);
+	}
+	return 1;
+}
+
+extern "C" TESSELLATE_API void EndSymbols(void)
+{
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+extern "C" TESSELLATE_API int CreateSymbolDisplayList(int id)
+{
+	if (Registry().Find(id) == NULL) return 0;
+
+	// Vertex arrays are read when the list is compiled, so the list keeps
+	// working after the shared buffer is rebuilt
+	int displayList = glGenLists(1);
+	glNewList(displayList, GL_COMPILE);
+	BeginSymbols();
+	DrawSymbol(id);
+	EndSymbols();
+	glEndList();
+
+	return displayList;
+}
+
+// The original per-symbol entry points, now backed by the registry
+
+extern "C" TESSELLATE_API int TessellatePlaneSymbol(void)
+{
+	return CreateSymbolDisplayList(PlaneSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateOutlinedPlaneSymbol(void)
+{
+	return CreateSymbolDisplayList(OutlinedPlaneSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateBell206Symbol(void)
+{
+	return CreateSymbolDisplayList(Bell206Symbol);
+}
+
+extern "C" TESSELLATE_API int Tessellate737Symbol(void)
+{
+	return CreateSymbolDisplayList(B737Symbol);
+}
+
+extern "C" TESSELLATE_API int Tessellate747Symbol(void)
+{
+	return CreateSymbolDisplayList(B747Symbol);
+}
+
+extern "C" TESSELLATE_API int TessellateC172Symbol(void)
+{
+	return CreateSymbolDisplayList(C172Symbol);
+}
+
+extern "C" TESSELLATE_API int TessellateLearJetSymbol(void)
+{
+	return CreateSymbolDisplayList(LearJetSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateSAABSymbol(void)
+{
+	return CreateSymbolDisplayList(SAABSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateTriangleSymbol(void)
+{
+	return CreateSymbolDisplayList(TriangleSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateCircleSymbol(void)
+{
+	return CreateSymbolDisplayList(CircleSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateSquareSymbol(void)
+{
+	return CreateSymbolDisplayList(SquareSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateArrowSymbol(void)
+{
+	return CreateSymbolDisplayList(ArrowSymbol);
+}
+
+extern "C" TESSELLATE_API int TessellateShiftedArrowSymbol(void)
+{
+	return CreateSymbolDisplayList(ShiftedArrowSymbol);
+}
@@ -0,0 +1,81 @@
+// tessbundle.cpp : packs vector files into a basemap bundle at build time.
+//
+//   tessbundle [-lods n] [-tolerance degrees] [-projection name]...
+//              [-central longitude] bundle.wbnd file.shp...
+//
+// Each -projection adds a precomputed variant; without any, only the
+// longitude/latitude triangulation is stored.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "tessellate.h"
+
+static const char *projectionNames[] = { "CylindricalEquidistant", "Stereographic", "Orthographic", "Mercator", "Lambert" };
+
+static bool SameName(const char *a, const char *b)
+{
+	for (; *a && *b; a++, b++)
+		if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+	return *a == *b;
+}
+
+static int Usage()
+{
+	fprintf(stderr, "usage: tessbundle [-lods n] [-tolerance degrees] [-projection name]... [-central longitude] bundle.wbnd file.shp...\n");
+	fprintf(stderr, "projections:");
+	for (int p=0; p<(int)(sizeof(projectionNames) / sizeof(projectionNames[0])); p++)
+		fprintf(stderr, " %s", projectionNames[p]);
+	fprintf(stderr, "\n");
+	return 2;
+}
+
+int main(int argc, char *argv[])
+{
+	// The defaults VectorFile.cs loads basemaps with
+	int nLods = 4;
+	double baseTolerance = 0.02;
+	double centralLongitude = -90;
+	std::vector<MapProjections> projections;
+
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if (arg + 1 >= argc) return Usage();
+		if (strcmp(argv[arg], "-lods") == 0)
+			nLods = atoi(argv[++arg]);
+		else if (strcmp(argv[arg], "-tolerance") == 0)
+			baseTolerance = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-central") == 0)
+			centralLongitude = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-projection") == 0)
+		{
+			const char *name = argv[++arg];
+			int p = 0;
+			while (p < (int)(sizeof(projectionNames) / sizeof(projectionNames[0])) && !SameName(name, projectionNames[p]))
+				p++;
+			if (p == (int)(sizeof(projectionNames) / sizeof(projectionNames[0])))
+			{
+				fprintf(stderr, "tessbundle: unknown projection %s\n", name);
+				return Usage();
+			}
+			projections.push_back((MapProjections)p);
+		}
+		else
+			return Usage();
+	}
+	if (argc - arg < 2) return Usage();
+
+	char *bundleFileName = argv[arg];
+	std::vector<char*> vectorFileNames(argv + arg + 1, argv + argc);
+	if (!WriteVectorBundle(bundleFileName, &vectorFileNames[0], (int)vectorFileNames.size(), nLods, baseTolerance,
+		projections.empty() ? NULL : &projections[0], (int)projections.size(), centralLongitude))
+	{
+		fprintf(stderr, "tessbundle: could not write %s\n", bundleFileName);
+		return 1;
+	}
+	printf("%s: %d files, %d levels, %d projections\n", bundleFileName, (int)vectorFileNames.size(), nLods, (int)projections.size());
+	return 0;
+}
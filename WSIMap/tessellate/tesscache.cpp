@@ -0,0 +1,319 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "tessresult.h"
+#include "tesscache.h"
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+bool IsValidTessCacheHeader(const TessCacheHeader &h, uint64_t fileSize)
+{
+	if (fileSize < sizeof(TessCacheHeader)) return false;
+	if (h.magic != TESSCACHE_MAGIC || h.version != TESSCACHE_VERSION) return false;
+	if (h.primitive != GL_TRIANGLES || h.indexCount % 3 != 0) return false;
+	return TessCacheFileSize(h) == fileSize;
+}
+
+bool IsValidTessCache(const char *data, size_t fileSize)
+{
+	if (fileSize < sizeof(TessCacheHeader)) return false;
+	const TessCacheHeader &h = *(const TessCacheHeader *)data;
+	if (!IsValidTessCacheHeader(h, fileSize)) return false;
+
+	const TessCacheRange *ranges = (const TessCacheRange *)(data + (size_t)TessCacheRangesOffset(h));
+	for (uint32_t r=0; r<h.rangeCount; r++)
+	{
+		if ((uint64_t)ranges[r].firstIndex + ranges[r].indexCount > h.indexCount)
+			return false;
+	}
+
+	const uint32_t *indices = (const uint32_t *)(data + (size_t)TessCacheIndicesOffset(h));
+	for (uint32_t i=0; i<h.indexCount; i++)
+	{
+		if (indices[i] >= h.vertexCount)
+			return false;
+	}
+	return true;
+}
+
+extern "C" TESSELLATE_API int WriteTessCache(TessResult* result, char* fileName, int flags)
+{
+	if (result == NULL) return 0;
+
+	size_t nVertices = result->vertices.size() / 2;
+	const double *v = nVertices > 0 ? &result->vertices[0] : NULL;
+
+	TessCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = TESSCACHE_MAGIC;
+	header.version = TESSCACHE_VERSION;
+	header.flags = flags & TESSCACHE_QUANTIZED;
+	header.primitive = GL_TRIANGLES;
+	header.rangeCount = (uint32_t)result->ranges.size();
+	header.vertexCount = (uint32_t)nVertices;
+	header.indexCount = (uint32_t)result->indices.size();
+	header.scaleX = header.scaleY = 1;
+
+	// Quantize against the bounds of all the vertices
+	if (header.flags & TESSCACHE_QUANTIZED)
+	{
+		double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+		for (size_t i=0; i<nVertices; i++)
+		{
+			if (v[i*2] < minX) minX = v[i*2];
+			if (v[i*2] > maxX) maxX = v[i*2];
+			if (v[i*2+1] < minY) minY = v[i*2+1];
+			if (v[i*2+1] > maxY) maxY = v[i*2+1];
+		}
+		header.offsetX = nVertices > 0 ? minX : 0;
+		header.offsetY = nVertices > 0 ? minY : 0;
+		header.scaleX = maxX > minX ? (maxX - minX) / 65535. : 1;
+		header.scaleY = maxY > minY ? (maxY - minY) / 65535. : 1;
+	}
+
+	FILE *f = OpenFile(fileName, "wb");
+	if (f == NULL) return 0;
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+	// Range table, with the bounds of each range's triangles
+	for (size_t r=0; ok && r<result->ranges.size(); r++)
+	{
+		const TessRange &range = result->ranges[r];
+		TessCacheRange entry;
+		entry.feature = range.feature;
+		entry.ring = range.ring;
+		entry.firstIndex = range.firstIndex;
+		entry.indexCount = range.indexCount;
+		double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+		for (unsigned int i=range.firstIndex; i<range.firstIndex+range.indexCount; i++)
+		{
+			const double *p = v + result->indices[i] * 2;
+			if (p[0] < minX) minX = p[0];
+			if (p[0] > maxX) maxX = p[0];
+			if (p[1] < minY) minY = p[1];
+			if (p[1] > maxY) maxY = p[1];
+		}
+		entry.minX = (float)minX;
+		entry.minY = (float)minY;
+		entry.maxX = (float)maxX;
+		entry.maxY = (float)maxY;
+		ok = fwrite(&entry, sizeof(entry), 1, f) == 1;
+	}
+
+	// Vertices, converted in blocks to keep the number of writes down
+	const size_t blockSize = 4096;
+	if (header.flags & TESSCACHE_QUANTIZED)
+	{
+		uint16_t block[blockSize * 2];
+		for (size_t i=0; ok && i<nVertices; i+=blockSize)
+		{
+			size_t n = nVertices - i < blockSize ? nVertices - i : blockSize;
+			for (size_t j=0; j<n; j++)
+			{
+				block[j*2] = (uint16_t)floor((v[(i+j)*2] - header.offsetX) / header.scaleX + 0.5);
+				block[j*2+1] = (uint16_t)floor((v[(i+j)*2+1] - header.offsetY) / header.scaleY + 0.5);
+			}
+			ok = fwrite(block, sizeof(uint16_t) * 2, n, f) == n;
+		}
+	}
+	else
+	{
+		float block[blockSize * 2];
+		for (size_t i=0; ok && i<nVertices; i+=blockSize)
+		{
+			size_t n = nVertices - i < blockSize ? nVertices - i : blockSize;
+			for (size_t j=0; j<n*2; j++)
+				block[j] = (float)v[i*2+j];
+			ok = fwrite(block, sizeof(float) * 2, n, f) == n;
+		}
+	}
+	size_t padding = (size_t)TessCacheVertexBytes(header) - nVertices * ((header.flags & TESSCACHE_QUANTIZED) ? 4 : 8);
+	if (ok && padding > 0)
+	{
+		const char zeros[4] = { 0, 0, 0, 0 };
+		ok = fwrite(zeros, 1, padding, f) == padding;
+	}
+
+	// Indices
+	if (ok && header.indexCount > 0)
+		ok = fwrite(&result->indices[0], sizeof(uint32_t), header.indexCount, f) == header.indexCount;
+
+	fclose(f);
+	return ok ? 1 : 0;
+}
+
+extern "C" TESSELLATE_API TessResult* LoadTessCache(char* fileName)
+{
+	FILE *f = OpenFile(fileName, "rb");
+	if (f == NULL) return NULL;
+
+	// Read the whole file with one call; it is parsed in memory
+	fseek(f, 0, SEEK_END);
+	long fileSize = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	std::vector<char> data(fileSize > 0 ? fileSize : 1);
+	bool ok = fileSize > 0 && fread(&data[0], 1, fileSize, f) == (size_t)fileSize;
+	fclose(f);
+	if (!ok) return NULL;
+
+	if (!IsValidTessCache(&data[0], (size_t)fileSize)) return NULL;
+	const TessCacheHeader &header = *(const TessCacheHeader *)&data[0];
+
+	TessResult *result = new TessResult;
+
+	const TessCacheRange *ranges = (const TessCacheRange *)&data[(size_t)TessCacheRangesOffset(header)];
+	result->ranges.resize(header.rangeCount);
+	for (uint32_t r=0; r<header.rangeCount; r++)
+	{
+		result->ranges[r].feature = ranges[r].feature;
+		result->ranges[r].ring = ranges[r].ring;
+		result->ranges[r].firstIndex = ranges[r].firstIndex;
+		result->ranges[r].indexCount = ranges[r].indexCount;
+	}
+
+	result->vertices.resize(header.vertexCount * 2);
+	if (header.flags & TESSCACHE_QUANTIZED)
+	{
+		const uint16_t *q = (const uint16_t *)&data[(size_t)TessCacheVerticesOffset(header)];
+		for (uint32_t i=0; i<header.vertexCount; i++)
+		{
+			result->vertices[i*2] = header.offsetX + q[i*2] * header.scaleX;
+			result->vertices[i*2+1] = header.offsetY + q[i*2+1] * header.scaleY;
+		}
+	}
+	else
+	{
+		const float *p = (const float *)&data[(size_t)TessCacheVerticesOffset(header)];
+		for (uint32_t i=0; i<header.vertexCount*2; i++)
+			result->vertices[i] = p[i];
+	}
+
+	const uint32_t *indices = (const uint32_t *)&data[(size_t)TessCacheIndicesOffset(header)];
+	result->indices.assign(indices, indices + header.indexCount);
+	return result;
+}
+
+extern "C" TESSELLATE_API TessCacheMap* OpenTessCache(char* fileName)
+{
+	TessCacheMap *cache = new TessCacheMap;
+	if (!cache->file.Open(fileName) || !IsValidTessCache(cache->file.Data(), cache->file.Size()))
+	{
+		delete cache;
+		return NULL;
+	}
+
+	// Nothing is copied; the sections are used where they sit in the mapping,
+	// and were checked above so drawing them stays inside it
+	const char *data = cache->file.Data();
+	cache->header = (const TessCacheHeader *)data;
+	cache->ranges = (const TessCacheRange *)(data + (size_t)TessCacheRangesOffset(*cache->header));
+	cache->vertices = data + (size_t)TessCacheVerticesOffset(*cache->header);
+	cache->indices = (const uint32_t *)(data + (size_t)TessCacheIndicesOffset(*cache->header));
+	return cache;
+}
+
+extern "C" TESSELLATE_API void CloseTessCache(TessCacheMap* cache)
+{
+	delete cache;
+}
+
+extern "C" TESSELLATE_API int GetTessCacheFlags(TessCacheMap* cache)
+{
+	return cache != NULL ? (int)cache->header->flags : 0;
+}
+
+extern "C" TESSELLATE_API void GetTessCacheQuantization(TessCacheMap* cache, double* offsetX, double* offsetY, double* scaleX, double* scaleY)
+{
+	if (cache == NULL) return;
+	*offsetX = cache->header->offsetX;
+	*offsetY = cache->header->offsetY;
+	*scaleX = cache->header->scaleX;
+	*scaleY = cache->header->scaleY;
+}
+
+extern "C" TESSELLATE_API int GetTessCacheVertexCount(TessCacheMap* cache)
+{
+	return cache != NULL ? (int)cache->header->vertexCount : 0;
+}
+
+extern "C" TESSELLATE_API const void* GetTessCacheVertices(TessCacheMap* cache)
+{
+	return cache != NULL ? cache->vertices : NULL;
+}
+
+extern "C" TESSELLATE_API int GetTessCacheIndexCount(TessCacheMap* cache)
+{
+	return cache != NULL ? (int)cache->header->indexCount : 0;
+}
+
+extern "C" TESSELLATE_API const unsigned int* GetTessCacheIndices(TessCacheMap* cache)
+{
+	return cache != NULL ? (const unsigned int *)cache->indices : NULL;
+}
+
+extern "C" TESSELLATE_API int GetTessCacheRangeCount(TessCacheMap* cache)
+{
+	return cache != NULL ? (int)cache->header->rangeCount : 0;
+}
+
+extern "C" TESSELLATE_API const TessCacheRange* GetTessCacheRanges(TessCacheMap* cache)
+{
+	return cache != NULL ? cache->ranges : NULL;
+}
+
+extern "C" TESSELLATE_API void DrawTessCache(TessCacheMap* cache, int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity)
+{
+	if (cache == NULL || cache->header->indexCount == 0) return;
+	const TessCacheHeader &header = *cache->header;
+
+	// Some OpenGL initialization
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glShadeModel(GL_FLAT);
+
+	// The arrays are read straight out of the mapping.  Quantized vertices are
+	// decoded by the modelview matrix.
+	bool quantized = (header.flags & TESSCACHE_QUANTIZED) != 0;
+	if (quantized)
+	{
+		glPushMatrix();
+		glTranslated(header.offsetX, header.offsetY, 0);
+		glScaled(header.scaleX, header.scaleY, 1);
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, quantized ? GL_UNSIGNED_SHORT : GL_FLOAT, 0, cache->vertices);
+
+	if (!useTwoColors)
+	{
+		glColor4f(((float)fillColorRGB[0])/255., ((float)fillColorRGB[1])/255., ((float)fillColorRGB[2])/255., ((float)opacity)/100.);
+		glDrawElements(GL_TRIANGLES, header.indexCount, GL_UNSIGNED_INT, cache->indices);
+	}
+	else
+	{
+		// Outer rings get the first color, inner rings the second.  Consecutive
+		// ranges with the same color are drawn with one call.
+		uint32_t r = 0;
+		while (r < header.rangeCount)
+		{
+			bool inner = cache->ranges[r].ring > 0;
+			uint32_t firstIndex = cache->ranges[r].firstIndex;
+			uint32_t indexCount = 0;
+			while (r < header.rangeCount && (cache->ranges[r].ring > 0) == inner &&
+				cache->ranges[r].firstIndex == firstIndex + indexCount)
+			{
+				indexCount += cache->ranges[r].indexCount;
+				r++;
+			}
+			const int *rgb = inner ? fillColor2RGB : fillColorRGB;
+			glColor4f(((float)rgb[0])/255., ((float)rgb[1])/255., ((float)rgb[2])/255., ((float)opacity)/100.);
+			glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, cache->indices + firstIndex);
+		}
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (quantized)
+		glPopMatrix();
+}
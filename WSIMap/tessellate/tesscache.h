@@ -0,0 +1,92 @@
+// tesscache.h : binary triangle cache file layout.
+//
+// A cache file holds one TessResult.  All values are little-endian and every
+// section is 4-byte aligned so the file can be used in place once mapped:
+//
+//   TessCacheHeader                  64 bytes
+//   TessCacheRange[rangeCount]       32 bytes each, one per tessellated ring
+//   vertices[vertexCount]            float x,y pairs, or uint16 x,y pairs if
+//                                    TESSCACHE_QUANTIZED is set (padded to 4)
+//   indices[indexCount]              uint32, three per triangle
+//
+// Quantized coordinates decode as offset + q * scale.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mappedfile.h"
+
+#define TESSCACHE_MAGIC		0x49525457	// "WTRI"
+#define TESSCACHE_VERSION	1
+
+// Header flags (also accepted by WriteTessCache)
+#define TESSCACHE_QUANTIZED	0x0001		// 16 bit coordinates instead of float
+
+struct TessCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t flags;
+	uint32_t primitive;			// always GL_TRIANGLES
+	uint32_t rangeCount;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t reserved;
+	double offsetX, offsetY;	// quantization origin
+	double scaleX, scaleY;		// quantization step
+};
+
+struct TessCacheRange
+{
+	int32_t feature;
+	int32_t ring;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float minX, minY, maxX, maxY;	// bounds of the range's triangles
+};
+
+// Byte offsets of the sections that follow the header, in 64 bits so counts
+// from a damaged header can't wrap them around
+inline uint64_t TessCacheRangesOffset(const TessCacheHeader &)
+{
+	return sizeof(TessCacheHeader);
+}
+
+inline uint64_t TessCacheVerticesOffset(const TessCacheHeader &h)
+{
+	return TessCacheRangesOffset(h) + (uint64_t)h.rangeCount * sizeof(TessCacheRange);
+}
+
+inline uint64_t TessCacheVertexBytes(const TessCacheHeader &h)
+{
+	uint64_t bytes = (uint64_t)h.vertexCount * ((h.flags & TESSCACHE_QUANTIZED) ? 2 * sizeof(uint16_t) : 2 * sizeof(float));
+	return (bytes + 3) & ~(uint64_t)3;
+}
+
+inline uint64_t TessCacheIndicesOffset(const TessCacheHeader &h)
+{
+	return TessCacheVerticesOffset(h) + TessCacheVertexBytes(h);
+}
+
+inline uint64_t TessCacheFileSize(const TessCacheHeader &h)
+{
+	return TessCacheIndicesOffset(h) + (uint64_t)h.indexCount * sizeof(uint32_t);
+}
+
+// Checks a header read from a file of fileSize bytes
+bool IsValidTessCacheHeader(const TessCacheHeader &h, uint64_t fileSize);
+
+// Checks a whole cache file of fileSize bytes at data: its header, that every
+// range lies within the index array and that every index names a vertex
+bool IsValidTessCache(const char *data, size_t fileSize);
+
+// A cache file mapped into memory; the pointers point into the mapping
+struct TessCacheMap
+{
+	MappedFile file;
+	const TessCacheHeader *header;
+	const TessCacheRange *ranges;
+	const void *vertices;		// float or uint16_t x,y pairs
+	const uint32_t *indices;
+};
@@ -0,0 +1,41 @@
+// tesscommon.h : declarations shared by the source files of the tessellate DLL.
+// Include after stdafx.h, tessellate.h and glut.h.
+
+#pragma once
+
+#include <stdio.h>
+
+typedef void (CALLBACK *GluTessCallbackType)();
+
+double const pi = 3.14159265358979323846;
+double const MinAzimuthalLatitude = 0.0;
+double const deg2rad = pi / 180.;
+double const scaleFactor = 90;
+double const lambertRefLat = 40;
+double const lambertStdParallel1 = 33;
+double const lambertStdParallel2 = 45;
+double const lambertScaleFactor = 46;
+
+inline bool IsAzimuthal(MapProjections mapProjection)
+{
+	return (mapProjection == Stereographic || mapProjection == Orthographic || mapProjection == Lambert);
+}
+
+// fopen_s where the CRT has it, fopen elsewhere
+inline FILE* OpenFile(const char *fileName, const char *mode)
+{
+#ifdef _MSC_VER
+	FILE *f = NULL;
+	fopen_s(&f, fileName, mode);
+	return f;
+#else
+	return fopen(fileName, mode);
+#endif
+}
+
+void ProjectPoint(double x, double y, MapProjections mapProjection, double centralLongitude, double *px, double *py);
+
+// Number of worker threads to spread nWork units over: nThreads, or the count
+// set with SetTessellateThreadCount when that is 0, limited so each thread
+// gets at least minWorkPerThread units.  Returns at least 1.
+int WorkerThreadCount(int nThreads, int nWork, int minWorkPerThread);
@@ -4,7 +4,9 @@
 // that uses this DLL. This way any other project whose source files include this file see 
 // TESSELLATE_API functions as being imported from a DLL, whereas this DLL sees symbols
 // defined with this macro as being exported.
-#ifdef TESSELLATE_EXPORTS
+#if !defined(_WIN32)
+#define TESSELLATE_API
+#elif defined(TESSELLATE_EXPORTS)
 #define TESSELLATE_API __declspec(dllexport)
 #else
 #define TESSELLATE_API __declspec(dllimport)
@@ -12,7 +14,19 @@
 
 enum MapProjections { CylindricalEquidistant, Stereographic, Orthographic, Mercator, Lambert };
 
+// Fill style of one polygon passed to TessellatePolygons.  When useStipple is
+// set the polygon is filled with stippling off, then drawn again in the
+// stipple color with GL_POLYGON_STIPPLE on.
+struct TessPolygonStyle
+{
+	int fillColorR, fillColorG, fillColorB;
+	int opacity;
+	int stippleColorR, stippleColorG, stippleColorB;
+	int useStipple;
+};
+
 extern "C" TESSELLATE_API int TessellatePlaneSymbol(void);
+extern "C" TESSELLATE_API int TessellateOutlinedPlaneSymbol(void);
 extern "C" TESSELLATE_API int TessellateBell206Symbol(void);
 extern "C" TESSELLATE_API int Tessellate737Symbol(void);
 extern "C" TESSELLATE_API int Tessellate747Symbol(void);
@@ -26,5 +40,310 @@ extern "C" TESSELLATE_API int TessellateArrowSymbol(void);
 extern "C" TESSELLATE_API int TessellateShiftedArrowSymbol(void);
 extern "C" TESSELLATE_API void TessellateVectorFile(char* vectorFileName, int fillColor[3], bool useTwoColors, int fillColor2[3], int opacity, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
 extern "C" TESSELLATE_API void TessellatePolygon(double x[], double y[], int nPoints, int fillColorR, int fillColorG, int fillColorB, int opacity, bool isSimple, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
+extern "C" TESSELLATE_API void TessellatePolygons(double xy[], int offsets[], int nPolygons, TessPolygonStyle styles[], bool isSimple, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
+
+// TessellatePolygons, cutting the projected polygons down to clipRect (left,
+// right, bottom, top in projected units) before they are triangulated
+extern "C" TESSELLATE_API void TessellatePolygonsInRect(double xy[], int offsets[], int nPolygons, TessPolygonStyle styles[], bool isSimple, MapProjections mapProjection, double centralLongitude, double clipRect[4]);
+
+// TessellatePolygons into a result instead of drawing, so each polygon of the
+// batch can be drawn into its own display list by DrawTessResultPolygon
+struct TessResult;
+extern "C" TESSELLATE_API int TessellatePolygonsToResult(TessResult* result, double xy[], int offsets[], int nPolygons, bool isSimple, MapProjections mapProjection, double centralLongitude);
+extern "C" TESSELLATE_API void DrawTessResultPolygon(TessResult* result, int polygon, TessPolygonStyle* style);
+
 extern "C" TESSELLATE_API void ConvertVectorFileToTriangles(char* vectorFileName, char* triangleFileName);
-extern "C" TESSELLATE_API void DrawString(char* string);
\ No newline at end of file
+extern "C" TESSELLATE_API void DrawString(char* string);
+
+// Context-free tessellation.  A TessResult holds the triangles produced by the
+// tessellator as an array of x,y vertex pairs and a GL_TRIANGLES index array,
+// so callers can cache the geometry, upload it to a vertex buffer or tessellate
+// without a current OpenGL context.
+struct TessRange
+{
+	int feature;				// source feature (or polygon) number
+	int ring;					// ring within the feature; 0 is the outer ring
+	unsigned int firstIndex;	// first entry in the index array
+	unsigned int indexCount;	// number of indices (always a multiple of 3)
+};
+
+extern "C" TESSELLATE_API TessResult* CreateTessResult(void);
+extern "C" TESSELLATE_API void DeleteTessResult(TessResult* result);
+extern "C" TESSELLATE_API void ClearTessResult(TessResult* result);
+extern "C" TESSELLATE_API int TessellatePolygonToResult(TessResult* result, double x[], double y[], int nPoints, bool isSimple, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
+extern "C" TESSELLATE_API int TessellateVectorFileToResult(TessResult* result, char* vectorFileName, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
+extern "C" TESSELLATE_API void SetTessellateThreadCount(int nThreads);
+extern "C" TESSELLATE_API int GetTessResultVertexCount(TessResult* result);
+extern "C" TESSELLATE_API const double* GetTessResultVertices(TessResult* result);
+extern "C" TESSELLATE_API int GetTessResultIndexCount(TessResult* result);
+extern "C" TESSELLATE_API const unsigned int* GetTessResultIndices(TessResult* result);
+extern "C" TESSELLATE_API int GetTessResultRangeCount(TessResult* result);
+extern "C" TESSELLATE_API const TessRange* GetTessResultRanges(TessResult* result);
+extern "C" TESSELLATE_API void DrawTessResult(TessResult* result);
+
+// Binary triangle cache files (see tesscache.h for the layout).  Pass
+// TESSCACHE_QUANTIZED (1) in flags to store 16 bit coordinates.
+extern "C" TESSELLATE_API int WriteTessCache(TessResult* result, char* fileName, int flags);
+extern "C" TESSELLATE_API TessResult* LoadTessCache(char* fileName);
+
+// Memory mapped triangle cache files.  The accessors return pointers straight
+// into the mapping, which stay valid until CloseTessCache.  Vertices are float
+// x,y pairs, or uint16 pairs decoding as offset + q * scale when
+// GetTessCacheFlags has TESSCACHE_QUANTIZED set.
+struct TessCacheMap;
+struct TessCacheRange;
+
+extern "C" TESSELLATE_API TessCacheMap* OpenTessCache(char* fileName);
+extern "C" TESSELLATE_API void CloseTessCache(TessCacheMap* cache);
+extern "C" TESSELLATE_API int GetTessCacheFlags(TessCacheMap* cache);
+extern "C" TESSELLATE_API void GetTessCacheQuantization(TessCacheMap* cache, double* offsetX, double* offsetY, double* scaleX, double* scaleY);
+extern "C" TESSELLATE_API int GetTessCacheVertexCount(TessCacheMap* cache);
+extern "C" TESSELLATE_API const void* GetTessCacheVertices(TessCacheMap* cache);
+extern "C" TESSELLATE_API int GetTessCacheIndexCount(TessCacheMap* cache);
+extern "C" TESSELLATE_API const unsigned int* GetTessCacheIndices(TessCacheMap* cache);
+extern "C" TESSELLATE_API int GetTessCacheRangeCount(TessCacheMap* cache);
+extern "C" TESSELLATE_API const TessCacheRange* GetTessCacheRanges(TessCacheMap* cache);
+extern "C" TESSELLATE_API void DrawTessCache(TessCacheMap* cache, int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity);
+
+// Single pass vector file loading.  The file is opened once and both the fill
+// triangles (the same rings TessellateVectorFile fills) and the borders (every
+// ring of every polygon and multipolygon part, and line strings) are kept.
+// Border points are x,y pairs; each TessRing is one GL_LINE_STRIP.
+//
+// LoadVectorFileGeometryLods also builds nLods-1 simplified levels of detail,
+// the first within baseTolerance degrees of the original and each further
+// level four times coarser.  SelectVectorFileLod (or SetVectorFileLod) picks
+// the level the accessors and draw calls use; level 0 is full detail.
+//
+// The geometry keeps its longitude/latitude triangulation, so
+// ReprojectVectorFileGeometry can switch projection without reading or
+// tessellating the file again.  Only rings whose triangles the new projection
+// breaks (past an azimuthal cutoff, or folded over) are tessellated again; the
+// count of those is returned.
+//
+// What is read from a file is cached for the whole process, keyed by the
+// file's path and write time: every geometry loaded from the same file shares
+// one parsed and triangulated copy, and only holds its own projection of it.
+// The copy is freed with the last geometry using it.
+struct VectorFileGeometry;
+
+struct TessRing
+{
+	int feature;		// source feature number
+	int ring;			// ring or part within the feature
+	int firstPoint;		// first x,y pair in the point array
+	int nPoints;
+};
+
+enum VectorFileStatus { VectorFileOK, VectorFileOpenError, VectorFileLayerError };
+
+extern "C" TESSELLATE_API VectorFileGeometry* LoadVectorFileGeometry(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection = CylindricalEquidistant, double centralLongitude = -90);
+extern "C" TESSELLATE_API VectorFileGeometry* LoadVectorFileGeometryLods(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance);
+extern "C" TESSELLATE_API int ReprojectVectorFileGeometry(VectorFileGeometry* geometry, MapProjections mapProjection, double centralLongitude);
+extern "C" TESSELLATE_API void DeleteVectorFileGeometry(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API int GetVectorFileLodCount(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API double GetVectorFileLodTolerance(VectorFileGeometry* geometry, int lod);
+extern "C" TESSELLATE_API int SelectVectorFileLod(VectorFileGeometry* geometry, double mapUnitsPerPixel);
+extern "C" TESSELLATE_API void SetVectorFileLod(VectorFileGeometry* geometry, int lod);
+extern "C" TESSELLATE_API int GetVectorFileStatus(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API int GetVectorFileFeatureCount(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API TessResult* GetVectorFileFill(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API int GetVectorFileBorderPointCount(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API const double* GetVectorFileBorderPoints(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API int GetVectorFileBorderRangeCount(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API const TessRing* GetVectorFileBorderRanges(VectorFileGeometry* geometry);
+extern "C" TESSELLATE_API void DrawVectorFileFill(VectorFileGeometry* geometry, int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity);
+extern "C" TESSELLATE_API void DrawVectorFileBorder(VectorFileGeometry* geometry, int borderColorRGB[3], int borderWidth);
+
+// Viewport culling.  Each level keeps the projected bounds of its features in
+// a packed R-tree.  The queries list the fill ranges (positions in
+// GetTessResultRanges of GetVectorFileFill) or border rings (positions in
+// GetVectorFileBorderRanges) of the current level whose features meet rect
+// (left, right, bottom, top), in draw order; up to maxRanges are written and
+// the number found is returned.  The InRect draw calls draw just those.
+extern "C" TESSELLATE_API int GetVectorFileBounds(VectorFileGeometry* geometry, double bounds[4]);
+extern "C" TESSELLATE_API int QueryVectorFileFillRanges(VectorFileGeometry* geometry, double rect[4], int* ranges, int maxRanges);
+extern "C" TESSELLATE_API int QueryVectorFileBorderRanges(VectorFileGeometry* geometry, double rect[4], int* rings, int maxRings);
+extern "C" TESSELLATE_API void DrawVectorFileFillInRect(VectorFileGeometry* geometry, double rect[4], int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity);
+extern "C" TESSELLATE_API void DrawVectorFileBorderInRect(VectorFileGeometry* geometry, double rect[4], int borderColorRGB[3], int borderWidth);
+
+// Background loading.  BeginLoadVectorFileGeometry queues a
+// LoadVectorFileGeometryLods on the loader thread, which runs jobs one at a
+// time in the order they were begun, and returns at once.  Poll with
+// IsVectorFileLoadDone or pass a callback, which is called on the loader
+// thread when the geometry is ready.  EndLoadVectorFileGeometry waits for the
+// job if need be, returns its geometry and frees the job;
+// CancelLoadVectorFileGeometry frees the job and whatever it loads.  Every
+// job is ended or cancelled exactly once.
+struct VectorFileLoadJob;
+
+typedef void (*VectorFileLoadCallback)(VectorFileLoadJob* job, void* userData);
+
+extern "C" TESSELLATE_API VectorFileLoadJob* BeginLoadVectorFileGeometry(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance, VectorFileLoadCallback callback, void* userData);
+extern "C" TESSELLATE_API int IsVectorFileLoadDone(VectorFileLoadJob* job);
+extern "C" TESSELLATE_API VectorFileGeometry* EndLoadVectorFileGeometry(VectorFileLoadJob* job);
+extern "C" TESSELLATE_API void CancelLoadVectorFileGeometry(VectorFileLoadJob* job);
+
+// Polygon boolean operations.  Each operand is a set of contours of x,y
+// pairs, contour i being points offsets[i] to offsets[i+1]-1, read under the
+// even-odd rule as gpc reads them, so hole flags are not needed.
+// UnionPolygons unions a list of single contour polygons in one call,
+// spreading large lists over worker threads.  A result has its outline, as
+// contours whose TessRing ring is 1 for holes, and its triangles.  The
+// operation values match gpc's.
+enum PolygonOperation { PolygonDifference, PolygonIntersection, PolygonXor, PolygonUnion };
+
+struct PolygonResult;
+
+extern "C" TESSELLATE_API PolygonResult* ClipPolygons(PolygonOperation operation, double subjectXY[], int subjectOffsets[], int nSubject, double clipXY[], int clipOffsets[], int nClip);
+extern "C" TESSELLATE_API PolygonResult* UnionPolygons(double xy[], int offsets[], int nPolygons);
+extern "C" TESSELLATE_API void DeletePolygonResult(PolygonResult* result);
+extern "C" TESSELLATE_API int GetPolygonResultContourCount(PolygonResult* result);
+extern "C" TESSELLATE_API const TessRing* GetPolygonResultContours(PolygonResult* result);
+extern "C" TESSELLATE_API int GetPolygonResultPointCount(PolygonResult* result);
+extern "C" TESSELLATE_API const double* GetPolygonResultPoints(PolygonResult* result);
+extern "C" TESSELLATE_API TessResult* GetPolygonResultTriangles(PolygonResult* result);
+
+// Basemap bundles (see bundle.h for the layout).  WriteVectorBundle reads,
+// simplifies to nLods levels and triangulates each vector file, projects it
+// for each of nProjections projections, and packs it all into one file;
+// tessbundle.exe runs it at build time.  OpenVectorBundle reads a bundle in
+// one go and hands its layers to the geometry cache, so geometries loaded
+// from those files afterwards (and unchanged since the bundle was built)
+// skip reading, triangulating and, for the bundled projections, projecting.
+// It returns the number of layers added.
+extern "C" TESSELLATE_API int WriteVectorBundle(char* bundleFileName, char** vectorFileNames, int nFiles, int nLods, double baseTolerance, MapProjections* projections, int nProjections, double centralLongitude);
+extern "C" TESSELLATE_API int OpenVectorBundle(char* bundleFileName);
+extern "C" TESSELLATE_API void CloseVectorBundles(void);
+
+// Spatial index for picking features under the mouse.  Features are added
+// under ids the caller chooses (kept small, as they index an array); setting
+// an id again replaces its feature.  Points and circles (center and radius in
+// degrees of arc) are x,y pairs; a polyline's points are adjusted for the
+// dateline as Curve does when crossDateline is set, a polygon's test point as
+// Polygon does.  QueryHitIndex writes up to maxIds ids, ascending, and returns
+// how many there are: polylines passing within lineDistance kilometers of x,y
+// and polygons holding it, tested exactly as Curve.IsPointOn and
+// Polygon.IsPointIn test them, and the points and circles whose boxes reach
+// within radius degrees of arc, for the caller to measure.
+enum HitFeatureTypes { HitPoint, HitPolyline, HitPolygon, HitCircle };
+
+class HitIndex;
+
+extern "C" TESSELLATE_API HitIndex* CreateHitIndex(void);
+extern "C" TESSELLATE_API void DeleteHitIndex(HitIndex* index);
+extern "C" TESSELLATE_API void SetHitIndexFeature(HitIndex* index, int id, HitFeatureTypes type, double xy[], int nPoints, int crossDateline, double radius);
+extern "C" TESSELLATE_API void RemoveHitIndexFeature(HitIndex* index, int id);
+extern "C" TESSELLATE_API void ClearHitIndex(HitIndex* index);
+extern "C" TESSELLATE_API int QueryHitIndex(HitIndex* index, double x, double y, double radius, double lineDistance, int ids[], int maxIds);
+
+// Flight routes against weather hazards.  Route r is points routeOffsets[r]
+// to routeOffsets[r+1]-1 of routeXY, x,y pairs, with an altitude in flight
+// levels for each point.  Hazard h is points hazardOffsets[h] to
+// hazardOffsets[h+1]-1 of hazardXY: a polygon, or for a single point a circle
+// of hazardRadius[h] degrees of arc, from flight level hazardLower[h] to
+// hazardUpper[h].  Each stretch of a route inside a hazard is one crossing,
+// ordered by route, hazard and entry.  Positions along a route are the
+// segment index plus the fraction along the segment; altitudeOverlap is 1
+// when the route is within the hazard's levels somewhere in the crossing,
+// from overlapEntryPosition to overlapExitPosition.  Routes are spread over
+// nThreads worker threads; 0 uses the count set with SetTessellateThreadCount.
+struct RouteHazardCrossing
+{
+	int route, hazard;
+	double entryPosition, exitPosition;
+	double entryLon, entryLat, entryAltitude;
+	double exitLon, exitLat, exitAltitude;
+	int altitudeOverlap;
+	double overlapEntryPosition, overlapExitPosition;
+};
+
+struct RouteHazardResult;
+
+extern "C" TESSELLATE_API RouteHazardResult* IntersectRoutesWithHazards(double routeXY[], double routeAltitudes[], int routeOffsets[], int nRoutes, double hazardXY[], int hazardOffsets[], int nHazards, double hazardRadius[], double hazardLower[], double hazardUpper[], int nThreads);
+extern "C" TESSELLATE_API void DeleteRouteHazardResult(RouteHazardResult* result);
+extern "C" TESSELLATE_API int GetRouteHazardCrossingCount(RouteHazardResult* result);
+extern "C" TESSELLATE_API const RouteHazardCrossing* GetRouteHazardCrossings(RouteHazardResult* result);
+
+// Moving hazards.  Pair i is a route (points routeOffsets[i] to
+// routeOffsets[i+1]-1, with the time in seconds each is reached) and a
+// hazard given as for IntersectRoutesWithHazards, where it is at
+// hazardStart[i], drifting toward hazardDirection[i] degrees true at
+// hazardSpeed[i] knots until hazardEnd[i].  For each pair conflicts[i] is
+// set to the earliest time the route is inside the hazard and within its
+// levels; conflict is 0 if it never is.  Returns the number of pairs in
+// conflict.  Pairs are spread over nThreads worker threads as routes are.
+struct MovingHazardConflict
+{
+	int conflict;
+	double time, position;
+	double lon, lat, altitude;
+};
+
+extern "C" TESSELLATE_API int FindMovingHazardConflicts(double routeXY[], double routeTimes[], double routeAltitudes[], int routeOffsets[], double hazardXY[], int hazardOffsets[], double hazardRadius[], double hazardLower[], double hazardUpper[], double hazardDirection[], double hazardSpeed[], double hazardStart[], double hazardEnd[], int nPairs, MovingHazardConflict conflicts[], int nThreads);
+
+// Intersection log files.  OpenLogIndex maps the file a window at a time and
+// lists its lines, leaving out empty lines and those marked REDUNDANT,
+// spreading large files over nThreads worker threads; an empty file gives an
+// empty index.  Nothing is read from a line until it is
+// asked for: GetLogIndexEntry gives where it is, and ReadLogIndexEntry copies
+// up to bufferSize of its bytes from start on, returning how many.
+// ReadLogIndexEntries copies the first maxLength bytes of count lines from
+// first on, line i to buffer + i*maxLength with its length in lengths[i],
+// and returns how many lines there were.  A line cut short ends on a UTF-8
+// character boundary.
+struct LogIndexEntry
+{
+	long long offset;		// in the file
+	int length;				// without the line end
+	int jsonOffset;			// of the first '{' from the start of the line; -1 if none
+};
+
+struct LogIndex;
+
+extern "C" TESSELLATE_API LogIndex* OpenLogIndex(char* fileName, int nThreads);
+extern "C" TESSELLATE_API void CloseLogIndex(LogIndex* index);
+extern "C" TESSELLATE_API int GetLogIndexEntryCount(LogIndex* index);
+extern "C" TESSELLATE_API int GetLogIndexEntry(LogIndex* index, int entry, LogIndexEntry* result);
+extern "C" TESSELLATE_API int ReadLogIndexEntry(LogIndex* index, int entry, int start, char* buffer, int bufferSize);
+extern "C" TESSELLATE_API int ReadLogIndexEntries(LogIndex* index, int first, int count, int maxLength, char* buffer, int* lengths);
+
+// Symbol registry.  Every symbol outline, built in or added with
+// RegisterSymbol/LoadSymbolFile, is tessellated into one shared vertex and
+// index buffer and looked up by ID.  To draw many symbols without switching
+// display lists, call BeginSymbols once, DrawSymbol per symbol (in the current
+// color, with whatever transform is current) and EndSymbols.
+enum SymbolIds { PlaneSymbol = 1, OutlinedPlaneSymbol, Bell206Symbol, B737Symbol, B747Symbol, C172Symbol, LearJetSymbol,
+	SAABSymbol, TriangleSymbol, CircleSymbol, SquareSymbol, ArrowSymbol, ShiftedArrowSymbol };
+
+extern "C" TESSELLATE_API int RegisterSymbol(int id, char* name, double xy[], int nPoints, double borderXY[], int nBorderPoints);
+extern "C" TESSELLATE_API int LoadSymbolFile(char* fileName);
+extern "C" TESSELLATE_API int FindSymbol(char* name);
+extern "C" TESSELLATE_API int GetSymbolRange(int id, unsigned int* firstIndex, unsigned int* indexCount, int* firstBorderVertex, int* nBorderVertices);
+extern "C" TESSELLATE_API int GetSymbolVertexCount(void);
+extern "C" TESSELLATE_API const double* GetSymbolVertices(void);
+extern "C" TESSELLATE_API int GetSymbolIndexCount(void);
+extern "C" TESSELLATE_API const unsigned int* GetSymbolIndices(void);
+extern "C" TESSELLATE_API void BeginSymbols(void);
+extern "C" TESSELLATE_API int DrawSymbol(int id);
+extern "C" TESSELLATE_API void EndSymbols(void);
+extern "C" TESSELLATE_API int CreateSymbolDisplayList(int id);
+
+// Polyline simplification.  Polylines are x,y pairs; for a batch, polyline i
+// is made up of the points offsets[i] to offsets[i+1]-1.  The indices of the
+// points kept (always including each polyline's ends) are written to
+// keptIndices, which must have room for every input point, with polyline i's
+// at keptOffsets[i] to keptOffsets[i+1]-1.  For Douglas-Peucker tolerance is a
+// distance; for Visvalingam-Whyatt it is the smallest triangle area kept.
+// nThreads of 0 uses the count set with SetTessellateThreadCount.  Both return
+// the number of points kept.
+enum SimplifyMethods { SimplifyDouglasPeucker, SimplifyVisvalingam };
+
+extern "C" TESSELLATE_API int SimplifyPolyline(double xy[], int nPoints, double tolerance, int method, int keptIndices[]);
+extern "C" TESSELLATE_API int SimplifyPolylines(double xy[], int offsets[], int nPolylines, double tolerance, int method, int keptIndices[], int keptOffsets[], int nThreads);
+
+// Project n longitude/latitude points with the same formulas the tessellation
+// functions use.  The per-projection constants are worked out once per call
+// and the loop uses AVX2 when the CPU supports it.  px and py may be lon and
+// lat.
+extern "C" TESSELLATE_API void ProjectPoints(MapProjections mapProjection, double centralLongitude, const double* lon, const double* lat, double* px, double* py, int n);
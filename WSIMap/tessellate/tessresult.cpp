@@ -0,0 +1,385 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "tessresult.h"
+#include "earcut.h"
+#include "vectorfile.h"
+#include "projection.h"
+#include <stddef.h>
+#include <thread>
+
+void CALLBACK recordBeginCallback(GLenum which, void *polygonData)
+{
+	// Only GL_TRIANGLES arrive here because an edge flag callback is registered
+}
+
+void CALLBACK recordEdgeFlagCallback(GLboolean flag, void *polygonData)
+{
+}
+
+void CALLBACK recordEndCallback(void *polygonData)
+{
+}
+
+void CALLBACK recordErrorCallback(GLenum errorCode, void *polygonData)
+{
+}
+
+void CALLBACK recordVertexCallback(void *vertexData, void *polygonData)
+{
+	((TessRecorder *)polygonData)->Vertex((unsigned int)(size_t)vertexData);
+}
+
+void CALLBACK recordCombineCallback(GLdouble coords[3], void *vertexData[4], GLfloat weight[4], void **dataOut, void *polygonData)
+{
+	*dataOut = (void *)(size_t)((TessRecorder *)polygonData)->Combine(coords);
+}
+
+TessRecorder::TessRecorder(TessResult *result, GLenum windingRule) : result(result)
+{
+	tobj = gluNewTess();
+
+	// The vertex data handed to the tessellator is the vertex's index in the
+	// result, so the callbacks only have to copy indices.  Registering an
+	// edge flag callback makes GLU emit independent triangles rather than
+	// fans and strips.
+	gluTessCallback(tobj, GLU_TESS_BEGIN_DATA, (GluTessCallbackType)recordBeginCallback);
+	gluTessCallback(tobj, GLU_TESS_EDGE_FLAG_DATA, (GluTessCallbackType)recordEdgeFlagCallback);
+	gluTessCallback(tobj, GLU_TESS_VERTEX_DATA, (GluTessCallbackType)recordVertexCallback);
+	gluTessCallback(tobj, GLU_TESS_END_DATA, (GluTessCallbackType)recordEndCallback);
+	gluTessCallback(tobj, GLU_TESS_ERROR_DATA, (GluTessCallbackType)recordErrorCallback);
+	gluTessCallback(tobj, GLU_TESS_COMBINE_DATA, (GluTessCallbackType)recordCombineCallback);
+	gluTessProperty(tobj, GLU_TESS_WINDING_RULE, windingRule);
+	gluTessNormal(tobj, 0.0, 0.0, 1.0);
+}
+
+TessRecorder::~TessRecorder()
+{
+	gluDeleteTess(tobj);
+}
+
+void TessRecorder::AddRing(const double *xy, int nPoints, int feature, int ring)
+{
+	AddPolygon(xy, nPoints, NULL, 0, feature, ring);
+}
+
+void TessRecorder::AddPolygon(const double *xy, int nPoints, const int *holeStarts, int nHoles, int feature, int ring)
+{
+	AddContours(xy, nPoints, holeStarts, nHoles, feature, ring, true);
+}
+
+void TessRecorder::AddContours(const double *xy, int nPoints, const int *contourStarts, int nMore, int feature, int ring, bool tryEarcut)
+{
+	if (nPoints < 3) return;
+
+	TessRange range;
+	range.feature = feature;
+	range.ring = ring;
+	range.firstIndex = (unsigned int)result->indices.size();
+
+	unsigned int firstVertex = (unsigned int)(result->vertices.size() / 2);
+	result->vertices.insert(result->vertices.end(), xy, xy + nPoints * 2);
+
+	scratch.Reset();
+	if (!tryEarcut || !EarcutTriangulate(xy, nPoints, 2, contourStarts, nMore, result->indices, firstVertex, &scratch))
+	{
+		// GLU reads the coordinates from a 3D array that has to stay valid
+		// until the polygon ends
+		scratch.Reset();
+		GLdouble *coords = scratch.Allocate<GLdouble>(nPoints * 3);
+		for (int i=0; i<nPoints; i++)
+		{
+			coords[i*3] = xy[i*2];
+			coords[i*3+1] = xy[i*2+1];
+			coords[i*3+2] = 0.0;
+		}
+
+		gluTessBeginPolygon(tobj, this);
+		for (int h=0; h<=nMore; h++)
+		{
+			int start = h == 0 ? 0 : contourStarts[h-1];
+			int end = h < nMore ? contourStarts[h] : nPoints;
+			gluTessBeginContour(tobj);
+			for (int i=start; i<end; i++)
+				gluTessVertex(tobj, &coords[i*3], (void *)(size_t)(firstVertex + i));
+			gluTessEndContour(tobj);
+		}
+		gluTessEndPolygon(tobj);
+	}
+
+	range.indexCount = (unsigned int)result->indices.size() - range.firstIndex;
+	if (range.indexCount > 0)
+		result->ranges.push_back(range);
+}
+
+void TessRecorder::Vertex(unsigned int index)
+{
+	result->indices.push_back(index);
+}
+
+unsigned int TessRecorder::Combine(const GLdouble coords[3])
+{
+	unsigned int index = (unsigned int)(result->vertices.size() / 2);
+	result->vertices.push_back(coords[0]);
+	result->vertices.push_back(coords[1]);
+	return index;
+}
+
+// 0 means one thread per hardware thread
+static int tessellateThreadCount = 0;
+
+// Files with fewer points than this are not worth spreading over threads
+static const int minPointsPerThread = 20000;
+
+int WorkerThreadCount(int nThreads, int nWork, int minWorkPerThread)
+{
+	if (nThreads <= 0) nThreads = tessellateThreadCount;
+	if (nThreads <= 0) nThreads = (int)std::thread::hardware_concurrency();
+	if (nThreads > nWork / minWorkPerThread) nThreads = nWork / minWorkPerThread;
+	return nThreads < 1 ? 1 : nThreads;
+}
+
+static void TessellateRingRun(const RingSet *ringSet, size_t firstRing, size_t endRing, TessResult *result)
+{
+	TessRecorder recorder(result);
+	for (size_t r=firstRing; r<endRing; r++)
+	{
+		const TessRing &info = ringSet->rings[r];
+		recorder.AddRing(&ringSet->xy[info.firstPoint * 2], info.nPoints, info.feature, info.ring);
+	}
+}
+
+void TessellateRings(const RingSet &ringSet, TessResult *result, int nThreads)
+{
+	if (ringSet.rings.empty()) return;
+
+	int nPoints = (int)(ringSet.xy.size() / 2);
+	nThreads = WorkerThreadCount(nThreads, nPoints, minPointsPerThread);
+	if (nThreads > (int)ringSet.rings.size()) nThreads = (int)ringSet.rings.size();
+
+	if (nThreads <= 1)
+	{
+		TessellateRingRun(&ringSet, 0, ringSet.rings.size(), result);
+		return;
+	}
+
+	// Split the rings into runs with roughly the same number of points
+	std::vector<size_t> runStart(nThreads + 1, ringSet.rings.size());
+	runStart[0] = 0;
+	int run = 1;
+	int pointsSoFar = 0;
+	for (size_t r=0; r<ringSet.rings.size() && run<nThreads; r++)
+	{
+		pointsSoFar += ringSet.rings[r].nPoints;
+		if ((double)pointsSoFar >= (double)nPoints * run / nThreads)
+			runStart[run++] = r + 1;
+	}
+
+	// Tessellate the runs in parallel, each into its own result
+	std::vector<TessResult> partial(nThreads);
+	std::vector<std::thread> workers;
+	for (int t=1; t<nThreads; t++)
+		workers.push_back(std::thread(TessellateRingRun, &ringSet, runStart[t], runStart[t+1], &partial[t]));
+	TessellateRingRun(&ringSet, runStart[0], runStart[1], &partial[0]);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	// Append the partial results in ring order
+	size_t nVertices = result->vertices.size(), nIndices = result->indices.size(), nRanges = result->ranges.size();
+	for (int t=0; t<nThreads; t++)
+	{
+		nVertices += partial[t].vertices.size();
+		nIndices += partial[t].indices.size();
+		nRanges += partial[t].ranges.size();
+	}
+	result->vertices.reserve(nVertices);
+	result->indices.reserve(nIndices);
+	result->ranges.reserve(nRanges);
+	for (int t=0; t<nThreads; t++)
+	{
+		unsigned int vertexOffset = (unsigned int)(result->vertices.size() / 2);
+		unsigned int indexOffset = (unsigned int)result->indices.size();
+		result->vertices.insert(result->vertices.end(), partial[t].vertices.begin(), partial[t].vertices.end());
+		for (size_t i=0; i<partial[t].indices.size(); i++)
+			result->indices.push_back(partial[t].indices[i] + vertexOffset);
+		for (size_t r=0; r<partial[t].ranges.size(); r++)
+		{
+			TessRange range = partial[t].ranges[r];
+			range.firstIndex += indexOffset;
+			result->ranges.push_back(range);
+		}
+		TessResult().vertices.swap(partial[t].vertices);	// release as we go
+	}
+}
+
+extern "C" TESSELLATE_API void SetTessellateThreadCount(int nThreads)
+{
+	tessellateThreadCount = nThreads > 0 ? nThreads : 0;
+}
+
+extern "C" TESSELLATE_API TessResult* CreateTessResult(void)
+{
+	return new TessResult;
+}
+
+extern "C" TESSELLATE_API void DeleteTessResult(TessResult* result)
+{
+	delete result;
+}
+
+extern "C" TESSELLATE_API void ClearTessResult(TessResult* result)
+{
+	if (result == NULL) return;
+	result->vertices.clear();
+	result->indices.clear();
+	result->ranges.clear();
+}
+
+extern "C" TESSELLATE_API int TessellatePolygonToResult(TessResult* result, double x[], double y[], int nPoints, bool isSimple, MapProjections mapProjection, double centralLongitude)
+{
+	if (result == NULL || nPoints < 3) return 0;
+
+	// Non-simple polygons are filled with the same winding rule TessellatePolygon uses
+	TessRecorder recorder(result, isSimple ? GLU_TESS_WINDING_ODD : GLU_TESS_WINDING_NONZERO);
+
+	std::vector<double> lonLat(nPoints * 2), xy;
+	for (int i=0; i<nPoints; i++)
+	{
+		lonLat[i*2] = x[i];
+		lonLat[i*2+1] = y[i];
+	}
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	std::vector<int> starts;
+	int nPieces = ClipAndProjectRing(params, &lonLat[0], nPoints, xy, starts);
+	starts.push_back((int)(xy.size() / 2));
+
+	int nRanges = (int)result->ranges.size();
+	int feature = nRanges > 0 ? result->ranges[nRanges-1].feature + 1 : 0;
+	if (nPieces == 1 || isSimple)
+	{
+		for (int p=0; p<nPieces; p++)
+			recorder.AddRing(&xy[starts[p]*2], starts[p+1] - starts[p], feature, 0);
+	}
+	else if (nPieces > 1)
+	{
+		// The pieces of a self-intersecting polygon go to GLU together, so its
+		// winding rule fills where they overlap; earcut would take all but the
+		// first for holes
+		std::vector<int> pieceStarts(starts.begin() + 1, starts.begin() + nPieces);
+		recorder.AddContours(&xy[0], (int)(xy.size() / 2), &pieceStarts[0], nPieces - 1, feature, 0, false);
+	}
+
+	return (int)result->ranges.size() - nRanges;
+}
+
+extern "C" TESSELLATE_API int TessellateVectorFileToResult(TessResult* result, char* vectorFileName, MapProjections mapProjection, double centralLongitude)
+{
+	if (result == NULL) return 0;
+
+	RingSet ringSet;
+	if (!ReadVectorFileRings(vectorFileName, mapProjection, centralLongitude, ringSet))
+		return 0;
+
+	int nRanges = (int)result->ranges.size();
+	TessellateRings(ringSet, result);
+	return (int)result->ranges.size() - nRanges;
+}
+
+extern "C" TESSELLATE_API int GetTessResultVertexCount(TessResult* result)
+{
+	return result != NULL ? (int)(result->vertices.size() / 2) : 0;
+}
+
+extern "C" TESSELLATE_API const double* GetTessResultVertices(TessResult* result)
+{
+	return (result != NULL && !result->vertices.empty()) ? &result->vertices[0] : NULL;
+}
+
+extern "C" TESSELLATE_API int GetTessResultIndexCount(TessResult* result)
+{
+	return result != NULL ? (int)result->indices.size() : 0;
+}
+
+extern "C" TESSELLATE_API const unsigned int* GetTessResultIndices(TessResult* result)
+{
+	return (result != NULL && !result->indices.empty()) ? &result->indices[0] : NULL;
+}
+
+extern "C" TESSELLATE_API int GetTessResultRangeCount(TessResult* result)
+{
+	return result != NULL ? (int)result->ranges.size() : 0;
+}
+
+extern "C" TESSELLATE_API const TessRange* GetTessResultRanges(TessResult* result)
+{
+	return (result != NULL && !result->ranges.empty()) ? &result->ranges[0] : NULL;
+}
+
+extern "C" TESSELLATE_API void DrawTessResult(TessResult* result)
+{
+	if (result == NULL || result->indices.empty()) return;
+
+	// Vertex arrays are dereferenced when the call is made, so this can also
+	// be compiled into a display list
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &result->vertices[0]);
+	glDrawElements(GL_TRIANGLES, (GLsizei)result->indices.size(), GL_UNSIGNED_INT, &result->indices[0]);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void DrawTessResultRanges(const TessResult *result, const int fillColorRGB[3], bool useTwoColors, const int fillColor2RGB[3], int opacity)
+{
+	if (result->indices.empty()) return;
+
+	if (useTwoColors)
+	{
+		if (result->ranges.empty()) return;
+		std::vector<int> ranges(result->ranges.size());
+		for (size_t r=0; r<ranges.size(); r++)
+			ranges[r] = (int)r;
+		DrawTessResultRanges(result, &ranges[0], (int)ranges.size(), fillColorRGB, useTwoColors, fillColor2RGB, opacity);
+		return;
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &result->vertices[0]);
+	glColor4f(((float)fillColorRGB[0])/255., ((float)fillColorRGB[1])/255., ((float)fillColorRGB[2])/255., ((float)opacity)/100.);
+	glDrawElements(GL_TRIANGLES, (GLsizei)result->indices.size(), GL_UNSIGNED_INT, &result->indices[0]);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void DrawTessResultRanges(const TessResult *result, const int *ranges, int nRanges, const int fillColorRGB[3], bool useTwoColors, const int fillColor2RGB[3], int opacity)
+{
+	if (result->indices.empty() || nRanges == 0) return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &result->vertices[0]);
+
+	// With two colors outer rings get the first, inner rings the second.
+	// Consecutive ranges with the same color that follow on in the index
+	// array are drawn with one call.
+	const int *lastRGB = NULL;
+	int r = 0;
+	while (r < nRanges)
+	{
+		bool inner = useTwoColors && result->ranges[ranges[r]].ring > 0;
+		unsigned int firstIndex = result->ranges[ranges[r]].firstIndex;
+		unsigned int indexCount = 0;
+		while (r < nRanges && (useTwoColors && result->ranges[ranges[r]].ring > 0) == inner &&
+			result->ranges[ranges[r]].firstIndex == firstIndex + indexCount)
+		{
+			indexCount += result->ranges[ranges[r]].indexCount;
+			r++;
+		}
+		const int *rgb = inner ? fillColor2RGB : fillColorRGB;
+		if (rgb != lastRGB)
+			glColor4f(((float)rgb[0])/255., ((float)rgb[1])/255., ((float)rgb[2])/255., ((float)opacity)/100.);
+		lastRGB = rgb;
+		if (indexCount > 0)
+			glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, &result->indices[firstIndex]);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
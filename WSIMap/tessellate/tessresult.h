@@ -0,0 +1,68 @@
+// tessresult.h : TessResult and the GLU tessellator front end that fills it.
+// Include after stdafx.h, tessellate.h and glut.h.
+
+#pragma once
+
+#include <vector>
+#include "arena.h"
+
+struct TessResult
+{
+	std::vector<double> vertices;		// interleaved x,y pairs
+	std::vector<unsigned int> indices;	// GL_TRIANGLES, three per triangle
+	std::vector<TessRange> ranges;		// one range per tessellated ring
+};
+
+// Drives a GLU tessellator whose callbacks append to a TessResult instead of
+// issuing OpenGL calls, so no rendering context is needed.  One recorder can
+// tessellate any number of rings; the tessellator is created once.
+class TessRecorder
+{
+public:
+	TessRecorder(TessResult *result, GLenum windingRule = GLU_TESS_WINDING_ODD);
+	~TessRecorder();
+
+	// Tessellate one ring of x,y pairs and add a range for it.  Simple rings
+	// are ear clipped; self-intersecting ones go through GLU.
+	void AddRing(const double *xy, int nPoints, int feature, int ring);
+
+	// Tessellate an outer ring followed by nHoles holes, each starting at the
+	// vertex listed in holeStarts, and add a single range for the polygon.
+	// Holes are bridged into the outer ring and ear clipped; contours that
+	// meet, or are not nested as outer ring and holes, go through GLU.
+	void AddPolygon(const double *xy, int nPoints, const int *holeStarts, int nHoles, int feature, int ring);
+
+	// Tessellate contours that may overlap one another under the recorder's
+	// winding rule, as one range.  Each contour after the first starts at the
+	// vertex listed in contourStarts.  Without tryEarcut they always go
+	// through GLU, which is what any rule but the odd one needs.
+	void AddContours(const double *xy, int nPoints, const int *contourStarts, int nMore, int feature, int ring, bool tryEarcut);
+
+	// Called from the GLU callbacks
+	void Vertex(unsigned int index);
+	unsigned int Combine(const GLdouble coords[3]);
+
+private:
+	TessRecorder(const TessRecorder&);
+	TessRecorder& operator=(const TessRecorder&);
+
+	TessResult *result;
+	GLUtesselator *tobj;
+	TessArena scratch;	// earcut nodes and GLU coordinates, reset per polygon
+};
+
+struct RingSet;
+
+// Tessellate every ring of ringSet into result in ring order.  Large sets are
+// split into runs of rings that worker threads tessellate into their own
+// buffers; the buffers are then appended in order, so the output does not
+// depend on the number of threads.  nThreads of 0 uses the count set with
+// SetTessellateThreadCount.
+void TessellateRings(const RingSet &ringSet, TessResult *result, int nThreads = 0);
+
+// Draw a result's triangles, using the second color for rings after the
+// first when useTwoColors is set
+void DrawTessResultRanges(const TessResult *result, const int fillColorRGB[3], bool useTwoColors, const int fillColor2RGB[3], int opacity);
+
+// The same for the listed ranges only, given as positions in result->ranges
+void DrawTessResultRanges(const TessResult *result, const int *ranges, int nRanges, const int fillColorRGB[3], bool useTwoColors, const int fillColor2RGB[3], int opacity);
@@ -0,0 +1,717 @@
+// tesstest.cpp : checks of tessellate.dll that need no OpenGL context.
+// Modules the DLL does not export (earcut.cpp, ...) are built in here.
+//
+//   tesstest
+//
+// Prints each failed check and exits with 1 if there were any.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#define rmdir _rmdir
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "tessellate.h"
+#include "tesscache.h"
+#include "vectorfile.h"
+#include "earcut.h"
+#include "arena.h"
+
+static int failures = 0;
+
+static void Check(bool passed, const char *what)
+{
+	if (!passed)
+	{
+		fprintf(stderr, "FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+// How many of result's triangles hold x,y
+static int TrianglesHolding(TessResult *result, double x, double y)
+{
+	const double *v = GetTessResultVertices(result);
+	const unsigned int *indices = GetTessResultIndices(result);
+	int nIndices = GetTessResultIndexCount(result), count = 0;
+	for (int i=0; i+2<nIndices; i+=3)
+	{
+		double d[3];
+		for (int k=0; k<3; k++)
+		{
+			const double *a = v + indices[i+k]*2, *b = v + indices[i+(k+1)%3]*2;
+			d[k] = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+		}
+		if ((d[0] > 0 && d[1] > 0 && d[2] > 0) || (d[0] < 0 && d[1] < 0 && d[2] < 0))
+			count++;
+	}
+	return count;
+}
+
+// Arena memory is aligned and reused after a reset, and a request that
+// can't be met throws rather than handing back NULL
+static void TestArena()
+{
+	TessArena arena(256);
+	double *a = arena.Allocate<double>(3);
+	char *b = arena.Allocate<char>(1);
+	double *c = arena.Allocate<double>(100);
+	Check(((size_t)a % 16) == 0 && ((size_t)b % 16) == 0 && ((size_t)c % 16) == 0, "arena allocations are aligned");
+	arena.Reset();
+	Check(arena.Allocate<double>(3) == a, "arena reuses its blocks after a reset");
+
+	bool thrown = false;
+	try
+	{
+		arena.Allocate<double>((size_t)-1 / 4);
+	}
+	catch (const std::bad_alloc&)
+	{
+		thrown = true;
+	}
+	Check(thrown, "arena throws std::bad_alloc when it can't allocate");
+}
+
+// Twice the area of the triangles listed in indices, over x,y pairs
+static double TriangleArea2(const double *xy, const unsigned int *indices, size_t nIndices)
+{
+	double area = 0;
+	for (size_t i=0; i+2<nIndices; i+=3)
+	{
+		const double *a = xy + indices[i]*2, *b = xy + indices[i+1]*2, *c = xy + indices[i+2]*2;
+		area += fabs((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]));
+	}
+	return area;
+}
+
+// Simple rings, and outer rings with holes inside them, are ear clipped into
+// triangles covering exactly their area; contours that cross or touch
+// themselves or each other, or holes not inside the outer ring alone, are
+// refused and left to GLU
+static void TestEarcut()
+{
+	double square[] = { 0, 0, 10, 0, 10, 10, 0, 10, 0, 0 };
+	double u[] = { 0, 0, 30, 0, 30, 30, 20, 30, 20, 10, 10, 10, 10, 30, 0, 30 };
+	double bowtie[] = { 0, 0, 10, 10, 10, 0, 0, 10 };
+	double crossed[] = { 0, 0, 40, 0, 40, 40, 30, 40, 30, 10, 35, 10, 35, 50, 0, 40 };
+	// A 20x20 square with a 10x10 hole, joined to it by a bridge out and back
+	double keyhole[] = { 0, 0, 20, 0, 20, 20, 0, 20, 0, 0, 5, 5, 5, 15, 15, 15, 15, 5, 5, 5 };
+
+	std::vector<unsigned int> triangles;
+	Check(EarcutTriangulate(square, 5, 2, NULL, 0, triangles) && triangles.size() == 6 && TriangleArea2(square, &triangles[0], triangles.size()) == 200,
+		"convex ring is ear clipped to its area");
+	triangles.clear();
+	Check(EarcutTriangulate(u, 8, 2, NULL, 0, triangles) && TriangleArea2(u, &triangles[0], triangles.size()) == 2 * 700,
+		"concave ring is ear clipped to its area");
+	triangles.clear();
+	Check(!EarcutTriangulate(bowtie, 4, 2, NULL, 0, triangles) && triangles.empty(), "bowtie is left to GLU");
+	Check(!EarcutTriangulate(crossed, 8, 2, NULL, 0, triangles) && triangles.empty(), "ring crossing itself far from its start is left to GLU");
+	Check(!EarcutTriangulate(keyhole, 10, 2, NULL, 0, triangles) && triangles.empty(), "ring with a hole bridged in is left to GLU");
+
+	// The keyhole's square and hole as separate contours, then with a second
+	// hole inside the first, one outside the square and one crossing it
+	double holed[] = { 0, 0, 20, 0, 20, 20, 0, 20, 0, 0, 5, 5, 5, 15, 15, 15, 15, 5, 5, 5,
+		8, 8, 8, 12, 12, 12, 12, 8, 8, 8 };
+	double outside[] = { 0, 0, 20, 0, 20, 20, 0, 20, 30, 5, 30, 15, 40, 15, 40, 5 };
+	double crossing[] = { 0, 0, 20, 0, 20, 20, 0, 20, 15, 5, 15, 15, 25, 15, 25, 5 };
+	int holeStart[] = { 5 }, nestedStarts[] = { 5, 10 }, squareStart[] = { 4 };
+	Check(EarcutTriangulate(holed, 10, 2, holeStart, 1, triangles) && TriangleArea2(holed, &triangles[0], triangles.size()) == 2 * 300,
+		"ring with a hole is ear clipped to its area less the hole");
+	triangles.clear();
+	Check(!EarcutTriangulate(holed, 15, 2, nestedStarts, 2, triangles) && triangles.empty(), "hole inside a hole is left to GLU");
+	Check(!EarcutTriangulate(outside, 8, 2, squareStart, 1, triangles) && triangles.empty(), "hole outside the outer ring is left to GLU");
+	Check(!EarcutTriangulate(crossing, 8, 2, squareStart, 1, triangles) && triangles.empty(), "hole crossing the outer ring is left to GLU");
+
+	// GLU fills the keyhole without the hole
+	double x[10], y[10];
+	for (int i=0; i<10; i++)
+	{
+		x[i] = keyhole[i*2];
+		y[i] = keyhole[i*2+1];
+	}
+	TessResult *result = CreateTessResult();
+	TessellatePolygonToResult(result, x, y, 10, true, CylindricalEquidistant, 0);
+	double px[2], py[2], lon[] = { 0, 20 }, lat[] = { 0, 20 };
+	ProjectPoints(CylindricalEquidistant, 0, lon, lat, px, py, 2);
+	double scale = (px[1] - px[0]) * (py[1] - py[0]) / 400;
+	double area = TriangleArea2(GetTessResultVertices(result), GetTessResultIndices(result), GetTessResultIndexCount(result)) / 2;
+	Check(fabs(area - 300 * scale) < 1e-6 * fabs(scale), "holed ring is filled by GLU without its hole");
+	DeleteTessResult(result);
+}
+
+// Four strips framing a square union to an outline with a hole, which fills
+// the frame and not the hole
+static void TestUnionHole()
+{
+	double xy[] = { 0, 0, 20, 0, 20, 5, 0, 5, 0, 15, 20, 15, 20, 20, 0, 20,
+		0, 0, 5, 0, 5, 20, 0, 20, 15, 0, 20, 0, 20, 20, 15, 20 };
+	int offsets[] = { 0, 4, 8, 12, 16 };
+	PolygonResult *result = UnionPolygons(xy, offsets, 4);
+	TessResult *triangles = GetPolygonResultTriangles(result);
+	double area = TriangleArea2(GetTessResultVertices(triangles), GetTessResultIndices(triangles), GetTessResultIndexCount(triangles)) / 2;
+	Check(GetPolygonResultContourCount(result) == 2 && fabs(area - 300) < 1e-3 &&
+		TrianglesHolding(triangles, 10, 10) == 0 && TrianglesHolding(triangles, 2, 10) == 1,
+		"union of a frame fills it around its hole");
+	DeletePolygonResult(result);
+}
+
+// A U reaching below the equator comes out of the hemisphere clip as its two
+// arms, which must both be filled once and nothing between them
+static void TestHemisphereSplit()
+{
+	double ux[] = { -100, -70, -70, -80, -80, -90, -90, -100 };
+	double uy[] = { -10, -10, 20, 20, -5, -5, 20, 20 };
+	TessResult *result = CreateTessResult();
+	TessellatePolygonToResult(result, ux, uy, 8, false, Orthographic, -90);
+
+	// Left arm, gap, right arm, at two latitudes
+	double lon[] = { -95, -85, -75, -95, -85, -75 };
+	double lat[] = { 5, 5, 5, 15, 15, 15 };
+	int expected[] = { 1, 0, 1, 1, 0, 1 };
+	double px[6], py[6];
+	ProjectPoints(Orthographic, -90, lon, lat, px, py, 6);
+	bool passed = true;
+	for (int i=0; i<6; i++)
+		passed = passed && TrianglesHolding(result, px[i], py[i]) == expected[i];
+	Check(passed, "polygon split by the hemisphere clip fills both pieces and nothing between");
+	DeleteTessResult(result);
+}
+
+// A batch tessellated into a result keeps each polygon's triangles under its
+// index, in order, so Polygon.cs can draw them one display list at a time
+static void TestPolygonBatch()
+{
+	double xy[] = { 0, 0, 10, 0, 10, 10, 0, 10,  20, 0, 30, 0,  40, 0, 50, 0, 50, 10, 40, 10 };
+	int offsets[] = { 0, 4, 6, 10 };
+	TessResult *result = CreateTessResult();
+	int nTriangles = TessellatePolygonsToResult(result, xy, offsets, 3, false, CylindricalEquidistant, 0);
+	const TessRange *ranges = GetTessResultRanges(result);
+	bool passed = nTriangles == 4 && GetTessResultRangeCount(result) >= 2;
+	for (int r=0; passed && r<GetTessResultRangeCount(result); r++)
+		passed = (ranges[r].feature == 0 || ranges[r].feature == 2) && (r == 0 || ranges[r].feature >= ranges[r-1].feature);
+	Check(passed, "batched polygons keep their triangles under their own index");
+
+	double px, py, lon = 43, lat = 5.5;
+	ProjectPoints(CylindricalEquidistant, 0, &lon, &lat, &px, &py, 1);
+	Check(TrianglesHolding(result, px, py) == 1, "batched polygon is filled once");
+	DeleteTessResult(result);
+}
+
+// Cache files whose ranges or indices reach past the arrays are refused
+// both by LoadTessCache and by OpenTessCache, which draws from the mapping
+static void TestDamagedTessCache()
+{
+	double x[] = { 0, 10, 10, 0 }, y[] = { 0, 0, 10, 10 };
+	TessResult *result = CreateTessResult();
+	TessellatePolygonToResult(result, x, y, 4, true, CylindricalEquidistant, -90);
+	char fileName[] = "tesstest.wtri";
+	bool written = WriteTessCache(result, fileName, 0) != 0;
+	DeleteTessResult(result);
+	Check(written, "cache file written");
+	if (!written) return;
+
+	FILE *f = fopen(fileName, "rb");
+	std::vector<char> good;
+	int c;
+	while ((c = fgetc(f)) != EOF)
+		good.push_back((char)c);
+	fclose(f);
+	const TessCacheHeader &header = *(const TessCacheHeader *)&good[0];
+
+	for (int damage=0; damage<3; damage++)
+	{
+		std::vector<char> data(good);
+		TessCacheHeader &h = *(TessCacheHeader *)&data[0];
+		if (damage == 1)
+			((TessCacheRange *)&data[(size_t)TessCacheRangesOffset(h)])[0].firstIndex = h.indexCount;
+		else if (damage == 2)
+			((uint32_t *)&data[(size_t)TessCacheIndicesOffset(h)])[header.indexCount-1] = h.vertexCount;
+		f = fopen(fileName, "wb");
+		fwrite(&data[0], 1, data.size(), f);
+		fclose(f);
+
+		TessResult *loaded = LoadTessCache(fileName);
+		TessCacheMap *mapped = OpenTessCache(fileName);
+		Check((loaded != NULL) == (damage == 0), damage == 0 ? "good cache file loads" : "damaged cache file is not loaded");
+		Check((mapped != NULL) == (damage == 0), damage == 0 ? "good cache file opens" : "damaged cache file is not opened");
+		DeleteTessResult(loaded);
+		CloseTessCache(mapped);
+	}
+	remove(fileName);
+}
+
+static void PutInt(std::vector<char> &data, int value, bool bigEndian)
+{
+	for (int k=0; k<4; k++)
+		data.push_back((char)(value >> (bigEndian ? 24 - 8*k : 8*k)));
+}
+
+static void PutDouble(std::vector<char> &data, double value)
+{
+	char bytes[8];
+	memcpy(bytes, &value, 8);
+	data.insert(data.end(), bytes, bytes + 8);
+}
+
+static void PutShapeHeader(std::vector<char> &data, size_t fileSize, const double box[4])
+{
+	PutInt(data, 9994, true);
+	for (int k=0; k<5; k++)
+		PutInt(data, 0, true);
+	PutInt(data, (int)(fileSize / 2), true);
+	PutInt(data, 1000, false);
+	PutInt(data, 5, false);
+	for (int k=0; k<4; k++)
+		PutDouble(data, box[k]);
+	for (int k=0; k<4; k++)
+		PutDouble(data, 0);
+}
+
+static bool WriteFile(const char *fileName, const std::vector<char> &data)
+{
+	FILE *f = fopen(fileName, "wb");
+	if (f == NULL) return false;
+	bool written = fwrite(&data[0], 1, data.size(), f) == data.size();
+	return fclose(f) == 0 && written;
+}
+
+// A closed square ring, clockwise (an outer ring in a shapefile) or not
+static void AddSquare(std::vector<double> &xy, std::vector<int> &parts, double x, double y, double size, bool clockwise)
+{
+	double dx[] = { 0, 0, 1, 1, 0 }, dy[] = { 0, 1, 1, 0, 0 };
+	parts.push_back((int)(xy.size() / 2));
+	for (int k=0; k<5; k++)
+	{
+		xy.push_back(x + size * (clockwise ? dx[k] : dy[k]));
+		xy.push_back(y + size * (clockwise ? dy[k] : dx[k]));
+	}
+}
+
+// Write a polygon shapefile, with a .dbf of one numeric field, from each
+// record's parts and points
+static bool WriteShapefile(const char *baseName, const std::vector< std::vector<int> > &parts, const std::vector< std::vector<double> > &points)
+{
+	double box[4] = { 1e300, 1e300, -1e300, -1e300 };
+	std::vector<char> records, index;
+	for (size_t r=0; r<parts.size(); r++)
+	{
+		const std::vector<double> &xy = points[r];
+		double recordBox[4] = { 1e300, 1e300, -1e300, -1e300 };
+		for (size_t k=0; k<xy.size(); k+=2)
+		{
+			recordBox[0] = xy[k] < recordBox[0] ? xy[k] : recordBox[0];
+			recordBox[1] = xy[k+1] < recordBox[1] ? xy[k+1] : recordBox[1];
+			recordBox[2] = xy[k] > recordBox[2] ? xy[k] : recordBox[2];
+			recordBox[3] = xy[k+1] > recordBox[3] ? xy[k+1] : recordBox[3];
+		}
+		for (int k=0; k<2; k++)
+		{
+			box[k] = recordBox[k] < box[k] ? recordBox[k] : box[k];
+			box[k+2] = recordBox[k+2] > box[k+2] ? recordBox[k+2] : box[k+2];
+		}
+		int contentSize = 44 + 4 * (int)parts[r].size() + 8 * (int)xy.size();
+		PutInt(index, (int)((100 + records.size()) / 2), true);
+		PutInt(index, contentSize / 2, true);
+		PutInt(records, (int)r + 1, true);
+		PutInt(records, contentSize / 2, true);
+		PutInt(records, 5, false);
+		for (int k=0; k<4; k++)
+			PutDouble(records, recordBox[k]);
+		PutInt(records, (int)parts[r].size(), false);
+		PutInt(records, (int)(xy.size() / 2), false);
+		for (size_t p=0; p<parts[r].size(); p++)
+			PutInt(records, parts[r][p], false);
+		for (size_t k=0; k<xy.size(); k++)
+			PutDouble(records, xy[k]);
+	}
+
+	std::vector<char> shp, shx, dbf(32, 0);
+	PutShapeHeader(shp, 100 + records.size(), box);
+	shp.insert(shp.end(), records.begin(), records.end());
+	PutShapeHeader(shx, 100 + index.size(), box);
+	shx.insert(shx.end(), index.begin(), index.end());
+
+	// One field, ID, numbered from 1
+	dbf[0] = 3;
+	dbf[1] = 106; dbf[2] = 1; dbf[3] = 1;
+	int nRecords = (int)parts.size();
+	memcpy(&dbf[4], &nRecords, 4);
+	dbf[8] = 65; dbf[10] = 5;
+	std::vector<char> field(32, 0);
+	memcpy(&field[0], "ID", 2);
+	field[11] = 'N';
+	field[16] = 4;
+	dbf.insert(dbf.end(), field.begin(), field.end());
+	dbf.push_back(0x0d);
+	for (int r=0; r<nRecords; r++)
+	{
+		char record[16];
+		sprintf(record, " %4d", r + 1);
+		dbf.insert(dbf.end(), record, record + 5);
+	}
+	dbf.push_back(0x1a);
+
+	std::string base(baseName);
+	return WriteFile((base + ".shp").c_str(), shp) && WriteFile((base + ".shx").c_str(), shx) && WriteFile((base + ".dbf").c_str(), dbf);
+}
+
+// The shapefile reader gives a polygon record as one polygon whose rings are
+// its parts, as the bundled OGR does, whatever their orientation: two outer
+// rings and their holes (listed out of order) are rings 0..3 of one polygon,
+// and every ring is filled, so each hole is filled over its outer ring (in
+// the second color).  Read as a directory the same file goes through OGR,
+// which must give the same borders and fill.
+static void TestShapefileRings()
+{
+	std::vector< std::vector<int> > parts(2);
+	std::vector< std::vector<double> > points(2);
+	AddSquare(points[0], parts[0], 0, 0, 10, true);
+	AddSquare(points[0], parts[0], 20, 0, 10, true);
+	AddSquare(points[0], parts[0], 23, 3, 4, false);
+	AddSquare(points[0], parts[0], 3, 3, 4, false);
+	AddSquare(points[1], parts[1], 40, 0, 10, true);
+	AddSquare(points[1], parts[1], 43, 3, 4, false);
+
+	char directory[] = "tesstest_shp", fileName[] = "tesstest_shp/rings.shp";
+	mkdir(directory, 0777);
+	bool written = WriteShapefile("tesstest_shp/rings", parts, points);
+	Check(written, "shapefile written");
+	if (!written) return;
+
+	VectorFileGeometry *shape = LoadVectorFileGeometry(fileName, true, true, CylindricalEquidistant, 0);
+	VectorFileGeometry *ogr = LoadVectorFileGeometry(directory, true, true, CylindricalEquidistant, 0);
+	Check(GetVectorFileStatus(shape) == VectorFileOK, "shapefile read");
+	Check(GetVectorFileStatus(ogr) == VectorFileOK, "shapefile read through OGR");
+
+	// Every part in record order, numbered by its place in the record
+	int expectedFeature[] = { 0, 0, 0, 0, 1, 1 }, expectedRing[] = { 0, 1, 2, 3, 0, 1 };
+	double expectedX[] = { 0, 20, 23, 3, 40, 43 };
+	const TessRing *rings = GetVectorFileBorderRanges(shape);
+	const double *xy = GetVectorFileBorderPoints(shape);
+	bool passed = GetVectorFileBorderRangeCount(shape) == 6;
+	for (int r=0; passed && r<6; r++)
+	{
+		double x, y;
+		ProjectPoints(CylindricalEquidistant, 0, &expectedX[r], &expectedX[r], &x, &y, 1);
+		passed = rings[r].feature == expectedFeature[r] && rings[r].ring == expectedRing[r] && rings[r].nPoints == 5 &&
+			fabs(xy[rings[r].firstPoint * 2] - x) < 1e-6;
+	}
+	Check(passed, "shapefile borders are every part, numbered in record order");
+
+	double lon[] = { 1, 4, 21, 24, 41, 44 }, lat[] = { 2, 5.5, 2, 5.5, 2, 5.5 };
+	int expected[] = { 1, 2, 1, 2, 1, 2 };
+	double px[6], py[6];
+	ProjectPoints(CylindricalEquidistant, 0, lon, lat, px, py, 6);
+	passed = true;
+	for (int i=0; i<6; i++)
+		passed = passed && TrianglesHolding(GetVectorFileFill(shape), px[i], py[i]) == expected[i];
+	Check(passed, "shapefile fills every part of a polygon record");
+
+	if (GetVectorFileStatus(ogr) == VectorFileOK)
+	{
+		const TessRing *ogrRings = GetVectorFileBorderRanges(ogr);
+		const double *ogrXy = GetVectorFileBorderPoints(ogr);
+		passed = GetVectorFileBorderRangeCount(ogr) == GetVectorFileBorderRangeCount(shape) &&
+			GetVectorFileBorderPointCount(ogr) == GetVectorFileBorderPointCount(shape);
+		for (int r=0; passed && r<GetVectorFileBorderRangeCount(ogr); r++)
+			passed = ogrRings[r].feature == rings[r].feature && ogrRings[r].ring == rings[r].ring &&
+				ogrRings[r].nPoints == rings[r].nPoints && ogrRings[r].firstPoint == rings[r].firstPoint;
+		for (int k=0; passed && k<GetVectorFileBorderPointCount(ogr)*2; k++)
+			passed = fabs(ogrXy[k] - xy[k]) < 1e-9;
+		Check(passed, "shapefile borders match OGR's");
+		passed = true;
+		for (int i=0; i<6; i++)
+			passed = passed && TrianglesHolding(GetVectorFileFill(ogr), px[i], py[i]) == expected[i];
+		Check(passed, "shapefile fill matches OGR's");
+	}
+	DeleteVectorFileGeometry(shape);
+	DeleteVectorFileGeometry(ogr);
+	remove("tesstest_shp/rings.shp");
+	remove("tesstest_shp/rings.shx");
+	remove("tesstest_shp/rings.dbf");
+	rmdir(directory);
+}
+
+// A fill-only load of a file followed by a border-only one (basemapl then
+// basemapc) shares one parsed source instead of reading the file again
+static void TestSharedSource()
+{
+	std::vector< std::vector<int> > parts(1);
+	std::vector< std::vector<double> > points(1);
+	AddSquare(points[0], parts[0], 0, 0, 10, true);
+	char fileName[] = "tesstest_shared.shp";
+	bool written = WriteShapefile("tesstest_shared", parts, points);
+	Check(written, "shared source shapefile written");
+	if (!written) return;
+
+	VectorFileGeometry *fill = LoadVectorFileGeometryLods(fileName, true, false, CylindricalEquidistant, 0, 2, 0.05);
+	VectorFileGeometry *border = LoadVectorFileGeometryLods(fileName, false, true, CylindricalEquidistant, 0, 2, 0.05);
+	Check(fill->source == border->source, "a border-only load shares the source of a fill-only one");
+	Check(GetVectorFileBorderRangeCount(fill) == 0 && GetVectorFileBorderRangeCount(border) == 1 &&
+		GetTessResultIndexCount(GetVectorFileFill(border)) == 0 && GetTessResultIndexCount(GetVectorFileFill(fill)) > 0,
+		"geometries sharing a source project only what they asked for");
+	DeleteVectorFileGeometry(fill);
+	DeleteVectorFileGeometry(border);
+	remove("tesstest_shared.shp");
+	remove("tesstest_shared.shx");
+	remove("tesstest_shared.dbf");
+}
+
+// How far x,y is from the segment a-b
+static double SegmentDistance(const double *a, const double *b, double x, double y)
+{
+	double dx = b[0] - a[0], dy = b[1] - a[1];
+	double t = dx == 0 && dy == 0 ? 0 : ((x - a[0]) * dx + (y - a[1]) * dy) / (dx * dx + dy * dy);
+	t = t < 0 ? 0 : (t > 1 ? 1 : t);
+	return sqrt((a[0] + t * dx - x) * (a[0] + t * dx - x) + (a[1] + t * dy - y) * (a[1] + t * dy - y));
+}
+
+// Douglas-Peucker keeps the ends and the spike of a jagged line and leaves
+// every point within tolerance; Visvalingam-Whyatt keeps no triangle smaller
+// than its area; a batch spread over threads keeps what one thread does
+static void TestSimplify()
+{
+	std::vector<double> xy;
+	for (int i=0; i<=100; i++)
+	{
+		xy.push_back(i);
+		xy.push_back(i == 50 ? 5 : (i % 2) * 0.1);
+	}
+	std::vector<int> kept(101);
+	int nKept = SimplifyPolyline(&xy[0], 101, 0.5, SimplifyDouglasPeucker, &kept[0]);
+	bool passed = nKept >= 3 && nKept <= 5 && kept[0] == 0 && kept[nKept-1] == 100 &&
+		std::find(kept.begin(), kept.begin() + nKept, 50) != kept.begin() + nKept;
+	for (int k=0; passed && k+1<nKept; k++)
+		for (int i=kept[k]+1; passed && i<kept[k+1]; i++)
+			passed = SegmentDistance(&xy[kept[k]*2], &xy[kept[k+1]*2], xy[i*2], xy[i*2+1]) <= 0.5;
+	Check(passed, "Douglas-Peucker keeps the ends and spike and stays within tolerance");
+
+	nKept = SimplifyPolyline(&xy[0], 101, 1, SimplifyVisvalingam, &kept[0]);
+	passed = nKept >= 3 && kept[0] == 0 && kept[nKept-1] == 100 &&
+		std::find(kept.begin(), kept.begin() + nKept, 50) != kept.begin() + nKept;
+	for (int k=1; passed && k+1<nKept; k++)
+	{
+		const double *a = &xy[kept[k-1]*2], *b = &xy[kept[k]*2], *c = &xy[kept[k+1]*2];
+		passed = fabs((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])) / 2 >= 1;
+	}
+	Check(passed, "Visvalingam-Whyatt keeps the ends and spike and no smaller triangle");
+
+	// Enough points for the batch to be split over threads
+	const int nPolylines = 120, nEach = 1000;
+	std::vector<double> batch;
+	std::vector<int> offsets(1, 0);
+	for (int p=0; p<nPolylines; p++)
+	{
+		for (int i=0; i<nEach; i++)
+		{
+			batch.push_back(i);
+			batch.push_back(sin(i * 0.05 + p) * (1 + p % 7));
+		}
+		offsets.push_back((int)(batch.size() / 2));
+	}
+	for (int method=SimplifyDouglasPeucker; method<=SimplifyVisvalingam; method++)
+	{
+		std::vector<int> one(nPolylines * nEach), many(nPolylines * nEach);
+		std::vector<int> oneOffsets(nPolylines + 1), manyOffsets(nPolylines + 1);
+		int nOne = SimplifyPolylines(&batch[0], &offsets[0], nPolylines, 0.1, method, &one[0], &oneOffsets[0], 1);
+		int nMany = SimplifyPolylines(&batch[0], &offsets[0], nPolylines, 0.1, method, &many[0], &manyOffsets[0], 4);
+		Check(nOne > 2 * nPolylines && nOne < nPolylines * nEach && nOne == nMany &&
+			std::equal(one.begin(), one.begin() + nOne, many.begin()) && oneOffsets == manyOffsets,
+			method == SimplifyDouglasPeucker ? "threaded Douglas-Peucker batch matches one thread" : "threaded Visvalingam-Whyatt batch matches one thread");
+	}
+}
+
+// The border two polygons share simplifies to the same points in both, so
+// no gap opens between them at a coarser level of detail, even when the
+// second polygon's ring starts at rightStart along the border rather than at
+// a corner
+static void TestSharedBorderSimplify(int rightStart)
+{
+	// Two squares side by side, clockwise, the border between them wiggling
+	std::vector< std::vector<int> > parts(2, std::vector<int>(1, 0));
+	std::vector< std::vector<double> > points(2);
+	std::vector<double> border;
+	for (int k=0; k<=100; k++)
+	{
+		border.push_back(k == 0 || k == 100 ? 10 : 10 + (k % 2 ? 0.01 : -0.01));
+		border.push_back(k * 0.1);
+	}
+	double left[] = { 0, 0, 0, 10 }, right[] = { 20, 10, 20, 0 };
+	points[0].insert(points[0].end(), left, left + 4);
+	for (int k=100; k>=0; k--)
+	{
+		points[0].push_back(border[k*2]);
+		points[0].push_back(border[k*2+1]);
+	}
+	points[0].push_back(0);
+	points[0].push_back(0);
+	std::vector<double> ring(border.begin(), border.end());
+	ring.insert(ring.end(), right, right + 4);
+	points[1].insert(points[1].end(), ring.begin() + rightStart * 2, ring.end());
+	points[1].insert(points[1].end(), ring.begin(), ring.begin() + rightStart * 2 + 2);
+
+	char fileName[] = "tesstest_border.shp";
+	bool written = WriteShapefile("tesstest_border", parts, points);
+	Check(written, "shared border shapefile written");
+	if (!written) return;
+
+	VectorFileGeometry *geometry = LoadVectorFileGeometryLods(fileName, false, true, CylindricalEquidistant, 0, 2, 0.05);
+	Check(GetVectorFileLodCount(geometry) == 2, "shared border shapefile has two levels of detail");
+	SetVectorFileLod(geometry, 1);
+
+	// The points of each ring on the shared border, in projected units
+	double lon[] = { 9.9, 10.1 }, lat[] = { 0, 0 }, px[2], py[2];
+	ProjectPoints(CylindricalEquidistant, 0, lon, lat, px, py, 2);
+	std::vector< std::pair<double, double> > shared[2];
+	const TessRing *rings = GetVectorFileBorderRanges(geometry);
+	const double *xy = GetVectorFileBorderPoints(geometry);
+	int nRings = GetVectorFileBorderRangeCount(geometry);
+	for (int r=0; r<nRings; r++)
+	{
+		if (rings[r].feature < 0 || rings[r].feature > 1) continue;
+		for (int i=0; i<rings[r].nPoints; i++)
+		{
+			const double *p = xy + (rings[r].firstPoint + i) * 2;
+			if (p[0] > px[0] && p[0] < px[1])
+				shared[rings[r].feature].push_back(std::make_pair(p[0], p[1]));
+		}
+	}
+	for (int f=0; f<2; f++)
+		std::sort(shared[f].begin(), shared[f].end());
+	shared[0].erase(std::unique(shared[0].begin(), shared[0].end()), shared[0].end());
+	shared[1].erase(std::unique(shared[1].begin(), shared[1].end()), shared[1].end());
+	Check(nRings == 2 && shared[0].size() >= 2 && shared[0].size() < 101 && shared[0] == shared[1],
+		rightStart == 0 ? "a shared border simplifies to the same points in both polygons" :
+		"a shared border simplifies to the same points when a ring starts along it");
+	DeleteVectorFileGeometry(geometry);
+	remove("tesstest_border.shp");
+	remove("tesstest_border.shx");
+	remove("tesstest_border.dbf");
+}
+
+// Routes across a polygon, a circle and a polygon over the dateline give the
+// crossings expected, in route, hazard and entry order, each with where the
+// route's altitude is within the hazard's levels: part of a climb, all of a
+// level crossing, or none of one above the hazard
+static void TestRouteHazards()
+{
+	double routeXY[] = { -5, 5, 15, 5,  45, 0, 55, 0,  170, 5, -170, 5,  -5, 5, 15, 5 };
+	double routeAltitudes[] = { 0, 800,  200, 200,  200, 200,  350, 350 };
+	int routeOffsets[] = { 0, 2, 4, 6, 8 };
+	double hazardXY[] = { 0, 0, 10, 0, 10, 10, 0, 10,  50, 0,  175, 0, -175, 0, -175, 10, 175, 10 };
+	int hazardOffsets[] = { 0, 4, 5, 9 };
+	double radius[] = { 0, 2, 0 }, lower[] = { 100, 0, 100 }, upper[] = { 300, 1000, 300 };
+	RouteHazardResult *result = IntersectRoutesWithHazards(routeXY, routeAltitudes, routeOffsets, 4, hazardXY, hazardOffsets, 3, radius, lower, upper, 1);
+
+	int expectedRoute[] = { 0, 1, 2, 3 }, expectedHazard[] = { 0, 1, 2, 0 }, expectedOverlap[] = { 1, 1, 1, 0 };
+	double expectedEntry[] = { 0.25, 0.3, 0.25, 0.25 }, expectedExit[] = { 0.75, 0.7, 0.75, 0.75 };
+	double expectedEntryLon[] = { 0, 48, 175, 0 }, expectedExitLon[] = { 10, 52, -175, 10 };
+	double expectedOverlapEntry[] = { 0.25, 0.3, 0.25, 0 }, expectedOverlapExit[] = { 0.375, 0.7, 0.75, 0 };
+	const RouteHazardCrossing *crossings = GetRouteHazardCrossings(result);
+	bool passed = GetRouteHazardCrossingCount(result) == 4;
+	for (int i=0; passed && i<4; i++)
+	{
+		const RouteHazardCrossing &c = crossings[i];
+		passed = c.route == expectedRoute[i] && c.hazard == expectedHazard[i] &&
+			fabs(c.entryPosition - expectedEntry[i]) < 1e-9 && fabs(c.exitPosition - expectedExit[i]) < 1e-9 &&
+			fabs(c.entryLon - expectedEntryLon[i]) < 1e-9 && fabs(c.exitLon - expectedExitLon[i]) < 1e-9 &&
+			c.altitudeOverlap == expectedOverlap[i];
+		if (passed && c.altitudeOverlap)
+			passed = fabs(c.overlapEntryPosition - expectedOverlapEntry[i]) < 1e-9 && fabs(c.overlapExitPosition - expectedOverlapExit[i]) < 1e-9;
+	}
+	Check(passed, "routes cross a polygon, a circle and a polygon over the dateline where expected, within levels or not");
+
+	// The same crossings whatever the number of threads
+	RouteHazardResult *threaded = IntersectRoutesWithHazards(routeXY, routeAltitudes, routeOffsets, 4, hazardXY, hazardOffsets, 3, radius, lower, upper, 4);
+	Check(GetRouteHazardCrossingCount(threaded) == GetRouteHazardCrossingCount(result) &&
+		memcmp(GetRouteHazardCrossings(threaded), crossings, GetRouteHazardCrossingCount(result) * sizeof(RouteHazardCrossing)) == 0,
+		"threaded route hazard crossings match one thread");
+	DeleteRouteHazardResult(threaded);
+	DeleteRouteHazardResult(result);
+}
+
+// A hazard drifting east at 60 knots (a degree of arc an hour) toward routes
+// at its latitude: one holding still ahead of it is met when the hazard's
+// leading edge reaches it, one flying west toward it sooner, when the two
+// close the gap between them, and one the hazard drifts away from never
+static void TestMovingHazards()
+{
+	double routeXY[] = { 5, 1, 5, 1.001,  10, 1, 0, 1,  5, 1, 5, 1.001 };
+	double routeTimes[] = { 0, 36000,  0, 36000,  0, 36000 };
+	double routeAltitudes[] = { 200, 200,  200, 200,  200, 200 };
+	int routeOffsets[] = { 0, 2, 4, 6 };
+	double hazardXY[] = { 0, 0, 2, 0, 2, 2, 0, 2,  0, 0, 2, 0, 2, 2, 0, 2,  0, 0, 2, 0, 2, 2, 0, 2 };
+	int hazardOffsets[] = { 0, 4, 8, 12 };
+	double lower[] = { 0, 0, 0 }, upper[] = { 1000, 1000, 1000 };
+	double direction[] = { 90, 90, 270 }, speed[] = { 60, 60, 60 };
+	double start[] = { 0, 0, 0 }, end[] = { 36000, 36000, 36000 };
+	MovingHazardConflict conflicts[3];
+	int nFound = FindMovingHazardConflicts(routeXY, routeTimes, routeAltitudes, routeOffsets, hazardXY, hazardOffsets, NULL, lower, upper,
+		direction, speed, start, end, 3, conflicts, 1);
+
+	// Longitude degrees are shorter by the cosine of the hazard's middle
+	// latitude, so it crosses them faster
+	double c = cos(1 * 3.14159265358979323846 / 180);
+	double held = 3 * 3600 * c, closing = 8 * 3600 / (1 + 1 / c);
+	Check(nFound == 2 && conflicts[0].conflict && fabs(conflicts[0].time - held) < 1e-6 && fabs(conflicts[0].lon - 5) < 1e-9 &&
+		conflicts[1].conflict && fabs(conflicts[1].time - closing) < 1e-6 && fabs(conflicts[1].lon - (10 - closing / 3600)) < 1e-9 &&
+		!conflicts[2].conflict,
+		"a drifting hazard meets routes when its leading edge reaches them, and never when it drifts away");
+}
+
+// Log lines cut to the display length end on a whole UTF-8 character: one
+// cut inside a two byte character loses all of it, one cut just after a
+// three byte character keeps it, and a short line comes back whole
+static void TestLogIndexEntries()
+{
+	const char *fileName = "tesstest_log.txt";
+	FILE *f = fopen(fileName, "wb");
+	fputs("abc\xC3\xA9 {}\na\xE2\x82\xACx {}\n\xC3\xA9\n", f);
+	fclose(f);
+
+	char name[] = "tesstest_log.txt";
+	LogIndex *index = OpenLogIndex(name, 1);
+	char buffer[3 * 4];
+	int lengths[3];
+	int n = index != NULL ? ReadLogIndexEntries(index, 0, 3, 4, buffer, lengths) : 0;
+	Check(n == 3 && lengths[0] == 3 && memcmp(buffer, "abc", 3) == 0 &&
+		lengths[1] == 4 && memcmp(buffer + 4, "a\xE2\x82\xAC", 4) == 0 &&
+		lengths[2] == 2 && memcmp(buffer + 8, "\xC3\xA9", 2) == 0,
+		"log lines cut to length end on a UTF-8 character boundary");
+	CloseLogIndex(index);
+	remove(fileName);
+}
+
+int main()
+{
+	TestArena();
+	TestEarcut();
+	TestUnionHole();
+	TestHemisphereSplit();
+	TestPolygonBatch();
+	TestDamagedTessCache();
+	TestShapefileRings();
+	TestSharedSource();
+	TestSimplify();
+	TestSharedBorderSimplify(0);
+	TestSharedBorderSimplify(51);
+	TestRouteHazards();
+	TestMovingHazards();
+	TestLogIndexEntries();
+
+	if (failures > 0)
+	{
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,810 @@
+#include "stdafx.h"
+#include "tessellate.h"
+#include "glut.h"
+#include "tesscommon.h"
+#include "vectorfile.h"
+#include "tessresult.h"
+#include "simplify.h"
+#include "projection.h"
+#include "shapefile.h"
+#include "geometrycache.h"
+#include "ogr_api.h"
+#include <math.h>
+#include <limits.h>
+#include <string.h>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Append the longitude and latitude of the points of an OGR line string or
+// ring to ringSet
+static void AddRing(RingSet *ringSet, OGRGeometryH poRing, int feature, int ring, int minPoints)
+{
+	TessRing info;
+	info.feature = feature;
+	info.ring = ring;
+	info.firstPoint = (int)(ringSet->xy.size() / 2);
+
+	int nPoints = OGR_G_GetPointCount(poRing);
+	for (int iPoints = 0; iPoints < nPoints; iPoints++)
+	{
+		double _x, _y, _z;
+		OGR_G_GetPoint(poRing, iPoints, &_x, &_y, &_z);
+		ringSet->xy.push_back(_x);
+		ringSet->xy.push_back(_y);
+	}
+
+	info.nPoints = (int)(ringSet->xy.size() / 2) - info.firstPoint;
+	if (info.nPoints >= minPoints)
+		ringSet->rings.push_back(info);
+	else
+		ringSet->xy.resize(info.firstPoint * 2);
+}
+
+void ProjectRingSet(RingSet &ringSet, const ProjectionParams &params, bool closed, int minPoints)
+{
+	// Clip away what lies beyond the visible hemisphere of an azimuthal projection
+	if (IsAzimuthal(params.mapProjection))
+	{
+		std::vector<double> xy;
+		std::vector<int> starts;
+		std::vector<TessRing> rings;
+		xy.reserve(ringSet.xy.size());
+		for (size_t r=0; r<ringSet.rings.size(); r++)
+		{
+			const TessRing &info = ringSet.rings[r];
+			const double *points = &ringSet.xy[info.firstPoint * 2];
+			size_t firstPiece = starts.size();
+			if (closed)
+				ClipRingToHemisphere(points, info.nPoints, xy, starts);
+			else
+				ClipLineToHemisphere(points, info.nPoints, xy, starts);
+
+			for (size_t p=firstPiece; p<starts.size(); p++)
+			{
+				TessRing piece = info;
+				piece.firstPoint = starts[p];
+				piece.nPoints = (p + 1 < starts.size() ? starts[p+1] : (int)(xy.size() / 2)) - starts[p];
+				if (piece.nPoints >= minPoints)
+					rings.push_back(piece);
+			}
+		}
+		ringSet.xy.swap(xy);
+		ringSet.rings.swap(rings);
+	}
+
+	ProjectInterleaved(params, ringSet.xy.empty() ? NULL : &ringSet.xy[0], (int)(ringSet.xy.size() / 2));
+}
+
+// Append part of a shapefile record to ringSet, copying its points out of the
+// mapping
+static void AddShapePart(RingSet *ringSet, const ShapeRecord &record, int part, int feature, int ring, int minPoints)
+{
+	int firstPoint, endPoint = record.nPoints;
+	memcpy(&firstPoint, &record.parts[part], sizeof(int));
+	if (part + 1 < record.nParts)
+		memcpy(&endPoint, &record.parts[part+1], sizeof(int));
+	if (firstPoint < 0 || endPoint > record.nPoints || endPoint - firstPoint < minPoints) return;
+
+	TessRing info;
+	info.feature = feature;
+	info.ring = ring;
+	info.firstPoint = (int)(ringSet->xy.size() / 2);
+	info.nPoints = endPoint - firstPoint;
+	ringSet->xy.resize(ringSet->xy.size() + info.nPoints * 2);
+	memcpy(&ringSet->xy[info.firstPoint * 2], &record.points[firstPoint * 2], info.nPoints * 2 * sizeof(double));
+	ringSet->rings.push_back(info);
+}
+
+// Read a run of shapefile records the way OGR hands them to ReadVectorFile: a
+// polygon record is one polygon whose rings are its parts, and a polyline is
+// a line string only if it has a single part.  Deleted records have a
+// feature number of -1.
+static void ReadShapeRun(const ShapeFile *shapes, const int *featureNumbers, int firstRecord, int endRecord, RingSet *fills, RingSet *borders)
+{
+	for (int i=firstRecord; i<endRecord; i++)
+	{
+		ShapeRecord record;
+		if (featureNumbers[i] < 0 || !shapes->Record(i, record) || record.nParts == 0) continue;
+
+		if (IsPolygonShape(record.shapeType))
+		{
+			for (int p=0; p<record.nParts; p++)
+			{
+				if (fills != NULL)
+					AddShapePart(fills, record, p, featureNumbers[i], p, 3);
+				if (borders != NULL)
+					AddShapePart(borders, record, p, featureNumbers[i], p, 2);
+			}
+		}
+		else if (IsPolyShape(record.shapeType) && record.nParts == 1 && borders != NULL)
+			AddShapePart(borders, record, 0, featureNumbers[i], 0, 2);
+	}
+}
+
+static void AppendRingSet(RingSet *ringSet, const RingSet &part)
+{
+	int pointOffset = (int)(ringSet->xy.size() / 2);
+	ringSet->xy.insert(ringSet->xy.end(), part.xy.begin(), part.xy.end());
+	for (size_t r=0; r<part.rings.size(); r++)
+	{
+		ringSet->rings.push_back(part.rings[r]);
+		ringSet->rings.back().firstPoint += pointOffset;
+	}
+}
+
+// Shapefiles with fewer points than this are read on one thread
+static const int minShapePointsPerThread = 50000;
+
+// Read a shapefile from its mapped .shp and .shx.  Returns false if fileName
+// is not a shapefile, leaving it to OGR.
+static bool ReadShapeFile(const char *fileName, RingSet *fills, RingSet *borders, int &nFeatures)
+{
+	ShapeFile shapes;
+	if (!shapes.Open(fileName)) return false;
+
+	int nRecords = shapes.RecordCount();
+	std::vector<int> featureNumbers(nRecords);
+	nFeatures = 0;
+	for (int i=0; i<nRecords; i++)
+		featureNumbers[i] = shapes.IsDeleted(i) ? -1 : nFeatures++;
+	if (nRecords == 0) return true;
+
+	// Split the records into runs of about the same size in the .shp; each
+	// run is read into its own ring sets, appended in order afterwards
+	unsigned long long fileSize = shapes.RecordOffset(nRecords - 1);
+	int nThreads = WorkerThreadCount(0, (int)(fileSize / 16), minShapePointsPerThread);
+	if (nThreads > nRecords) nThreads = nRecords;
+	if (nThreads <= 1)
+	{
+		ReadShapeRun(&shapes, &featureNumbers[0], 0, nRecords, fills, borders);
+		return true;
+	}
+
+	std::vector<int> runStart(nThreads + 1, nRecords);
+	runStart[0] = 0;
+	int run = 1;
+	for (int i=0; i<nRecords && run<nThreads; i++)
+		if ((double)shapes.RecordOffset(i) >= (double)fileSize * run / nThreads)
+			runStart[run++] = i;
+
+	std::vector<RingSet> partialFills(nThreads), partialBorders(nThreads);
+	std::vector<std::thread> workers;
+	for (int t=1; t<nThreads; t++)
+		workers.push_back(std::thread(ReadShapeRun, &shapes, &featureNumbers[0], runStart[t], runStart[t+1],
+			fills != NULL ? &partialFills[t] : NULL, borders != NULL ? &partialBorders[t] : NULL));
+	ReadShapeRun(&shapes, &featureNumbers[0], runStart[0], runStart[1],
+		fills != NULL ? &partialFills[0] : NULL, borders != NULL ? &partialBorders[0] : NULL);
+	for (size_t t=0; t<workers.size(); t++)
+		workers[t].join();
+
+	for (int t=0; t<nThreads; t++)
+	{
+		if (fills != NULL)
+			AppendRingSet(fills, partialFills[t]);
+		if (borders != NULL)
+			AppendRingSet(borders, partialBorders[t]);
+	}
+	return true;
+}
+
+// OGR is not thread safe; files are read through it one at a time
+static std::mutex ogrLock;
+
+static VectorFileStatus ReadOgrFile(const char *fileName, RingSet *fills, RingSet *borders, int &nFeatures)
+{
+	std::lock_guard<std::mutex> lock(ogrLock);
+
+	// Register all OGR drivers
+	OGRRegisterAll();
+
+	// Open the OGR data source
+	OGRDataSourceH poDS;
+	OGRSFDriverH driver;
+	poDS = OGROpen(fileName, FALSE, &driver);
+	if (poDS == NULL) return VectorFileOpenError;
+
+	// Get the first (and only in this case) layer
+	if (OGR_DS_GetLayerCount(poDS) < 1)
+	{
+		OGR_DS_Destroy(poDS);
+		return VectorFileLayerError;
+	}
+	OGRLayerH poLayer = OGR_DS_GetLayer(poDS,0);
+	OGR_L_ResetReading(poLayer);
+
+	// Extract the features
+	int feature = 0;
+	OGRFeatureH poFeature;
+	while ((poFeature = OGR_L_GetNextFeature(poLayer)) != NULL)
+	{
+		OGRGeometryH poGeometry = OGR_F_GetGeometryRef(poFeature);
+		if (poGeometry != NULL)
+		{
+			int geometryType = wkbFlatten(OGR_G_GetGeometryType(poGeometry));
+			int numGeometries = OGR_G_GetGeometryCount(poGeometry);
+			if (geometryType == wkbPolygon || geometryType == wkbMultiPolygon)
+			{
+				for (int i=0; i<numGeometries; i++)
+				{
+					// Pull out the ring (polygon) or part (multipolygon)
+					OGRGeometryH poShape = OGR_G_GetGeometryRef(poGeometry, i);
+					if (poShape == NULL) continue;
+
+					if (geometryType == wkbMultiPolygon)
+					{
+						OGRGeometryH poOuter = OGR_G_GetGeometryRef(poShape, 0);
+						if (fills != NULL && poOuter != NULL)
+							AddRing(fills, poOuter, feature, i, 3);
+						if (borders != NULL)
+						{
+							int numParts = OGR_G_GetGeometryCount(poShape);
+							for (int j=0; j<numParts; j++)
+								AddRing(borders, OGR_G_GetGeometryRef(poShape, j), feature, i, 2);
+						}
+					}
+					else
+					{
+						if (fills != NULL)
+							AddRing(fills, poShape, feature, i, 3);
+						if (borders != NULL)
+							AddRing(borders, poShape, feature, i, 2);
+					}
+				}
+			}
+			else if (geometryType == wkbLineString && numGeometries == 0 && borders != NULL)
+				AddRing(borders, poGeometry, feature, 0, 2);
+		}
+		OGR_F_Destroy(poFeature);
+		feature++;
+	}
+	nFeatures = feature;
+
+	// OGR Cleanup
+	OGR_DS_Destroy(poDS);
+	return VectorFileOK;
+}
+
+VectorFileStatus ReadVectorFile(const char *fileName, MapProjections mapProjection, double centralLongitude, RingSet *fills, RingSet *borders)
+{
+	// Shapefiles are read straight from their mapped files; OGR reads the rest
+	int nFeatures = 0;
+	if (!ReadShapeFile(fileName, fills, borders, nFeatures))
+	{
+		VectorFileStatus status = ReadOgrFile(fileName, fills, borders, nFeatures);
+		if (status != VectorFileOK) return status;
+	}
+
+	// Project everything kept in one batch per set
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	if (fills != NULL)
+	{
+		fills->nFeatures = nFeatures;
+		ProjectRingSet(*fills, params, true, 3);
+	}
+	if (borders != NULL)
+	{
+		borders->nFeatures = nFeatures;
+		ProjectRingSet(*borders, params, false, 2);
+	}
+	return VectorFileOK;
+}
+
+extern "C" TESSELLATE_API VectorFileGeometry* LoadVectorFileGeometry(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude)
+{
+	return LoadVectorFileGeometryLods(vectorFileName, loadFill, loadBorder, mapProjection, centralLongitude, 1, 0);
+}
+
+// A triangle survives a projection if its corners stay on the visible side of
+// an azimuthal cutoff, project to finite points and keep their winding.  When
+// every triangle of a ring does, they still tile the projected ring exactly.
+static bool TriangleProjects(const double *source, const double *projected, const unsigned int *corner, bool azimuthal)
+{
+	for (int k=0; k<3; k++)
+	{
+		const double *p = &projected[corner[k]*2];
+		if (!(fabs(p[0]) < HUGE_VAL && fabs(p[1]) < HUGE_VAL)) return false;
+		if (azimuthal && source[corner[k]*2+1] <= MinAzimuthalLatitude) return false;
+	}
+
+	const double *a = &source[corner[0]*2], *b = &source[corner[1]*2], *c = &source[corner[2]*2];
+	double sourceArea = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+	a = &projected[corner[0]*2]; b = &projected[corner[1]*2]; c = &projected[corner[2]*2];
+	double projectedArea = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+
+	// Triangles squashed flat (at a pole) are harmless
+	return projectedArea == 0 || (sourceArea > 0) == (projectedArea > 0);
+}
+
+// Project a level's fill and borders, as asked, from its source.  Returns the
+// number of fill rings that had to be tessellated again.
+static int ProjectVectorFileLod(VectorFileLod &level, const ProjectionParams &params, bool projectFill, bool projectBorder)
+{
+	level.border = RingSet();
+	if (projectBorder)
+	{
+		level.border = level.source->border;
+		ProjectRingSet(level.border, params, false, 2);
+	}
+
+	const TessResult &source = *level.source->triangles;
+	const RingSet &sourceFill = level.source->fill;
+	TessResult &fill = *level.fill;
+	fill.vertices.clear();
+	fill.indices.clear();
+	fill.ranges.clear();
+	if (!projectFill || source.vertices.empty()) return 0;
+	fill.vertices = source.vertices;
+	ProjectInterleaved(params, &fill.vertices[0], (int)(fill.vertices.size() / 2));
+
+	// Source rings by feature and ring number, for the ranges that need them
+	std::map<std::pair<int,int>, size_t> ringIndex;
+	for (size_t r=0; r<sourceFill.rings.size(); r++)
+		ringIndex[std::make_pair(sourceFill.rings[r].feature, sourceFill.rings[r].ring)] = r;
+
+	// Ranges are rebuilt in their original order so two color fills still
+	// stack the same way
+	bool azimuthal = IsAzimuthal(params.mapProjection);
+	std::vector<double> ringPoints;
+	TessRecorder recorder(&fill);
+	int nRetessellated = 0;
+	for (size_t r=0; r<source.ranges.size(); r++)
+	{
+		const TessRange &range = source.ranges[r];
+		const unsigned int *indices = &source.indices[range.firstIndex];
+		bool valid = true;
+		for (unsigned int i=0; i<range.indexCount && valid; i+=3)
+			valid = TriangleProjects(&source.vertices[0], &fill.vertices[0], &indices[i], azimuthal);
+
+		if (valid)
+		{
+			TessRange projected = range;
+			projected.firstIndex = (unsigned int)fill.indices.size();
+			fill.indices.insert(fill.indices.end(), indices, indices + range.indexCount);
+			fill.ranges.push_back(projected);
+			continue;
+		}
+
+		std::map<std::pair<int,int>, size_t>::const_iterator found = ringIndex.find(std::make_pair(range.feature, range.ring));
+		if (found == ringIndex.end()) continue;
+
+		// Clip the ring the way ReadVectorFile does and tessellate it projected
+		RingSet ring;
+		const TessRing &info = sourceFill.rings[found->second];
+		ring.xy.assign(sourceFill.xy.begin() + info.firstPoint * 2, sourceFill.xy.begin() + (info.firstPoint + info.nPoints) * 2);
+		TessRing whole = info;
+		whole.firstPoint = 0;
+		ring.rings.push_back(whole);
+		ProjectRingSet(ring, params, true, 3);
+		if (ring.rings.empty()) continue;
+
+		// Points the projection cannot place (Mercator at a pole) are not
+		// handed to the tessellator
+		bool finite = true;
+		for (size_t i=0; i<ring.xy.size() && finite; i++)
+			finite = fabs(ring.xy[i]) < HUGE_VAL;
+		if (!finite) continue;
+
+		for (size_t p=0; p<ring.rings.size(); p++)
+			recorder.AddRing(&ring.xy[ring.rings[p].firstPoint * 2], ring.rings[p].nPoints, range.feature, range.ring);
+		nRetessellated++;
+	}
+	return nRetessellated;
+}
+
+static void ExtendBox(RTreeBox &box, const double *p)
+{
+	if (!(fabs(p[0]) < HUGE_VAL && fabs(p[1]) < HUGE_VAL)) return;
+	if (p[0] < box.left) box.left = p[0];
+	if (p[0] > box.right) box.right = p[0];
+	if (p[1] < box.bottom) box.bottom = p[1];
+	if (p[1] > box.top) box.top = p[1];
+}
+
+// Group a level's fill ranges and border rings by feature, both being in
+// feature order, and index the projected bounds of each feature
+static void IndexVectorFileLod(VectorFileLod &level)
+{
+	const TessResult &fill = *level.fill;
+	const RingSet &border = level.border;
+	level.features.clear();
+	level.bounds.clear();
+
+	size_t r = 0, b = 0;
+	while (r < fill.ranges.size() || b < border.rings.size())
+	{
+		int feature = INT_MAX;
+		if (r < fill.ranges.size())
+			feature = fill.ranges[r].feature;
+		if (b < border.rings.size() && border.rings[b].feature < feature)
+			feature = border.rings[b].feature;
+
+		VectorFileFeature span;
+		span.feature = feature;
+		span.firstRange = (int)r;
+		span.firstRing = (int)b;
+		RTreeBox box = { HUGE_VAL, -HUGE_VAL, HUGE_VAL, -HUGE_VAL };
+		for (; r < fill.ranges.size() && fill.ranges[r].feature == feature; r++)
+		{
+			const TessRange &range = fill.ranges[r];
+			for (unsigned int i=0; i<range.indexCount; i++)
+				ExtendBox(box, &fill.vertices[fill.indices[range.firstIndex + i] * 2]);
+		}
+		for (; b < border.rings.size() && border.rings[b].feature == feature; b++)
+		{
+			const TessRing &ring = border.rings[b];
+			for (int i=0; i<ring.nPoints; i++)
+				ExtendBox(box, &border.xy[(ring.firstPoint + i) * 2]);
+		}
+		span.nRanges = (int)r - span.firstRange;
+		span.nRings = (int)b - span.firstRing;
+
+		if (box.left <= box.right)
+		{
+			level.features.push_back(span);
+			level.bounds.push_back(box);
+		}
+	}
+
+	level.index.Build(level.bounds);
+}
+
+VectorFileSource* BuildVectorFileSource(const char *fileName, bool loadFill, bool loadBorder, int nLods, double baseTolerance)
+{
+	if (nLods < 1 || baseTolerance <= 0) nLods = 1;
+
+	VectorFileSource *source = new VectorFileSource;
+	source->hasFill = loadFill;
+	source->hasBorder = loadBorder;
+	source->baseTolerance = baseTolerance;
+	source->refCount = 0;
+	source->cacheTime = 0;
+	source->lods.resize(nLods);
+	for (int lod=0; lod<nLods; lod++)
+	{
+		// Each level allows four times the error of the one before it
+		source->lods[lod].tolerance = lod == 0 ? 0 : baseTolerance * pow(4.0, lod - 1);
+		source->lods[lod].triangles = new TessResult;
+	}
+
+	// Read and triangulate in longitude/latitude
+	VectorFileSourceLod &full = source->lods[0];
+	source->status = ReadVectorFile(fileName, CylindricalEquidistant, 0, loadFill ? &full.fill : NULL, loadBorder ? &full.border : NULL);
+	source->nFeatures = loadFill ? full.fill.nFeatures : full.border.nFeatures;
+	if (loadFill)
+		TessellateRings(full.fill, full.triangles);
+
+	// Simplify the coarser levels from the full detail rings
+	for (int lod=1; lod<nLods; lod++)
+	{
+		VectorFileSourceLod &level = source->lods[lod];
+		if (loadFill)
+		{
+			SimplifyRingSet(full.fill, level.tolerance, 4, level.fill);
+			TessellateRings(level.fill, level.triangles);
+		}
+		if (loadBorder)
+			SimplifyRingSet(full.border, level.tolerance, 4, level.border);
+	}
+	return source;
+}
+
+void DeleteVectorFileSource(VectorFileSource *source)
+{
+	if (source == NULL) return;
+	for (size_t lod=0; lod<source->lods.size(); lod++)
+		delete source->lods[lod].triangles;
+	for (size_t v=0; v<source->variants.size(); v++)
+		for (size_t lod=0; lod<source->variants[v].lods.size(); lod++)
+			delete source->variants[v].lods[lod].fill;
+	delete source;
+}
+
+void ProjectVectorFileVariant(const VectorFileSource *source, MapProjections mapProjection, double centralLongitude, VectorFileVariant &variant)
+{
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	variant.mapProjection = mapProjection;
+	variant.centralLongitude = centralLongitude;
+	variant.lods.resize(source->lods.size());
+	for (size_t lod=0; lod<source->lods.size(); lod++)
+	{
+		VectorFileLod level;
+		level.tolerance = source->lods[lod].tolerance;
+		level.source = &source->lods[lod];
+		level.fill = new TessResult;
+		ProjectVectorFileLod(level, params, source->hasFill, source->hasBorder);
+		IndexVectorFileLod(level);
+
+		VectorFileVariantLod &projected = variant.lods[lod];
+		projected.fill = level.fill;
+		projected.border.xy.swap(level.border.xy);
+		projected.border.rings.swap(level.border.rings);
+		projected.border.nFeatures = level.border.nFeatures;
+		projected.features.swap(level.features);
+		projected.bounds.swap(level.bounds);
+	}
+}
+
+extern "C" TESSELLATE_API VectorFileGeometry* LoadVectorFileGeometryLods(char* vectorFileName, bool loadFill, bool loadBorder, MapProjections mapProjection, double centralLongitude, int nLods, double baseTolerance)
+{
+	if (nLods < 1 || baseTolerance <= 0) nLods = 1;
+
+	// The parsed and triangulated file comes from the cache, shared with every
+	// other geometry loaded from it
+	VectorFileGeometry *geometry = new VectorFileGeometry;
+	geometry->source = AcquireVectorFileSource(vectorFileName, loadFill, loadBorder, nLods, baseTolerance);
+	geometry->status = geometry->source->status;
+	geometry->nFeatures = geometry->source->nFeatures;
+	geometry->hasFill = loadFill;
+	geometry->hasBorder = loadBorder;
+	geometry->currentLod = 0;
+	geometry->lods.resize(nLods);
+	for (int lod=0; lod<nLods; lod++)
+	{
+		geometry->lods[lod].source = &geometry->source->lods[lod];
+		geometry->lods[lod].tolerance = geometry->source->lods[lod].tolerance;
+		geometry->lods[lod].fill = new TessResult;
+	}
+
+	ReprojectVectorFileGeometry(geometry, mapProjection, centralLongitude);
+	return geometry;
+}
+
+// Copy a projected level out of a bundle variant.  The variant's feature
+// bounds cover everything its source has, so a geometry using only part of
+// that indexes its own.
+static void UseVariantLod(VectorFileLod &level, const VectorFileVariantLod &variant, bool useFill, bool useBorder, bool useAll)
+{
+	if (useFill)
+		*level.fill = *variant.fill;
+	else
+		*level.fill = TessResult();
+	level.border = useBorder ? variant.border : RingSet();
+
+	if (useAll)
+	{
+		level.features = variant.features;
+		level.bounds = variant.bounds;
+		level.index.Build(level.bounds);
+	}
+	else
+		IndexVectorFileLod(level);
+}
+
+extern "C" TESSELLATE_API int ReprojectVectorFileGeometry(VectorFileGeometry* geometry, MapProjections mapProjection, double centralLongitude)
+{
+	if (geometry == NULL) return 0;
+
+	geometry->mapProjection = mapProjection;
+	geometry->centralLongitude = centralLongitude;
+
+	// A source from a bundle may have been projected this way already
+	const VectorFileSource *source = geometry->source;
+	bool useAll = geometry->hasFill == source->hasFill && geometry->hasBorder == source->hasBorder;
+	for (size_t v=0; v<source->variants.size(); v++)
+	{
+		const VectorFileVariant &variant = source->variants[v];
+		if (variant.mapProjection == mapProjection && variant.centralLongitude == centralLongitude &&
+			variant.lods.size() >= geometry->lods.size())
+		{
+			for (size_t lod=0; lod<geometry->lods.size(); lod++)
+				UseVariantLod(geometry->lods[lod], variant.lods[lod], geometry->hasFill, geometry->hasBorder, useAll);
+			return 0;
+		}
+	}
+
+	ProjectionParams params;
+	InitProjection(params, mapProjection, centralLongitude);
+	int nRetessellated = 0;
+	for (size_t lod=0; lod<geometry->lods.size(); lod++)
+	{
+		nRetessellated += ProjectVectorFileLod(geometry->lods[lod], params, geometry->hasFill, geometry->hasBorder);
+		IndexVectorFileLod(geometry->lods[lod]);
+	}
+	return nRetessellated;
+}
+
+extern "C" TESSELLATE_API void DeleteVectorFileGeometry(VectorFileGeometry* geometry)
+{
+	if (geometry == NULL) return;
+	for (size_t lod=0; lod<geometry->lods.size(); lod++)
+		delete geometry->lods[lod].fill;
+	ReleaseVectorFileSource(geometry->source);
+	delete geometry;
+}
+
+extern "C" TESSELLATE_API int GetVectorFileLodCount(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? (int)geometry->lods.size() : 0;
+}
+
+extern "C" TESSELLATE_API double GetVectorFileLodTolerance(VectorFileGeometry* geometry, int lod)
+{
+	if (geometry == NULL || lod < 0 || lod >= (int)geometry->lods.size()) return 0;
+	return geometry->lods[lod].tolerance;
+}
+
+extern "C" TESSELLATE_API int SelectVectorFileLod(VectorFileGeometry* geometry, double mapUnitsPerPixel)
+{
+	if (geometry == NULL) return 0;
+
+	// The coarsest level whose error stays under half a pixel
+	int lod = 0;
+	while (lod + 1 < (int)geometry->lods.size() && geometry->lods[lod+1].tolerance <= mapUnitsPerPixel * 0.5)
+		lod++;
+	geometry->currentLod = lod;
+	return lod;
+}
+
+extern "C" TESSELLATE_API void SetVectorFileLod(VectorFileGeometry* geometry, int lod)
+{
+	if (geometry == NULL || lod < 0 || lod >= (int)geometry->lods.size()) return;
+	geometry->currentLod = lod;
+}
+
+extern "C" TESSELLATE_API int GetVectorFileStatus(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? geometry->status : VectorFileOpenError;
+}
+
+extern "C" TESSELLATE_API int GetVectorFileFeatureCount(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? geometry->nFeatures : 0;
+}
+
+extern "C" TESSELLATE_API TessResult* GetVectorFileFill(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? geometry->Current().fill : NULL;
+}
+
+extern "C" TESSELLATE_API int GetVectorFileBorderPointCount(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? (int)(geometry->Current().border.xy.size() / 2) : 0;
+}
+
+extern "C" TESSELLATE_API const double* GetVectorFileBorderPoints(VectorFileGeometry* geometry)
+{
+	if (geometry == NULL || geometry->Current().border.xy.empty()) return NULL;
+	return &geometry->Current().border.xy[0];
+}
+
+extern "C" TESSELLATE_API int GetVectorFileBorderRangeCount(VectorFileGeometry* geometry)
+{
+	return geometry != NULL ? (int)geometry->Current().border.rings.size() : 0;
+}
+
+extern "C" TESSELLATE_API const TessRing* GetVectorFileBorderRanges(VectorFileGeometry* geometry)
+{
+	if (geometry == NULL || geometry->Current().border.rings.empty()) return NULL;
+	return &geometry->Current().border.rings[0];
+}
+
+extern "C" TESSELLATE_API void DrawVectorFileFill(VectorFileGeometry* geometry, int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity)
+{
+	if (geometry == NULL) return;
+
+	// Some OpenGL initialization
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glShadeModel(GL_FLAT);
+
+	DrawTessResultRanges(geometry->Current().fill, fillColorRGB, useTwoColors, fillColor2RGB, opacity);
+}
+
+extern "C" TESSELLATE_API void DrawVectorFileBorder(VectorFileGeometry* geometry, int borderColorRGB[3], int borderWidth)
+{
+	if (geometry == NULL || geometry->Current().border.rings.empty()) return;
+	const RingSet &border = geometry->Current().border;
+
+	// Set the border color and width
+	glColor3f(((float)borderColorRGB[0])/255., ((float)borderColorRGB[1])/255., ((float)borderColorRGB[2])/255.);
+	glLineWidth((float)borderWidth);
+
+	// One line strip per ring or line string
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &border.xy[0]);
+	for (size_t r=0; r<border.rings.size(); r++)
+		glDrawArrays(GL_LINE_STRIP, border.rings[r].firstPoint, border.rings[r].nPoints);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// The current level's features that meet rect, as positions in its features
+static const VectorFileLod& VisibleFeatures(VectorFileGeometry* geometry, const double rect[4], std::vector<int> &visible)
+{
+	const VectorFileLod &level = geometry->Current();
+	level.index.Query(rect, visible);
+	return level;
+}
+
+extern "C" TESSELLATE_API int GetVectorFileBounds(VectorFileGeometry* geometry, double bounds[4])
+{
+	RTreeBox box;
+	if (geometry == NULL || !geometry->Current().index.Bounds(box)) return 0;
+	bounds[0] = box.left;
+	bounds[1] = box.right;
+	bounds[2] = box.bottom;
+	bounds[3] = box.top;
+	return 1;
+}
+
+extern "C" TESSELLATE_API int QueryVectorFileFillRanges(VectorFileGeometry* geometry, double rect[4], int* ranges, int maxRanges)
+{
+	if (geometry == NULL) return 0;
+
+	std::vector<int> visible;
+	const VectorFileLod &level = VisibleFeatures(geometry, rect, visible);
+	int nRanges = 0;
+	for (size_t f=0; f<visible.size(); f++)
+	{
+		const VectorFileFeature &span = level.features[visible[f]];
+		for (int r=0; r<span.nRanges; r++, nRanges++)
+			if (nRanges < maxRanges)
+				ranges[nRanges] = span.firstRange + r;
+	}
+	return nRanges;
+}
+
+extern "C" TESSELLATE_API int QueryVectorFileBorderRanges(VectorFileGeometry* geometry, double rect[4], int* rings, int maxRings)
+{
+	if (geometry == NULL) return 0;
+
+	std::vector<int> visible;
+	const VectorFileLod &level = VisibleFeatures(geometry, rect, visible);
+	int nRings = 0;
+	for (size_t f=0; f<visible.size(); f++)
+	{
+		const VectorFileFeature &span = level.features[visible[f]];
+		for (int r=0; r<span.nRings; r++, nRings++)
+			if (nRings < maxRings)
+				rings[nRings] = span.firstRing + r;
+	}
+	return nRings;
+}
+
+extern "C" TESSELLATE_API void DrawVectorFileFillInRect(VectorFileGeometry* geometry, double rect[4], int fillColorRGB[3], bool useTwoColors, int fillColor2RGB[3], int opacity)
+{
+	if (geometry == NULL) return;
+
+	std::vector<int> visible;
+	const VectorFileLod &level = VisibleFeatures(geometry, rect, visible);
+	std::vector<int> ranges;
+	for (size_t f=0; f<visible.size(); f++)
+	{
+		const VectorFileFeature &span = level.features[visible[f]];
+		for (int r=0; r<span.nRanges; r++)
+			ranges.push_back(span.firstRange + r);
+	}
+	if (ranges.empty()) return;
+
+	// Some OpenGL initialization
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glShadeModel(GL_FLAT);
+
+	DrawTessResultRanges(level.fill, &ranges[0], (int)ranges.size(), fillColorRGB, useTwoColors, fillColor2RGB, opacity);
+}
+
+extern "C" TESSELLATE_API void DrawVectorFileBorderInRect(VectorFileGeometry* geometry, double rect[4], int borderColorRGB[3], int borderWidth)
+{
+	if (geometry == NULL || geometry->Current().border.rings.empty()) return;
+
+	std::vector<int> visible;
+	const VectorFileLod &level = VisibleFeatures(geometry, rect, visible);
+	if (visible.empty()) return;
+	const RingSet &border = level.border;
+
+	glColor3f(((float)borderColorRGB[0])/255., ((float)borderColorRGB[1])/255., ((float)borderColorRGB[2])/255.);
+	glLineWidth((float)borderWidth);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, &border.xy[0]);
+	for (size_t f=0; f<visible.size(); f++)
+	{
+		const VectorFileFeature &span = level.features[visible[f]];
+		for (int r=span.firstRing; r<span.firstRing+span.nRings; r++)
+			glDrawArrays(GL_LINE_STRIP, border.rings[r].firstPoint, border.rings[r].nPoints);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
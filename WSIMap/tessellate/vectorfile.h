@@ -0,0 +1,128 @@
+// vectorfile.h : polygon rings read out of OGR vector files.
+// Include after stdafx.h and tessellate.h.
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include "rtree.h"
+
+// All the rings of a file, with their points in one interleaved x,y array
+struct RingSet
+{
+	std::vector<double> xy;
+	std::vector<TessRing> rings;
+	int nFeatures;
+
+	RingSet() : nFeatures(0) {}
+};
+
+// Read a vector file in one pass, projecting the points.  fills gets the
+// rings TessellateVectorFile has always filled: each ring of a polygon and
+// the outer ring of each part of a multipolygon.  borders gets what
+// VectorFile.cs has always outlined: every ring of every polygon and
+// multipolygon part, and line strings.  Either may be NULL.  For azimuthal
+// projections both are clipped at MinAzimuthalLatitude (see ProjectRingSet).
+VectorFileStatus ReadVectorFile(const char *fileName, MapProjections mapProjection, double centralLongitude, RingSet *fills, RingSet *borders);
+
+struct ProjectionParams;
+
+// Clip ringSet to the visible hemisphere of an azimuthal projection, as
+// polygons if closed is set and as lines otherwise, drop the pieces with
+// fewer than minPoints, then project the rest in place.  Pieces keep the
+// feature and ring numbers of the ring they came from.
+void ProjectRingSet(RingSet &ringSet, const ProjectionParams &params, bool closed, int minPoints);
+
+inline bool ReadVectorFileRings(const char *fileName, MapProjections mapProjection, double centralLongitude, RingSet &ringSet)
+{
+	return ReadVectorFile(fileName, mapProjection, centralLongitude, &ringSet, NULL) == VectorFileOK;
+}
+
+struct TessResult;
+
+// The fill ranges and border rings of one feature, which are consecutive in
+// their arrays
+struct VectorFileFeature
+{
+	int feature;
+	int firstRange, nRanges;
+	int firstRing, nRings;
+};
+
+// The unprojected rings of one level of detail, simplified to tolerance
+// degrees (0 for full detail), and the fill triangulated in longitude/latitude
+struct VectorFileSourceLod
+{
+	double tolerance;
+	RingSet fill;
+	TessResult *triangles;
+	RingSet border;
+};
+
+// A source's levels already projected for one projection, from a bundle
+struct VectorFileVariantLod
+{
+	TessResult *fill;
+	RingSet border;
+	std::vector<VectorFileFeature> features;
+	std::vector<RTreeBox> bounds;
+};
+
+struct VectorFileVariant
+{
+	MapProjections mapProjection;
+	double centralLongitude;
+	std::vector<VectorFileVariantLod> lods;
+};
+
+// Everything read from a file, before projection.  Sources are shared through
+// the geometry cache (geometrycache.h) by every geometry loaded from the same
+// file and never change once built.
+struct VectorFileSource
+{
+	int status;
+	int nFeatures;
+	bool hasFill, hasBorder;
+	double baseTolerance;
+	std::vector<VectorFileSourceLod> lods;	// full detail first, then coarser
+	std::vector<VectorFileVariant> variants;	// projected ahead of time
+	int refCount;				// all cache fields are guarded by the cache's lock
+	std::string cacheKey;
+	long long cacheTime;
+};
+
+// Read fileName and build its levels of detail; the caller owns the result
+VectorFileSource* BuildVectorFileSource(const char *fileName, bool loadFill, bool loadBorder, int nLods, double baseTolerance);
+void DeleteVectorFileSource(VectorFileSource *source);
+
+// Project every level of source the way ReprojectVectorFileGeometry would,
+// for a bundle.  The caller owns the variant's fills.
+void ProjectVectorFileVariant(const VectorFileSource *source, MapProjections mapProjection, double centralLongitude, VectorFileVariant &variant);
+
+// One level of detail of a geometry: its source's triangles and borders
+// projected.  A projection change only projects the triangles again, and
+// tessellates afresh the rings the projection breaks.
+struct VectorFileLod
+{
+	double tolerance;
+	const VectorFileSourceLod *source;
+	TessResult *fill;				// projected for the current projection
+	RingSet border;
+	std::vector<VectorFileFeature> features;	// features with anything to draw
+	std::vector<RTreeBox> bounds;	// and their projected bounds
+	PackedRTree index;				// of those bounds, by position in features
+};
+
+struct VectorFileGeometry
+{
+	int status;
+	int nFeatures;
+	VectorFileSource *source;
+	bool hasFill, hasBorder;			// what this geometry projects of its source
+	std::vector<VectorFileLod> lods;	// full detail first, then coarser
+	int currentLod;
+	MapProjections mapProjection;
+	double centralLongitude;
+
+	const VectorFileLod& Current() const { return lods[currentLod]; }
+};
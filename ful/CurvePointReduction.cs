@@ -1,12 +1,20 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Runtime.InteropServices;
+using System.Security;
 using System.Text;
 
 namespace FUL
 {
     public class CurvePointReduction
     {
+        [DllImport("tessellate.dll", EntryPoint = "SimplifyPolyline", CallingConvention = CallingConvention.Cdecl), SuppressUnmanagedCodeSecurity]
+        private static extern int SimplifyPolyline(double[] xy, int nPoints, double tolerance, int method, int[] keptIndices);
+
+        private const int SimplifyDouglasPeucker = 0;   // SimplifyMethods in tessellate.h
+        private static bool nativeAvailable = true;
+
         /// <summary>
         /// Uses the Douglas Peucker algorithim to reduce the number of points.
         /// </summary>
@@ -22,27 +30,10 @@ namespace FUL
 
             try
             {
-                Int32 firstPoint = 0;
-                Int32 lastPoint = Points.Count - 1;
-                List<Int32> pointIndexsToKeep = new List<Int32>();
-
-                //Add the first and last index to the keepers
-                pointIndexsToKeep.Add(firstPoint);
-                pointIndexsToKeep.Add(lastPoint);
-
-                //The first and the last point can not be the same
-                while ((Points[firstPoint].Lat == Points[lastPoint].Lat) && (Points[firstPoint].Lon == Points[lastPoint].Lon))
-                {
-                    lastPoint--;
-                }
-
-                DouglasPeuckerReduction(Points, firstPoint, lastPoint, Tolerance, ref pointIndexsToKeep);
-
-                pointIndexsToKeep.Sort();
-                foreach (Int32 index in pointIndexsToKeep)
-                {
-                    returnPoints.Add(Points[index]);
-                }
+                int[] kept = new int[Points.Count];
+                int nKept = Reduce(Points, Tolerance, kept);
+                for (int i = 0; i < nKept; i++)
+                    returnPoints.Add(Points[kept[i]]);
             }
             catch (Exception ex)
             {
@@ -54,47 +45,86 @@ namespace FUL
         }
 
         /// <summary>
-        /// Douglases the peucker reduction.
+        /// Finds the points to keep, using the native kernel in tessellate.dll when it can be loaded.
         /// </summary>
         /// <param name="points">The points.</param>
-        /// <param name="firstPoint">The first point.</param>
-        /// <param name="lastPoint">The last point.</param>
         /// <param name="tolerance">The tolerance.</param>
-        /// <param name="pointIndexsToKeep">The point indexs to keep.</param>
-        private static void DouglasPeuckerReduction(List<FUL.Coordinate> points, Int32 firstPoint, Int32 lastPoint, Double tolerance, ref List<Int32> pointIndexsToKeep)
+        /// <param name="keptIndices">Receives the indices of the points to keep, in order.</param>
+        /// <returns>The number of points kept.</returns>
+        private static int Reduce(List<FUL.Coordinate> points, Double tolerance, int[] keptIndices)
         {
-            Double maxDistance = 0;
-            Int32 indexFarthest = 0;
-
-            for (Int32 index = firstPoint; index < lastPoint; index++)
+            if (nativeAvailable)
             {
-                Double distance = PerpendicularDistance(points[firstPoint], points[lastPoint], points[index]);
-                if (distance > maxDistance)
+                double[] xy = new double[points.Count * 2];
+                for (int i = 0; i < points.Count; i++)
                 {
-                    maxDistance = distance;
-                    indexFarthest = index;
+                    xy[i * 2] = points[i].Lon;
+                    xy[i * 2 + 1] = points[i].Lat;
                 }
-            }
 
-            if (maxDistance > tolerance && indexFarthest != 0)
-            {
-                //FUL.FileWriter.WriteLine(true, FUL.FileWriter.EventType.Info, "StackTrace.Length=" + Environment.StackTrace.Length.ToString());
                 try
                 {
-                    if (Environment.StackTrace.Length > 10000)
-                        throw new StackOverflowException();
+                    return SimplifyPolyline(xy, points.Count, tolerance, SimplifyDouglasPeucker, keptIndices);
+                }
+                catch (DllNotFoundException)
+                {
+                    nativeAvailable = false;
                 }
-                catch (Exception)
+                catch (EntryPointNotFoundException)
                 {
-                    FUL.FileWriter.WriteLine(true, FUL.FileWriter.EventType.Info, "StackOverflowException while reducing polygon points.");
-                    throw;
+                    nativeAvailable = false;
                 }
-                //Add the largest point that exceeds the tolerance
-                pointIndexsToKeep.Add(indexFarthest);
+            }
 
-                DouglasPeuckerReduction(points, firstPoint, indexFarthest, tolerance, ref pointIndexsToKeep);
-                DouglasPeuckerReduction(points, indexFarthest, lastPoint, tolerance, ref pointIndexsToKeep);
+            // Managed fallback, iterative so long lines can't overflow the stack
+            bool[] keep = new bool[points.Count];
+            keep[0] = true;
+            keep[points.Count - 1] = true;
+            Stack<KeyValuePair<int, int>> spans = new Stack<KeyValuePair<int, int>>();
+            spans.Push(new KeyValuePair<int, int>(0, points.Count - 1));
+            while (spans.Count > 0)
+            {
+                KeyValuePair<int, int> span = spans.Pop();
+                Double maxDistance = 0;
+                Int32 indexFarthest = -1;
+                for (Int32 index = span.Key + 1; index < span.Value; index++)
+                {
+                    Double distance = SegmentDistance(points[span.Key], points[span.Value], points[index]);
+                    if (distance > maxDistance)
+                    {
+                        maxDistance = distance;
+                        indexFarthest = index;
+                    }
+                }
+
+                if (indexFarthest >= 0 && maxDistance > tolerance)
+                {
+                    keep[indexFarthest] = true;
+                    spans.Push(new KeyValuePair<int, int>(span.Key, indexFarthest));
+                    spans.Push(new KeyValuePair<int, int>(indexFarthest, span.Value));
+                }
             }
+
+            int nKept = 0;
+            for (int i = 0; i < points.Count; i++)
+                if (keep[i])
+                    keptIndices[nKept++] = i;
+            return nKept;
+        }
+
+        /// <summary>
+        /// The distance of a point from the segment between point1 and point2, matching the native kernel.
+        /// </summary>
+        private static Double SegmentDistance(FUL.Coordinate Point1, FUL.Coordinate Point2, FUL.Coordinate Point)
+        {
+            Double dx = Point2.Lon - Point1.Lon;
+            Double dy = Point2.Lat - Point1.Lat;
+            Double len2 = dx * dx + dy * dy;
+            Double t = len2 > 0 ? ((Point.Lon - Point1.Lon) * dx + (Point.Lat - Point1.Lat) * dy) / len2 : 0;
+            t = Math.Max(0, Math.Min(1, t));
+            Double ex = Point1.Lon + t * dx - Point.Lon;
+            Double ey = Point1.Lat + t * dy - Point.Lat;
+            return Math.Sqrt(ex * ex + ey * ey);
         }
 
         /// <summary>